@@ -0,0 +1,297 @@
+/*
+ *benchmark.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This is a program to run on a computer (NOT on the logger) that counts the
+ *heap used by the functions that format the sensor data every logging cycle,
+ *and times them, for 1 to 64 variables.  It is built against
+ *extras/host_shim, whose String counts every malloc, realloc and free the way
+ *the Arduino String makes them, so the counts are the same as on a board.
+ *
+ *The results are printed as csv with the columns:
+ *  Function,Variables,Allocations,Frees,Peak_bytes,Output_bytes,Micros_per_call
+ *The allocations (calls to malloc or realloc) and frees are those made by one
+ *call, including freeing the String it returns.  The peak bytes are the most
+ *String memory the call had in use at once.  The output bytes are the length
+ *of the String made, or the number of characters printed for the functions
+ *that print to a stream.  The time is the average per call over the fastest
+ *of 5 rounds of 200 calls (or --iterations=N calls), by the computer's steady
+ *clock, so a moment when the computer is busy with something else is left
+ *out.  It is not the time the call takes on a board, but it shows how a
+ *change to a function compares.
+ *
+ *To check for changes against a saved run (ie, baseline.csv beside this file):
+ *  ModularSensorsBenchmark --baseline=baseline.csv
+ *This prints every function that now uses more allocations or more memory
+ *than the baseline, whose output has changed, or that takes more than 5 times
+ *as long plus 2 microseconds, and returns 1 if there are any.  The time is
+ *allowed that much room because it depends on the computer and how busy it
+ *is; it only catches a function that has become far slower.
+*/
+
+#define TINY_GSM_MODEM_SIM800
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <LoggerDreamHost.h>
+#include <CountingPrint.h>
+
+// The most variables to count
+#define BENCH_MAX_VARIABLES 64
+// The number of rounds and the default number of calls in each to time, and
+// how much slower than the baseline a call may be before it is counted as worse
+#define BENCH_ROUNDS 5
+#define BENCH_ITERATIONS 200
+#define BENCH_TIME_FACTOR 5
+#define BENCH_TIME_FLOOR_US 2.0
+
+
+// ==========================================================================
+//    A sensor that makes up its values
+// ==========================================================================
+#define BENCH_VARS_PER_SENSOR 4
+
+class BenchSensor : public Sensor
+{
+public:
+    BenchSensor(int sensorNum)
+      : Sensor(-1, sensorNum, F("BenchSensor"), BENCH_VARS_PER_SENSOR)
+    {}
+
+    bool update(void) override
+    {
+        for (uint8_t i = 0; i < BENCH_VARS_PER_SENSOR; i++)
+            sensorValues[i] = 12.3456 + 10*_dataPin + i;
+        notifyVariables();
+        return true;
+    }
+};
+
+BenchSensor *sensors[BENCH_MAX_VARIABLES/BENCH_VARS_PER_SENSOR];
+Variable *variables[BENCH_MAX_VARIABLES];
+const char *UUIDs[BENCH_MAX_VARIABLES];
+LoggerDreamHost logger;
+
+
+// ==========================================================================
+//    Counting the heap
+// ==========================================================================
+// One line of results
+struct BenchResult
+{
+    uint32_t allocations;
+    uint32_t frees;
+    uint32_t peakBytes;
+    uint32_t outputBytes;
+    double microsPerCall;
+};
+
+// Every result, by "Function,Variables", to check against the baseline
+static std::map<std::string, BenchResult> results;
+static long iterations = BENCH_ITERATIONS;
+
+typedef std::chrono::steady_clock BenchClock;
+
+static void saveResult(const char *name, int numVariables, const StringHeapStats &stats,
+                       uint32_t bytesBefore, size_t outputBytes,
+                       BenchClock::duration elapsed)
+{
+    BenchResult result;
+    result.allocations = stats.allocations;
+    result.frees = stats.frees;
+    result.peakBytes = stats.peakBytes - bytesBefore;
+    result.outputBytes = outputBytes;
+    result.microsPerCall =
+        std::chrono::duration<double, std::micro>(elapsed).count()/iterations;
+    printf("%s,%d,%lu,%lu,%lu,%lu,%.3f\n", name, numVariables,
+           (unsigned long)result.allocations, (unsigned long)result.frees,
+           (unsigned long)result.peakBytes, (unsigned long)result.outputBytes,
+           result.microsPerCall);
+    char key[96];
+    snprintf(key, sizeof(key), "%s,%d", name, numVariables);
+    results[key] = result;
+}
+
+// This times the fastest of the rounds of calls
+#define BENCH_TIME(call, fastest) \
+{ \
+    fastest = BenchClock::duration::max(); \
+    for (int r = 0; r < BENCH_ROUNDS; r++) \
+    { \
+        BenchClock::time_point start = BenchClock::now(); \
+        for (long i = 0; i < iterations; i++) call; \
+        BenchClock::duration elapsed = BenchClock::now() - start; \
+        if (elapsed < fastest) fastest = elapsed; \
+    } \
+}
+
+// These count a function that returns a String, or one that prints to a
+// stream, and then time it.  The String returned is freed before the counts
+// are read.
+#define BENCH_STRING(name, call) \
+{ \
+    uint32_t bytesBefore = String::getHeapStats().bytesInUse; \
+    String::resetHeapStats(); \
+    size_t length = (call).length(); \
+    StringHeapStats stats = String::getHeapStats(); \
+    BenchClock::duration fastest; \
+    BENCH_TIME((call).length(), fastest) \
+    saveResult(name, numVariables, stats, bytesBefore, length, fastest); \
+}
+
+#define BENCH_PRINT(name, call) \
+{ \
+    CountingPrint counter; \
+    uint32_t bytesBefore = String::getHeapStats().bytesInUse; \
+    String::resetHeapStats(); \
+    call(&counter); \
+    StringHeapStats stats = String::getHeapStats(); \
+    size_t length = counter.count(); \
+    BenchClock::duration fastest; \
+    BENCH_TIME(call(&counter), fastest) \
+    saveResult(name, numVariables, stats, bytesBefore, length, fastest); \
+}
+
+static void runBenchmarks(int numVariables)
+{
+    logger.init(-1, -1, numVariables, variables, 5, "Bench");
+    logger.markTime(1500000000);
+
+    BENCH_STRING("getValueString", variables[numVariables - 1]->getValueString())
+    BENCH_STRING("generateSensorDataCSV", logger.generateSensorDataCSV())
+    BENCH_PRINT("printSensorDataCSV", logger.printSensorDataCSV)
+    BENCH_STRING("generateFileHeader", logger.generateFileHeader())
+    BENCH_STRING("generateSensorDataJSON", logger.generateSensorDataJSON())
+    BENCH_PRINT("printSensorDataJSON", logger.printSensorDataJSON)
+    BENCH_STRING("generateSensorDataDreamHost", logger.generateSensorDataDreamHost())
+    BENCH_STRING("formatDateTime_ISO8601", Logger::formatDateTime_ISO8601((uint32_t)Logger::markedEpochTime))
+}
+
+
+// ==========================================================================
+//    Checking against the baseline
+// ==========================================================================
+// This returns the number of results that are worse than the baseline
+static int checkBaseline(const char *fileName)
+{
+    FILE *baseline = fopen(fileName, "r");
+    if (baseline == NULL)
+    {
+        fprintf(stderr, "Cannot open the baseline %s\n", fileName);
+        return 1;
+    }
+
+    int problems = 0;
+    int numChecked = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), baseline) != NULL)
+    {
+        char name[64];
+        int numVariables;
+        unsigned long allocations, frees, peakBytes, outputBytes;
+        double microsPerCall;
+        if (sscanf(line, "%63[^,],%d,%lu,%lu,%lu,%lu,%lf", name, &numVariables,
+                   &allocations, &frees, &peakBytes, &outputBytes,
+                   &microsPerCall) != 7)
+            continue;  // The header
+        char key[96];
+        snprintf(key, sizeof(key), "%s,%d", name, numVariables);
+        if (results.count(key) == 0)
+        {
+            fprintf(stderr, "%s: not run\n", key);
+            problems++;
+            continue;
+        }
+        numChecked++;
+        const BenchResult &result = results[key];
+        if (result.allocations > allocations)
+        {
+            fprintf(stderr, "%s: %lu allocations, up from %lu\n", key,
+                    (unsigned long)result.allocations, allocations);
+            problems++;
+        }
+        if (result.peakBytes > peakBytes)
+        {
+            fprintf(stderr, "%s: peak of %lu bytes, up from %lu\n", key,
+                    (unsigned long)result.peakBytes, peakBytes);
+            problems++;
+        }
+        if (result.outputBytes != outputBytes)
+        {
+            fprintf(stderr, "%s: %lu bytes of output, not %lu\n", key,
+                    (unsigned long)result.outputBytes, outputBytes);
+            problems++;
+        }
+        if (result.microsPerCall > microsPerCall*BENCH_TIME_FACTOR + BENCH_TIME_FLOOR_US)
+        {
+            fprintf(stderr, "%s: %.3f us per call, up from %.3f\n", key,
+                    result.microsPerCall, microsPerCall);
+            problems++;
+        }
+    }
+    fclose(baseline);
+
+    if (numChecked < (int)results.size())
+    {
+        fprintf(stderr, "%d results are not in the baseline\n",
+                (int)results.size() - numChecked);
+        problems++;
+    }
+    if (problems > 0)
+        fprintf(stderr, "If these changes are expected, save this output as the new baseline\n");
+    return problems;
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *baselineFile = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--baseline=", 11) == 0) baselineFile = argv[i] + 11;
+        else if (strncmp(argv[i], "--iterations=", 13) == 0) iterations = atol(argv[i] + 13);
+        else
+        {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (iterations < 1) iterations = 1;
+
+    // Keep the logger's own printing out of the results
+    Serial.setEcho(NULL);
+
+    // Make the variables once; they are reused for every count
+    for (int s = 0; s < BENCH_MAX_VARIABLES/BENCH_VARS_PER_SENSOR; s++)
+        sensors[s] = new BenchSensor(s + 1);
+    for (int i = 0; i < BENCH_MAX_VARIABLES; i++)
+    {
+        variables[i] = new Variable(sensors[i/BENCH_VARS_PER_SENSOR],
+                                    i % BENCH_VARS_PER_SENSOR,
+                                    F("temperature"), F("degreeCelsius"), 2,
+                                    F("BenchTemp"));
+        variables[i]->setup();
+        UUIDs[i] = "12345678-abcd-1234-abcd-1234567890ab";
+    }
+    // Give every variable a value
+    for (int s = 0; s < BENCH_MAX_VARIABLES/BENCH_VARS_PER_SENSOR; s++)
+        sensors[s]->update();
+
+    logger.setToken("12345678-abcd-1234-abcd-1234567890ab");
+    logger.setSamplingFeature("12345678-abcd-1234-abcd-1234567890ab");
+    logger.setUUIDs(UUIDs);
+    logger.setDreamHostPortalRX("swrcsensors.dreamhosters.com/portalRX_EnviroDIY_v0.php");
+
+    printf("Function,Variables,Allocations,Frees,Peak_bytes,Output_bytes,Micros_per_call\n");
+    for (int numVariables = 1; numVariables <= BENCH_MAX_VARIABLES; numVariables *= 2)
+        runBenchmarks(numVariables);
+
+    if (baselineFile != NULL && checkBaseline(baselineFile) > 0) return 1;
+    return 0;
+}
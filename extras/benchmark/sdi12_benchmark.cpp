@@ -0,0 +1,242 @@
+/*
+ *sdi12_benchmark.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This is a program to run on a computer (NOT on the logger) that times the
+ *reading of SDI-12 data replies, the way the library reads them now and the
+ *way it used to, for the replies of a Decagon 5TM, CTD and ES-2.
+ *
+ *Now, each reply (aD0! to aD9!) is read into a fixed buffer with
+ *readBytesUntil() and decoded by SDI12Bus::parseValues(), following the pages
+ *until the number of values from the aC! reply have come in.  Before, the
+ *address was skipped and then Stream::parseFloat() was called once for each
+ *variable on the aD0! reply only.
+ *
+ *The replies are made up in the formats given in the Decagon integrator
+ *guides, with values from a creek station; they were not captured from a
+ *sensor.  Each sensor has a reply to aC! and to each of aD0! to aD9!; the
+ *pages after the last value hold only the address.  One more CTD sends its
+ *three values on three pages, as sensors do when their values will not fit
+ *on one, to show what the old way missed.
+ *
+ *The results are printed as csv with the columns:
+ *  Sensor,Method,Values_correct,Micros_per_call
+ *The values correct are the number read that match the reply, and the time
+ *is the average over all of the iterations, by the computer's clock, so it
+ *is only of use to compare the two methods with each other on the same
+ *computer.  For the paged CTD the old way waits out the stream timeout for
+ *each value not on the first page; that time is on the virtual clock of the
+ *host build, so it shows here only as the time taken to count it out.
+ *
+ *  ModularSensorsSDI12Benchmark [--iterations=N] [--check]
+ *With --check, nothing is timed; it checks that every reply is read to the
+ *expected values and returns 1 if not.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <SDI12Bus.h>
+
+// The default number of times to read each sensor's replies
+#define SDI12_BENCH_ITERATIONS 20000
+
+
+// ==========================================================================
+//    The replies
+// ==========================================================================
+struct SDI12Trace
+{
+    const char *sensor;
+    const char *startReply;  // The reply to aC!
+    const char *dataReplies[SDI12_MAX_DATA_PAGES];  // The replies to aD0! to aD9!
+    float expected[3];
+};
+
+static const SDI12Trace traces[] = {
+    // Dielectric permittivity, temperature; the VWC is worked out from them
+    {"Decagon5TM", "100102",
+     {"1+2.07+21.3", "1", "1", "1", "1", "1", "1", "1", "1", "1"},
+     {2.07, 21.3, 0}},
+    // Depth (mm), temperature, conductivity
+    {"DecagonCTD", "200103",
+     {"2+417+21.6+327", "2", "2", "2", "2", "2", "2", "2", "2", "2"},
+     {417, 21.6, 327}},
+    // Conductivity, temperature
+    {"DecagonES2", "300102",
+     {"3+1261+22.1", "3", "3", "3", "3", "3", "3", "3", "3", "3"},
+     {1261, 22.1, 0}},
+    // A CTD sending one value on each page
+    {"DecagonCTD_paged", "400103",
+     {"4+417", "4+21.6", "4+327", "4", "4", "4", "4", "4", "4", "4"},
+     {417, 21.6, 327}}
+};
+#define SDI12_NUM_TRACES (int)(sizeof(traces)/sizeof(traces[0]))
+
+
+// ==========================================================================
+//    A stream to read a reply from
+// ==========================================================================
+// This gives the characters of a reply and its line ending, the way the
+// SDI-12 object gives them once they have arrived
+class ReplyStream : public Stream
+{
+public:
+    void setReply(const char *reply)
+    {
+        _reply = reply;
+        _length = strlen(reply);
+        _position = 0;
+    }
+    virtual int available() override {return _length + 2 - _position;}
+    virtual int read() override
+    {
+        int c = peek();
+        if (c >= 0) _position++;
+        return c;
+    }
+    virtual int peek() override
+    {
+        if (_position < _length) return (unsigned char)_reply[_position];
+        if (_position == _length) return '\r';
+        if (_position == _length + 1) return '\n';
+        return -1;
+    }
+    virtual size_t write(uint8_t) override {return 0;}
+    using Print::write;
+
+private:
+    const char *_reply;
+    size_t _length;
+    size_t _position;
+};
+
+static ReplyStream stream;
+
+
+// ==========================================================================
+//    The two ways of reading
+// ==========================================================================
+// The number of values the aC! reply says are coming
+static uint8_t numExpected(const SDI12Trace &trace)
+{
+    return SDI12Bus::parseDigits(trace.startReply + 4, 2);
+}
+
+// As SDI12Bus::getData() reads them now
+static int readBuffer(const SDI12Trace &trace, float *values)
+{
+    uint8_t expected = numExpected(trace);
+    char reply[SDI12_BUFFER_SIZE];
+    uint8_t numReceived = 0;
+    for (uint8_t page = 0; page < SDI12_MAX_DATA_PAGES && numReceived < expected; page++)
+    {
+        stream.setReply(trace.dataReplies[page]);
+        uint8_t length = stream.readBytesUntil('\n', reply, sizeof(reply) - 1);
+        while (length > 0 && reply[length - 1] == '\r') length--;
+        reply[length] = '\0';
+        int8_t numValues = SDI12Bus::parseValues(reply, trace.startReply[0],
+                                                 values + numReceived,
+                                                 expected - numReceived);
+        if (numValues < 0) return -1;
+        if (numValues == 0) break;
+        numReceived += numValues;
+    }
+    return numReceived;
+}
+
+// As DecagonSDI12::collectMeasurement() used to read them, from aD0! only
+static int readParseFloat(const SDI12Trace &trace, float *values)
+{
+    uint8_t expected = numExpected(trace);
+    stream.setReply(trace.dataReplies[0]);
+    stream.read();  // ignore the repeated SDI12 address
+    for (uint8_t i = 0; i < expected; i++) values[i] = stream.parseFloat();
+    // The line ending was thrown away by the next command
+    while (stream.read() >= 0) {}
+    return expected;
+}
+
+
+// ==========================================================================
+//    Timing and checking
+// ==========================================================================
+// This returns the number of values read that match the reply
+static int countCorrect(const SDI12Trace &trace, const float *values, int numValues)
+{
+    int numCorrect = 0;
+    for (int i = 0; i < numValues; i++)
+        if (fabs(values[i] - trace.expected[i]) < 0.0001) numCorrect++;
+    return numCorrect;
+}
+
+static void timeMethod(const SDI12Trace &trace, const char *method,
+                       int (*readValues)(const SDI12Trace &, float *),
+                       long iterations)
+{
+    float values[3];
+    int numCorrect = countCorrect(trace, values, readValues(trace, values));
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++) readValues(trace, values);
+    std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    printf("%s,%s,%d,%.3f\n", trace.sensor, method, numCorrect,
+           elapsed.count()/iterations);
+}
+
+// This returns the number of replies not read to the expected values
+static int checkTraces(void)
+{
+    int problems = 0;
+    for (int t = 0; t < SDI12_NUM_TRACES; t++)
+    {
+        const SDI12Trace &trace = traces[t];
+        float values[3];
+        int numValues = readBuffer(trace, values);
+        if (numValues != numExpected(trace))
+        {
+            fprintf(stderr, "%s: %d values read, not %d\n", trace.sensor,
+                    numValues, numExpected(trace));
+            problems++;
+            continue;
+        }
+        if (countCorrect(trace, values, numValues) != numValues)
+        {
+            fprintf(stderr, "%s: the values read do not match the reply\n", trace.sensor);
+            problems++;
+        }
+    }
+    return problems;
+}
+
+
+int main(int argc, char *argv[])
+{
+    long iterations = SDI12_BENCH_ITERATIONS;
+    bool check = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--iterations=", 13) == 0) iterations = atol(argv[i] + 13);
+        else if (strcmp(argv[i], "--check") == 0) check = true;
+        else
+        {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (check) return checkTraces() > 0 ? 1 : 0;
+    if (iterations < 1) iterations = 1;
+
+    printf("Sensor,Method,Values_correct,Micros_per_call\n");
+    for (int t = 0; t < SDI12_NUM_TRACES; t++)
+    {
+        timeMethod(traces[t], "parseValues", readBuffer, iterations);
+        timeMethod(traces[t], "parseFloat", readParseFloat, iterations);
+    }
+    return 0;
+}
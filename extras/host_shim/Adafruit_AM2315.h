@@ -0,0 +1,48 @@
+/*
+ *Adafruit_AM2315.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the Adafruit AM2315 library for the host build.  Every sensor
+ *reads the values set with Adafruit_AM2315::setValues().
+*/
+
+#ifndef ADAFRUIT_AM2315_H
+#define ADAFRUIT_AM2315_H
+
+#include "Arduino.h"
+#include "Wire.h"
+
+class Adafruit_AM2315
+{
+public:
+    Adafruit_AM2315(void){}
+    bool begin(void){return true;}
+    float readTemperature(void){return values()[0];}
+    float readHumidity(void){return values()[1];}
+    // A read takes about 100 ms
+    bool readTemperatureAndHumidity(float &t, float &h)
+    {
+        delay(100);
+        t = values()[0];
+        h = values()[1];
+        return true;
+    }
+
+    // ---- Controls for the host build ----
+    static void setValues(float temperature, float humidity)
+    {
+        values()[0] = temperature;
+        values()[1] = humidity;
+    }
+
+private:
+    static float *values(void)
+    {
+        static float v[2] = {20, 50};
+        return v;
+    }
+};
+
+#endif
@@ -0,0 +1,47 @@
+/*
+ *Adafruit_BME280.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the Adafruit BME280 library for the host build.  Every sensor
+ *reads the values set with Adafruit_BME280::setValues().
+*/
+
+#ifndef __BME280_H__
+#define __BME280_H__
+
+#include "Arduino.h"
+#include "Wire.h"
+
+class Adafruit_BME280
+{
+public:
+    Adafruit_BME280(void){}
+    bool begin(uint8_t addr = 0x77){(void)addr; return true;}
+    float readTemperature(void){return values()[0];}
+    float readPressure(void){return values()[1];}
+    float readHumidity(void){return values()[2];}
+    float readAltitude(float seaLevel)
+    {
+        float atmospheric = values()[1] / 100.0F;
+        return 44330.0 * (1.0 - pow(atmospheric / seaLevel, 0.1903));
+    }
+
+    // ---- Controls for the host build ----
+    static void setValues(float temperature, float pressure, float humidity)
+    {
+        values()[0] = temperature;
+        values()[1] = pressure;
+        values()[2] = humidity;
+    }
+
+private:
+    static float *values(void)
+    {
+        static float v[3] = {20, 101325, 50};
+        return v;
+    }
+};
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ *Arduino.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the core of a small stand-in for the Arduino core so the library
+ *can be built and run on a computer.  Time is virtual: millis() and micros()
+ *only move forward when the program waits with delay(), sleeps, or polls the
+ *clock, so a week of logging runs in well under a second.  See HostShim.h for
+ *the functions to control the clock, pins and fake hardware from a test.
+ *
+ *This is NOT part of the library for the boards; it is only used by the
+ *CMakeLists.txt at the top of the library.
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+// All of the standard headers are brought in first so that the Arduino
+// helpers defined below can not clash with them
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef unsigned int word;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define PI 3.1415926535897932384626433832795
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+// There is no separate program memory on a computer
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strcmp_P strcmp
+#define memcpy_P memcpy
+
+// The AVR registers touched by the sleep functions
+#define _BV(bit) (1 << (bit))
+#define ADEN 7
+extern volatile uint8_t ADCSRA;
+
+// The helpers the Arduino core gives as macros are templates here so that
+// they can not break the standard library headers
+template<class T, class L>
+auto min(const T& a, const L& b) -> decltype((b < a) ? b : a)
+{
+    return (b < a) ? b : a;
+}
+template<class T, class L>
+auto max(const T& a, const L& b) -> decltype((b < a) ? b : a)
+{
+    return (a < b) ? b : a;
+}
+// Like the AVR macro, this gives unsigned numbers back unchanged
+template<class T>
+T abs(const T& x) {return x > 0 ? x : -x;}
+template<class T, class L, class H>
+T constrain(const T& x, const L& low, const H& high)
+{
+    return x < low ? low : (x > high ? high : x);
+}
+#define sq(x) ((x)*(x))
+#define radians(deg) ((deg)*DEG_TO_RAD)
+#define degrees(rad) ((rad)*RAD_TO_DEG)
+#define lowByte(w) ((uint8_t) ((w) & 0xff))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+// Time, counted on the virtual clock
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield(void);
+
+// Pins
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogReference(uint8_t mode);
+void analogWrite(uint8_t pin, int val);
+#define DEFAULT 1
+#define EXTERNAL 0
+
+void noInterrupts(void);
+void interrupts(void);
+
+// avr-libc's float to text conversion, which is not in the host's stdlib
+char *dtostrf(double val, signed char width, unsigned char prec, char *sout);
+char *itoa(int value, char *str, int base);
+char *ltoa(long value, char *str, int base);
+char *utoa(unsigned int value, char *str, int base);
+char *ultoa(unsigned long value, char *str, int base);
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "HardwareSerial.h"
+
+#endif
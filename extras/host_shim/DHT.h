@@ -0,0 +1,64 @@
+/*
+ *DHT.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the Adafruit DHT library for the host build.  Every sensor
+ *reads the values set with DHT::setValues().
+*/
+
+#ifndef DHT_H
+#define DHT_H
+
+#include "Arduino.h"
+
+#define DHT11 11
+#define DHT22 22
+#define DHT21 21
+#define AM2301 21
+#define AM2302 22
+
+class DHT
+{
+public:
+    DHT(uint8_t pin, uint8_t type, uint8_t count = 6)
+    {
+        (void)pin; (void)type; (void)count;
+    }
+    void begin(void){}
+    // A read takes about 250 ms
+    float readTemperature(bool S = false, bool force = false)
+    {
+        (void)force;
+        delay(250);
+        return S ? values()[0]*1.8 + 32 : values()[0];
+    }
+    float readHumidity(bool force = false)
+    {
+        (void)force;
+        delay(250);
+        return values()[1];
+    }
+    float computeHeatIndex(float temperature, float percentHumidity, bool isFahrenheit = true)
+    {
+        (void)percentHumidity; (void)isFahrenheit;
+        return temperature;
+    }
+
+    // ---- Controls for the host build ----
+    static void setValues(float temperature, float humidity)
+    {
+        values()[0] = temperature;
+        values()[1] = humidity;
+    }
+
+private:
+    static float *values(void)
+    {
+        static float v[2] = {20, 50};
+        return v;
+    }
+};
+
+#endif
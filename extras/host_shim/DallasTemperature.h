@@ -0,0 +1,47 @@
+/*
+ *DallasTemperature.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the Dallas Temperature library for the host build, reading the
+ *devices of the host OneWire library.
+*/
+
+#ifndef DallasTemperature_h
+#define DallasTemperature_h
+
+#include "Arduino.h"
+#include "OneWire.h"
+
+#define DEVICE_DISCONNECTED_C -127
+typedef uint8_t DeviceAddress[8];
+
+class DallasTemperature
+{
+public:
+    DallasTemperature(OneWire *oneWire);
+
+    void begin(void);
+    uint8_t getDeviceCount(void);
+    bool validAddress(const uint8_t *deviceAddress);
+    bool isConnected(const uint8_t *deviceAddress);
+    bool getAddress(uint8_t *deviceAddress, uint8_t index);
+    uint8_t getResolution(const uint8_t *deviceAddress);
+    // Like the library, this writes the scratchpad and then copies it to the
+    // device's EEPROM
+    bool setResolution(const uint8_t *deviceAddress, uint8_t newResolution,
+                       bool skipGlobalBitResolutionCalculation = false);
+    void setWaitForConversion(bool flag){_waitForConversion = flag;}
+    bool getWaitForConversion(void){return _waitForConversion;}
+    bool isParasitePowerMode(void){return false;}
+    void requestTemperatures(void);
+    float getTempC(const uint8_t *deviceAddress);
+
+private:
+    OneWire *_wire;
+    uint8_t _devices;
+    bool _waitForConversion;
+};
+
+#endif
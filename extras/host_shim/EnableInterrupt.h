@@ -0,0 +1,19 @@
+/*
+ *EnableInterrupt.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the EnableInterrupt library for the host build.  The functions
+ *attached to pins are only remembered; see HostShim::getInterruptHandler().
+*/
+
+#ifndef EnableInterrupt_h
+#define EnableInterrupt_h
+
+#include <stdint.h>
+
+void enableInterrupt(uint8_t pin, void (*userFunc)(void), uint8_t mode);
+void disableInterrupt(uint8_t pin);
+
+#endif
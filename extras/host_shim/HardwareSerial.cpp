@@ -0,0 +1,68 @@
+/*
+ *HardwareSerial.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for the serial ports of the host build.
+*/
+
+#include "Arduino.h"
+
+HardwareSerial Serial(stdout);
+HardwareSerial Serial1;
+
+
+HardwareSerial::HardwareSerial(FILE *echo)
+{
+    _rxPosition = 0;
+    _echo = echo;
+}
+
+int HardwareSerial::available(void)
+{
+    // Waiting for characters takes time
+    yield();
+    return _rx.size() - _rxPosition;
+}
+
+int HardwareSerial::peek(void)
+{
+    if (_rxPosition >= _rx.size()) return -1;
+    return (uint8_t)_rx[_rxPosition];
+}
+
+int HardwareSerial::read(void)
+{
+    if (_rxPosition >= _rx.size()) return -1;
+    int c = (uint8_t)_rx[_rxPosition++];
+    // Drop what has been read once it is all gone
+    if (_rxPosition == _rx.size())
+    {
+        _rx.clear();
+        _rxPosition = 0;
+    }
+    return c;
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    if (_echo != NULL) fputc(c, _echo);
+    else _tx += (char)c;
+    return 1;
+}
+
+void HardwareSerial::flush(void)
+{
+    if (_echo != NULL) fflush(_echo);
+}
+
+void HardwareSerial::inject(const char *text)
+{
+    _rx += text;
+}
+
+void HardwareSerial::inject(const uint8_t *data, size_t length)
+{
+    _rx.append((const char *)data, length);
+}
@@ -0,0 +1,58 @@
+/*
+ *HardwareSerial.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for the serial ports of the host build.  Whatever the program
+ *writes to Serial is printed to the screen; what it writes to the other ports
+ *is kept so a test can check it.  A test can add characters for the program
+ *to read.
+*/
+
+#ifndef HardwareSerial_h
+#define HardwareSerial_h
+
+#include <stdio.h>
+#include <string>
+
+#include "Stream.h"
+
+class HardwareSerial : public Stream
+{
+public:
+    // Output is printed to the given file, or kept if it is NULL
+    HardwareSerial(FILE *echo = NULL);
+
+    void begin(unsigned long baud) {(void)baud;}
+    void begin(unsigned long baud, uint8_t config) {(void)baud; (void)config;}
+    void end(void) {}
+
+    virtual int available(void) override;
+    virtual int peek(void) override;
+    virtual int read(void) override;
+    virtual size_t write(uint8_t c) override;
+    using Print::write;
+    virtual void flush(void) override;
+    operator bool() {return true;}
+
+    // These add characters for the program to read
+    void inject(const char *text);
+    void inject(const uint8_t *data, size_t length);
+    // These return and forget everything the program has written
+    const std::string &getSent(void) {return _tx;}
+    void clearSent(void) {_tx.clear();}
+    // This sets where the output is printed, or NULL to keep it instead
+    void setEcho(FILE *echo) {_echo = echo;}
+
+private:
+    std::string _rx;
+    size_t _rxPosition;
+    std::string _tx;
+    FILE *_echo;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+#endif
@@ -0,0 +1,275 @@
+/*
+ *HostShim.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for the virtual clock, pins and interrupts of the host build,
+ *and the few avr-libc functions the library uses.
+*/
+
+#include "HostShim.h"
+#include <EnableInterrupt.h>
+#include <avr/sleep.h>
+
+volatile uint8_t ADCSRA = 0;
+
+// The free memory check in ProcessorMetadata looks for these
+int __heap_start = 0;
+int *__brkval = 0;
+
+static uint64_t nowMicros = 0;
+static HostShim::WakeSource wakeSource = NULL;
+static uint64_t sleepMicros = 0;
+static uint32_t sleepCount = 0;
+
+static HostShim::PinListener pinListener = NULL;
+static uint8_t pinModes[HOST_NUM_PINS];
+static uint8_t outputLevels[HOST_NUM_PINS];
+static uint8_t inputLevels[HOST_NUM_PINS];
+static int16_t pinLinks[HOST_NUM_PINS];
+static int analogValues[HOST_NUM_PINS];
+static void (*interruptHandlers[HOST_NUM_PINS])(void);
+static bool pinsReady = false;
+
+static void setUpPins(void)
+{
+    if (pinsReady) return;
+    HostShim::reset();
+}
+
+
+// ============================================================================
+//  The virtual clock
+// ============================================================================
+
+uint64_t HostShim::getMicros(void){return nowMicros;}
+void HostShim::advanceMicros(uint64_t us){nowMicros += us;}
+void HostShim::advanceMillis(uint32_t ms){nowMicros += (uint64_t)ms*1000;}
+
+unsigned long millis(void)
+{
+    nowMicros += HOST_POLL_MICROS;
+    return (uint32_t)(nowMicros/1000);
+}
+
+unsigned long micros(void)
+{
+    nowMicros += HOST_POLL_MICROS;
+    return (uint32_t)nowMicros;
+}
+
+void delay(unsigned long ms){nowMicros += (uint64_t)ms*1000;}
+void delayMicroseconds(unsigned int us){nowMicros += us;}
+void yield(void){nowMicros += HOST_POLL_MICROS;}
+
+
+// ============================================================================
+//  Sleeping
+// ============================================================================
+
+void HostShim::setWakeSource(WakeSource source){wakeSource = source;}
+
+void HostShim::sleepUntilWake(void)
+{
+    uint64_t wakeAt = 0;
+    if (wakeSource != NULL) wakeAt = wakeSource(nowMicros);
+    if (wakeAt <= nowMicros) wakeAt = nowMicros + 60000000ULL;
+    sleepMicros += wakeAt - nowMicros;
+    sleepCount++;
+    nowMicros = wakeAt;
+}
+
+uint64_t HostShim::getSleepMicros(void){return sleepMicros;}
+uint32_t HostShim::getSleepCount(void){return sleepCount;}
+
+void set_sleep_mode(uint8_t mode){(void)mode;}
+void sleep_enable(void){}
+void sleep_disable(void){}
+void sleep_bod_disable(void){}
+void sleep_cpu(void){HostShim::sleepUntilWake();}
+
+
+// ============================================================================
+//  Pins
+// ============================================================================
+
+void HostShim::setPinListener(PinListener listener)
+{
+    setUpPins();
+    pinListener = listener;
+}
+
+int HostShim::getOutputLevel(uint8_t pin)
+{
+    setUpPins();
+    return outputLevels[pin];
+}
+
+int HostShim::getPinMode(uint8_t pin)
+{
+    setUpPins();
+    return pinModes[pin];
+}
+
+void HostShim::setInputLevel(uint8_t pin, int level)
+{
+    setUpPins();
+    inputLevels[pin] = level ? HIGH : LOW;
+}
+
+void HostShim::linkPin(uint8_t inputPin, int outputPin)
+{
+    setUpPins();
+    pinLinks[inputPin] = outputPin;
+}
+
+void HostShim::setAnalogValue(uint8_t pin, int value)
+{
+    setUpPins();
+    analogValues[pin] = value;
+}
+
+void HostShim::reset(void)
+{
+    for (int i = 0; i < HOST_NUM_PINS; i++)
+    {
+        pinModes[i] = INPUT;
+        outputLevels[i] = LOW;
+        inputLevels[i] = LOW;
+        pinLinks[i] = -1;
+        analogValues[i] = 0;
+        interruptHandlers[i] = NULL;
+    }
+    pinsReady = true;
+    pinListener = NULL;
+    sleepMicros = 0;
+    sleepCount = 0;
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    setUpPins();
+    pinModes[pin] = mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    setUpPins();
+    uint8_t level = val ? HIGH : LOW;
+    if (outputLevels[pin] == level) return;
+    outputLevels[pin] = level;
+    if (pinListener != NULL) pinListener(pin, level);
+}
+
+int digitalRead(uint8_t pin)
+{
+    setUpPins();
+    if (pinLinks[pin] >= 0) return outputLevels[pinLinks[pin]];
+    // Reading an output gives the level it is driven to
+    if (pinModes[pin] == OUTPUT) return outputLevels[pin];
+    return inputLevels[pin];
+}
+
+int analogRead(uint8_t pin)
+{
+    setUpPins();
+    return analogValues[pin];
+}
+
+void analogReference(uint8_t mode){(void)mode;}
+void analogWrite(uint8_t pin, int val){digitalWrite(pin, val > 127 ? HIGH : LOW);}
+
+void noInterrupts(void){}
+void interrupts(void){}
+
+
+// ============================================================================
+//  Interrupts
+// ============================================================================
+
+void (*HostShim::getInterruptHandler(uint8_t pin))(void)
+{
+    setUpPins();
+    return interruptHandlers[pin];
+}
+
+void enableInterrupt(uint8_t pin, void (*userFunc)(void), uint8_t mode)
+{
+    (void)mode;
+    setUpPins();
+    interruptHandlers[pin] = userFunc;
+}
+
+void disableInterrupt(uint8_t pin)
+{
+    setUpPins();
+    interruptHandlers[pin] = NULL;
+}
+
+
+// ============================================================================
+//  avr-libc and Arduino helpers
+// ============================================================================
+
+char *dtostrf(double val, signed char width, unsigned char prec, char *sout)
+{
+    sprintf(sout, "%*.*f", width, prec, val);
+    return sout;
+}
+
+static char *unsignedToText(unsigned long value, char *str, int base, bool negative)
+{
+    char digits[8*sizeof(long) + 2];
+    int n = 0;
+    if (base < 2 || base > 36) base = 10;
+    do
+    {
+        int d = value % base;
+        digits[n++] = d < 10 ? '0' + d : 'a' + d - 10;
+        value /= base;
+    } while (value);
+    char *out = str;
+    if (negative) *out++ = '-';
+    while (n > 0) *out++ = digits[--n];
+    *out = '\0';
+    return str;
+}
+
+char *ltoa(long value, char *str, int base)
+{
+    if (value < 0 && base == 10) return unsignedToText(-(unsigned long)value, str, base, true);
+    return unsignedToText((unsigned long)value, str, base, false);
+}
+
+// Numbers in any base other than 10 are written without a sign, as on an AVR
+char *itoa(int value, char *str, int base)
+{
+    if (base == 10) return ltoa(value, str, base);
+    return unsignedToText((unsigned int)value, str, base, false);
+}
+
+char *utoa(unsigned int value, char *str, int base){return unsignedToText(value, str, base, false);}
+char *ultoa(unsigned long value, char *str, int base){return unsignedToText(value, str, base, false);}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+// The same numbers every run, so simulations can be repeated
+static uint32_t randomState = 1;
+void randomSeed(unsigned long seed){if (seed != 0) randomState = seed;}
+
+long random(long howbig)
+{
+    if (howbig == 0) return 0;
+    randomState = randomState*1103515245UL + 12345UL;
+    return (randomState >> 1) % howbig;
+}
+
+long random(long howsmall, long howbig)
+{
+    if (howsmall >= howbig) return howsmall;
+    return random(howbig - howsmall) + howsmall;
+}
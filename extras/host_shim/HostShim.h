@@ -0,0 +1,74 @@
+/*
+ *HostShim.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for controlling the host build's stand-in hardware from a test
+ *or simulation: the virtual clock, the pins, and sleeping.  The fake SD card,
+ *clock, modem and sensor libraries each have their own controls in their own
+ *headers.
+ *
+ *The clock starts at 0 and only moves forward when the program calls delay(),
+ *sleeps, or reads the clock; each read of millis() or micros() moves it
+ *forward by HOST_POLL_MICROS so that loops which wait for the clock to reach
+ *some time always finish.
+*/
+
+#ifndef HostShim_h
+#define HostShim_h
+
+#include "Arduino.h"
+
+// How far each read of millis() or micros() moves the virtual clock
+#define HOST_POLL_MICROS 10
+// The number of pins
+#define HOST_NUM_PINS 256
+
+namespace HostShim
+{
+    // ---- The virtual clock ----
+    // This returns the microseconds since the program started
+    uint64_t getMicros(void);
+    // This moves the clock forward
+    void advanceMicros(uint64_t us);
+    void advanceMillis(uint32_t ms);
+
+    // ---- Sleeping ----
+    // A wake source returns the time (from getMicros()) that it will next wake
+    // the board, or 0 if it will not.  The fake real time clock is one.
+    typedef uint64_t (*WakeSource)(uint64_t nowMicros);
+    void setWakeSource(WakeSource source);
+    // This is called by sleep_cpu(); it moves the clock to the next wake up.
+    // If nothing will wake the board, it sleeps for a minute.
+    void sleepUntilWake(void);
+    // These return the total time and number of times the board has slept
+    uint64_t getSleepMicros(void);
+    uint32_t getSleepCount(void);
+
+    // ---- Pins ----
+    // A pin listener is called every time the program changes an output pin
+    typedef void (*PinListener)(uint8_t pin, uint8_t level);
+    void setPinListener(PinListener listener);
+    // This returns the level the program last wrote to a pin
+    int getOutputLevel(uint8_t pin);
+    // This returns the mode the program last set for a pin
+    int getPinMode(uint8_t pin);
+    // This sets the level the program reads from an input pin
+    void setInputLevel(uint8_t pin, int level);
+    // This makes reading one pin give the level the program wrote to another,
+    // ie, a modem status pin that follows its on/off pin.  -1 unlinks it.
+    void linkPin(uint8_t inputPin, int outputPin);
+    // This sets the value analogRead() gives for a pin
+    void setAnalogValue(uint8_t pin, int value);
+
+    // ---- Interrupts ----
+    // This returns the function attached to a pin with enableInterrupt()
+    void (*getInterruptHandler(uint8_t pin))(void);
+
+    // This puts the pins, interrupts and sleep counts back to how they were
+    // at the start.  The clock keeps going.
+    void reset(void);
+}
+
+#endif
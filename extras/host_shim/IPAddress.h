@@ -0,0 +1,33 @@
+/*
+ *IPAddress.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the Arduino IPAddress class for the host build.
+*/
+
+#ifndef IPAddress_h
+#define IPAddress_h
+
+#include <stdint.h>
+
+class IPAddress
+{
+public:
+    IPAddress() {_address[0] = _address[1] = _address[2] = _address[3] = 0;}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    {
+        _address[0] = a;
+        _address[1] = b;
+        _address[2] = c;
+        _address[3] = d;
+    }
+    uint8_t operator[](int index) const {return _address[index];}
+    uint8_t *raw_address() {return _address;}
+
+private:
+    uint8_t _address[4];
+};
+
+#endif
@@ -0,0 +1,237 @@
+/*
+ *OneWire.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the OneWire and Dallas Temperature libraries for the host build.
+*/
+
+#include "OneWire.h"
+#include "DallasTemperature.h"
+
+#define ONEWIRE_HOST_CONVERT_T 0x44
+#define ONEWIRE_HOST_COPY_SCRATCHPAD 0x48
+
+static OneWireHostDevice devices[ONEWIRE_HOST_MAX_DEVICES];
+static int numDevices = 0;
+static uint32_t conversionCount = 0;
+
+
+// ============================================================================
+//  The line
+// ============================================================================
+
+OneWire::OneWire(uint8_t pin)
+{
+    _pin = pin;
+    _selected = -1;
+    _searchNext = 0;
+}
+
+uint8_t OneWire::reset(void)
+{
+    _selected = -1;
+    delayMicroseconds(960);
+    for (int i = 0; i < numDevices; i++)
+    {
+        if (devices[i].pin == _pin) return 1;
+    }
+    return 0;
+}
+
+void OneWire::select(const uint8_t rom[8])
+{
+    OneWireHostDevice *device = findDevice(_pin, rom);
+    _selected = (device == NULL) ? -1 : (int)(device - devices);
+}
+
+void OneWire::skip(void){_selected = -2;}
+
+void OneWire::write(uint8_t v, uint8_t power)
+{
+    (void)power;
+    for (int i = 0; i < numDevices; i++)
+    {
+        if (devices[i].pin != _pin) continue;
+        if (_selected != -2 && _selected != i) continue;
+        if (v == ONEWIRE_HOST_CONVERT_T)
+        {
+            devices[i].converted = (devices[i].badConversions == 0);
+            if (devices[i].badConversions > 0) devices[i].badConversions--;
+        }
+        if (v == ONEWIRE_HOST_COPY_SCRATCHPAD) devices[i].eepromWrites++;
+    }
+    if (v == ONEWIRE_HOST_CONVERT_T) conversionCount++;
+}
+
+void OneWire::write_bytes(const uint8_t *buf, uint16_t count, bool power)
+{
+    for (uint16_t i = 0; i < count; i++) write(buf[i], power);
+}
+
+uint8_t OneWire::read(void){return 0xFF;}
+
+void OneWire::read_bytes(uint8_t *buf, uint16_t count)
+{
+    for (uint16_t i = 0; i < count; i++) buf[i] = read();
+}
+
+void OneWire::depower(void){}
+void OneWire::reset_search(void){_searchNext = 0;}
+
+bool OneWire::search(uint8_t *newAddr, bool search_mode)
+{
+    (void)search_mode;
+    for (; _searchNext < numDevices; _searchNext++)
+    {
+        if (devices[_searchNext].pin != _pin) continue;
+        memcpy(newAddr, devices[_searchNext].address, 8);
+        _searchNext++;
+        return true;
+    }
+    return false;
+}
+
+uint8_t OneWire::crc8(const uint8_t *addr, uint8_t len)
+{
+    uint8_t crc = 0;
+    while (len--)
+    {
+        uint8_t inbyte = *addr++;
+        for (uint8_t i = 8; i; i--)
+        {
+            uint8_t mix = (crc ^ inbyte) & 0x01;
+            crc >>= 1;
+            if (mix) crc ^= 0x8C;
+            inbyte >>= 1;
+        }
+    }
+    return crc;
+}
+
+int OneWire::addDevice(int pin, const uint8_t address[8], float temperature)
+{
+    if (numDevices >= ONEWIRE_HOST_MAX_DEVICES) return -1;
+    OneWireHostDevice &device = devices[numDevices];
+    device.pin = pin;
+    memcpy(device.address, address, 8);
+    device.temperature = temperature;
+    device.resolution = 12;
+    device.converted = false;
+    device.eepromWrites = 0;
+    device.badConversions = 0;
+    return numDevices++;
+}
+
+OneWireHostDevice *OneWire::getDevice(int number)
+{
+    if (number < 0 || number >= numDevices) return NULL;
+    return &devices[number];
+}
+
+OneWireHostDevice *OneWire::findDevice(int pin, const uint8_t address[8])
+{
+    for (int i = 0; i < numDevices; i++)
+    {
+        if (devices[i].pin == pin && memcmp(devices[i].address, address, 8) == 0)
+            return &devices[i];
+    }
+    return NULL;
+}
+
+void OneWire::powerOff(int pin)
+{
+    for (int i = 0; i < numDevices; i++)
+    {
+        if (devices[i].pin == pin) devices[i].converted = false;
+    }
+}
+
+uint32_t OneWire::getConversionCount(void){return conversionCount;}
+
+void OneWire::removeAllDevices(void)
+{
+    numDevices = 0;
+    conversionCount = 0;
+}
+
+
+// ============================================================================
+//  Dallas Temperature
+// ============================================================================
+
+DallasTemperature::DallasTemperature(OneWire *oneWire)
+{
+    _wire = oneWire;
+    _devices = 0;
+    _waitForConversion = true;
+}
+
+void DallasTemperature::begin(void)
+{
+    DeviceAddress address;
+    _devices = 0;
+    _wire->reset_search();
+    while (_wire->search(address)) _devices++;
+}
+
+uint8_t DallasTemperature::getDeviceCount(void){return _devices;}
+
+bool DallasTemperature::validAddress(const uint8_t *deviceAddress)
+{
+    return OneWire::crc8(deviceAddress, 7) == deviceAddress[7];
+}
+
+bool DallasTemperature::isConnected(const uint8_t *deviceAddress)
+{
+    return OneWire::findDevice(_wire->getPin(), deviceAddress) != NULL;
+}
+
+bool DallasTemperature::getAddress(uint8_t *deviceAddress, uint8_t index)
+{
+    _wire->reset_search();
+    for (uint8_t i = 0; _wire->search(deviceAddress); i++)
+    {
+        if (i == index) return true;
+    }
+    return false;
+}
+
+uint8_t DallasTemperature::getResolution(const uint8_t *deviceAddress)
+{
+    OneWireHostDevice *device = OneWire::findDevice(_wire->getPin(), deviceAddress);
+    return device == NULL ? 0 : device->resolution;
+}
+
+bool DallasTemperature::setResolution(const uint8_t *deviceAddress, uint8_t newResolution,
+                                      bool skipGlobalBitResolutionCalculation)
+{
+    (void)skipGlobalBitResolutionCalculation;
+    OneWireHostDevice *device = OneWire::findDevice(_wire->getPin(), deviceAddress);
+    if (device == NULL) return false;
+    if (device->resolution != newResolution)
+    {
+        device->resolution = newResolution;
+        // Write Scratchpad, then Copy Scratchpad, with 20ms for the EEPROM
+        device->eepromWrites++;
+        delay(20);
+    }
+    return true;
+}
+
+void DallasTemperature::requestTemperatures(void)
+{
+    _wire->reset();
+    _wire->skip();
+    _wire->write(ONEWIRE_HOST_CONVERT_T);
+    if (_waitForConversion) delay(750);
+}
+
+float DallasTemperature::getTempC(const uint8_t *deviceAddress)
+{
+    OneWireHostDevice *device = OneWire::findDevice(_wire->getPin(), deviceAddress);
+    if (device == NULL) return DEVICE_DISCONNECTED_C;
+    if (!device->converted) return 85;
+    return device->temperature;
+}
@@ -0,0 +1,69 @@
+/*
+ *OneWire.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the OneWire library for the host build.  Devices are added to
+ *a pin by a test; each keeps a temperature, a resolution, and whether it has
+ *done a conversion since it was powered up.  Until it has, it reads 85 C, the
+ *DS18's power-up value.  A device can also be told to fail its next few
+ *conversions, which then leave it reading 85 C too.
+*/
+
+#ifndef OneWire_h
+#define OneWire_h
+
+#include "Arduino.h"
+
+#define ONEWIRE_HOST_MAX_DEVICES 16
+
+// One device on a line
+struct OneWireHostDevice
+{
+    int pin;
+    uint8_t address[8];
+    float temperature;
+    uint8_t resolution;
+    bool converted;  // A conversion has been done since it was powered up
+    uint32_t eepromWrites;
+    uint32_t badConversions;  // The number of coming conversions that fail
+};
+
+class OneWire
+{
+public:
+    OneWire(uint8_t pin);
+
+    uint8_t reset(void);
+    void select(const uint8_t rom[8]);
+    void skip(void);
+    void write(uint8_t v, uint8_t power = 0);
+    void write_bytes(const uint8_t *buf, uint16_t count, bool power = 0);
+    uint8_t read(void);
+    void read_bytes(uint8_t *buf, uint16_t count);
+    void depower(void);
+    void reset_search(void);
+    bool search(uint8_t *newAddr, bool search_mode = true);
+    static uint8_t crc8(const uint8_t *addr, uint8_t len);
+
+    uint8_t getPin(void){return _pin;}
+
+    // ---- Controls for the host build ----
+    // This adds a device to a line and returns its number, or -1 if full
+    static int addDevice(int pin, const uint8_t address[8], float temperature);
+    static OneWireHostDevice *getDevice(int number);
+    static OneWireHostDevice *findDevice(int pin, const uint8_t address[8]);
+    // This cuts the power to the devices on a line, so they read 85 C again
+    static void powerOff(int pin);
+    // The number of conversions started on all lines
+    static uint32_t getConversionCount(void);
+    static void removeAllDevices(void);
+
+private:
+    uint8_t _pin;
+    int _selected;  // The device selected, -1 for none, -2 for all
+    int _searchNext;
+};
+
+#endif
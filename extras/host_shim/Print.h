@@ -0,0 +1,76 @@
+/*
+ *Print.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the Arduino Print class for the host build.
+*/
+
+#ifndef Print_h
+#define Print_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "WString.h"
+
+class Print
+{
+public:
+    Print() : write_error(0) {}
+    virtual ~Print() {}
+
+    int getWriteError() {return write_error;}
+    void clearWriteError() {setWriteError(0);}
+
+    virtual size_t write(uint8_t) = 0;
+    size_t write(const char *str)
+    {
+        if (str == NULL) return 0;
+        return write((const uint8_t *)str, strlen(str));
+    }
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *buffer, size_t size)
+    {
+        return write((const uint8_t *)buffer, size);
+    }
+    virtual int availableForWrite() {return 0;}
+
+    size_t print(const __FlashStringHelper *);
+    size_t print(const String &);
+    size_t print(const char[]);
+    size_t print(char);
+    size_t print(unsigned char, int = DEC_BASE);
+    size_t print(int, int = DEC_BASE);
+    size_t print(unsigned int, int = DEC_BASE);
+    size_t print(long, int = DEC_BASE);
+    size_t print(unsigned long, int = DEC_BASE);
+    size_t print(double, int = 2);
+
+    size_t println(const __FlashStringHelper *);
+    size_t println(const String &s);
+    size_t println(const char[]);
+    size_t println(char);
+    size_t println(unsigned char, int = DEC_BASE);
+    size_t println(int, int = DEC_BASE);
+    size_t println(unsigned int, int = DEC_BASE);
+    size_t println(long, int = DEC_BASE);
+    size_t println(unsigned long, int = DEC_BASE);
+    size_t println(double, int = 2);
+    size_t println(void);
+
+    virtual void flush() {}
+
+protected:
+    void setWriteError(int err = 1) {write_error = err;}
+
+private:
+    enum {DEC_BASE = 10};
+    int write_error;
+    size_t printNumber(unsigned long, uint8_t);
+    size_t printFloat(double, uint8_t);
+};
+
+#endif
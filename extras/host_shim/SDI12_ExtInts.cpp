@@ -0,0 +1,78 @@
+/*
+ *SDI12_ExtInts.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the EnviroDIY SDI-12 library for the host build.
+*/
+
+#include "SDI12_ExtInts.h"
+
+static SDI12::Responder responder = NULL;
+static uint32_t commandCount = 0;
+
+SDI12::SDI12(uint8_t dataPin)
+{
+    _dataPin = dataPin;
+    _active = false;
+    _rxHead = 0;
+    _rxTail = 0;
+}
+
+SDI12::~SDI12(void){}
+
+void SDI12::begin(void){_active = true;}
+void SDI12::end(void){_active = false;}
+void SDI12::forceHold(void){}
+void SDI12::forceListen(void){}
+bool SDI12::setActive(void){_active = true; return true;}
+bool SDI12::isActive(void){return _active;}
+void SDI12::handleInterrupt(void){}
+void SDI12::clearBuffer(void){_rxHead = _rxTail = 0;}
+
+void SDI12::sendCommand(const char *cmd)
+{
+    commandCount++;
+    // A command takes about 8.33 ms per character plus the break and marking
+    delay(12 + strlen(cmd)*9);
+    if (responder == NULL) return;
+    String response = responder(_dataPin, String(cmd));
+    if (response.length() == 0) return;
+    response += "\r\n";
+    for (unsigned int i = 0; i < response.length(); i++)
+    {
+        uint16_t next = (_rxTail + 1) % SDI12_HOST_BUFFER_SIZE;
+        if (next == _rxHead) break;  // The buffer is full
+        _rxBuffer[_rxTail] = response[i];
+        _rxTail = next;
+    }
+}
+
+void SDI12::sendResponse(const char *resp){(void)resp;}
+
+int SDI12::available(void)
+{
+    yield();
+    return (_rxTail + SDI12_HOST_BUFFER_SIZE - _rxHead) % SDI12_HOST_BUFFER_SIZE;
+}
+
+int SDI12::peek(void)
+{
+    if (_rxHead == _rxTail) return -1;
+    return (uint8_t)_rxBuffer[_rxHead];
+}
+
+int SDI12::read(void)
+{
+    if (_rxHead == _rxTail) return -1;
+    uint8_t c = _rxBuffer[_rxHead];
+    _rxHead = (_rxHead + 1) % SDI12_HOST_BUFFER_SIZE;
+    return c;
+}
+
+size_t SDI12::write(uint8_t byte){(void)byte; return 1;}
+
+void SDI12::setResponder(Responder r){responder = r;}
+uint32_t SDI12::getCommandCount(void){return commandCount;}
+void SDI12::resetCommandCount(void){commandCount = 0;}
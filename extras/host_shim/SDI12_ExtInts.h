@@ -0,0 +1,62 @@
+/*
+ *SDI12_ExtInts.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the EnviroDIY SDI-12 library for the host build.  There are no
+ *real sensors on the line; a test sets a responder function which is given
+ *each command sent and returns what the sensors would answer (without the
+ *<CR><LF>, which is added).  The answer can be read back right away.
+*/
+
+#ifndef SDI12_ExtInts_h
+#define SDI12_ExtInts_h
+
+#include "Arduino.h"
+
+#define SDI12_HOST_BUFFER_SIZE 256
+
+class SDI12 : public Stream
+{
+public:
+    // The function that answers commands; an empty String means no answer
+    typedef String (*Responder)(int dataPin, const String &command);
+
+    SDI12(uint8_t dataPin);
+    ~SDI12(void);
+
+    void begin(void);
+    void end(void);
+    void forceHold(void);
+    void forceListen(void);
+    void sendCommand(const char *cmd);
+    void sendCommand(const String &cmd){sendCommand(cmd.c_str());}
+    void sendResponse(const char *resp);
+    void clearBuffer(void);
+    bool setActive(void);
+    bool isActive(void);
+    static void handleInterrupt(void);
+
+    virtual int available(void) override;
+    virtual int peek(void) override;
+    virtual int read(void) override;
+    virtual void flush(void) override {}
+    virtual size_t write(uint8_t byte) override;
+    using Print::write;
+
+    // ---- Controls for the host build ----
+    static void setResponder(Responder responder);
+    // The number of commands sent on all lines
+    static uint32_t getCommandCount(void);
+    static void resetCommandCount(void);
+
+private:
+    uint8_t _dataPin;
+    bool _active;
+    char _rxBuffer[SDI12_HOST_BUFFER_SIZE];
+    uint16_t _rxHead;
+    uint16_t _rxTail;
+};
+
+#endif
@@ -0,0 +1,228 @@
+/*
+ *SdFat.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the SdFat library for the host build.
+*/
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "SdFat.h"
+
+static String rootFolder = ".";
+static bool cardPresent = true;
+static long writeLimit = -1;
+static SdCardStats stats = {0, 0, 0, 0};
+
+
+// ============================================================================
+//  The card
+// ============================================================================
+
+bool SdFat::begin(uint8_t csPin, uint32_t spiSpeed)
+{
+    (void)csPin; (void)spiSpeed;
+    return cardPresent;
+}
+
+bool SdFat::exists(const char *path)
+{
+    if (!cardPresent) return false;
+    struct stat st;
+    return stat(getPath(path).c_str(), &st) == 0;
+}
+
+bool SdFat::remove(const char *path)
+{
+    if (!cardPresent) return false;
+    return ::remove(getPath(path).c_str()) == 0;
+}
+
+bool SdFat::rename(const char *oldPath, const char *newPath)
+{
+    if (!cardPresent || exists(newPath)) return false;
+    return ::rename(getPath(oldPath).c_str(), getPath(newPath).c_str()) == 0;
+}
+
+void SdFat::setRoot(const char *folder)
+{
+    rootFolder = folder;
+    mkdir(folder, 0755);
+}
+
+String SdFat::getPath(const char *fileName)
+{
+    String path = rootFolder;
+    path += '/';
+    path += fileName;
+    return path;
+}
+
+void SdFat::setCardPresent(bool present){cardPresent = present;}
+bool SdFat::isCardPresent(void){return cardPresent;}
+void SdFat::setWriteLimit(long bytes){writeLimit = bytes;}
+SdCardStats SdFat::getStats(void){return stats;}
+
+void SdFat::resetStats(void)
+{
+    stats.writeCalls = 0;
+    stats.bytesWritten = 0;
+    stats.syncs = 0;
+    stats.opens = 0;
+}
+
+
+// ============================================================================
+//  Files
+// ============================================================================
+
+SdFile::SdFile(void)
+{
+    _fp = NULL;
+    _writeError = false;
+}
+
+SdFile::~SdFile(void){close();}
+
+bool SdFile::open(const char *path, uint8_t oflag)
+{
+    if (isOpen() || !cardPresent) return false;
+    String fullPath = SdFat::getPath(path);
+    struct stat st;
+    bool exists = (stat(fullPath.c_str(), &st) == 0);
+
+    if (exists && (oflag & O_CREAT) && (oflag & O_EXCL)) return false;
+    if (!exists && !(oflag & O_CREAT)) return false;
+
+    const char *mode;
+    if (!(oflag & O_WRITE)) mode = "rb";
+    else if (!exists || (oflag & O_TRUNC)) mode = (oflag & O_READ) ? "w+b" : "wb";
+    else mode = "r+b";
+
+    _fp = fopen(fullPath.c_str(), mode);
+    if (_fp == NULL) return false;
+    if (oflag & O_AT_END) fseek(_fp, 0, SEEK_END);
+    _writeError = false;
+    stats.opens++;
+    return true;
+}
+
+bool SdFile::close(void)
+{
+    if (!isOpen()) return false;
+    bool success = sync();
+    fclose(_fp);
+    _fp = NULL;
+    return success;
+}
+
+int SdFile::available(void)
+{
+    if (!isOpen()) return 0;
+    return fileSize() - curPosition();
+}
+
+int SdFile::peek(void)
+{
+    if (!isOpen()) return -1;
+    int c = fgetc(_fp);
+    if (c != EOF) ungetc(c, _fp);
+    return c == EOF ? -1 : c;
+}
+
+int SdFile::read(void)
+{
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+int SdFile::read(void *buf, size_t nbyte)
+{
+    if (!isOpen() || !cardPresent) return -1;
+    return fread(buf, 1, nbyte, _fp);
+}
+
+int SdFile::write(const void *buf, size_t nbyte)
+{
+    if (!isOpen() || !cardPresent)
+    {
+        _writeError = true;
+        return -1;
+    }
+    // Write as much as the limit allows; those bytes are on the card
+    size_t allowed = nbyte;
+    if (writeLimit >= 0 && (long)nbyte > writeLimit) allowed = writeLimit;
+    size_t written = fwrite(buf, 1, allowed, _fp);
+    if (writeLimit >= 0) writeLimit -= written;
+    if (written > 0)
+    {
+        stats.writeCalls++;
+        stats.bytesWritten += written;
+    }
+    if (written != nbyte)
+    {
+        _writeError = true;
+        return -1;
+    }
+    return nbyte;
+}
+
+size_t SdFile::write(const uint8_t *buf, size_t size){return write((const void *)buf, size);}
+size_t SdFile::write(uint8_t b){return write(&b, 1) == 1 ? 1 : 0;}
+
+bool SdFile::seekSet(uint32_t pos)
+{
+    if (!isOpen()) return false;
+    return fseek(_fp, pos, SEEK_SET) == 0;
+}
+
+bool SdFile::seekEnd(int32_t offset)
+{
+    if (!isOpen()) return false;
+    return fseek(_fp, offset, SEEK_END) == 0;
+}
+
+uint32_t SdFile::curPosition(void)
+{
+    if (!isOpen()) return 0;
+    return ftell(_fp);
+}
+
+uint32_t SdFile::fileSize(void)
+{
+    if (!isOpen()) return 0;
+    fflush(_fp);
+    struct stat st;
+    if (fstat(fileno(_fp), &st) != 0) return 0;
+    return st.st_size;
+}
+
+// Cutting a file short is not a write, so it works past the write limit
+bool SdFile::truncate(uint32_t length)
+{
+    if (!isOpen() || !cardPresent) return false;
+    fflush(_fp);
+    if (ftruncate(fileno(_fp), length) != 0) return false;
+    return seekEnd();
+}
+
+bool SdFile::sync(void)
+{
+    if (!isOpen()) return false;
+    fflush(_fp);
+    stats.syncs++;
+    return cardPresent && !_writeError;
+}
+
+bool SdFile::timestamp(uint8_t flags, uint16_t year, uint8_t month, uint8_t day,
+                       uint8_t hour, uint8_t minute, uint8_t second)
+{
+    (void)flags; (void)year; (void)month; (void)day;
+    (void)hour; (void)minute; (void)second;
+    return isOpen() && cardPresent;
+}
@@ -0,0 +1,115 @@
+/*
+ *SdFat.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the SdFat library for the host build.  The "card" is a folder
+ *on the computer, so anything logged can be read back by a test.  The card can
+ *be taken out, and it can be made to fail after a number of bytes have been
+ *written, to test what happens to records when a write fails.
+*/
+
+#ifndef SdFat_h
+#define SdFat_h
+
+#include "Arduino.h"
+
+// SdFat's own open flags, not the computer's
+#undef O_READ
+#undef O_RDONLY
+#undef O_WRITE
+#undef O_WRONLY
+#undef O_RDWR
+#undef O_AT_END
+#undef O_APPEND
+#undef O_CREAT
+#undef O_TRUNC
+#undef O_EXCL
+#define O_READ 0x01
+#define O_RDONLY O_READ
+#define O_WRITE 0x02
+#define O_WRONLY O_WRITE
+#define O_RDWR (O_READ | O_WRITE)
+#define O_AT_END 0x04
+#define O_APPEND 0x08
+#define O_CREAT 0x10
+#define O_TRUNC 0x20
+#define O_EXCL 0x40
+
+// The file time stamps
+#define T_ACCESS 1
+#define T_CREATE 2
+#define T_WRITE 4
+
+#define SPI_FULL_SPEED 8000000UL
+#define SPI_HALF_SPEED 4000000UL
+
+// The counts of what has been done to the card
+struct SdCardStats
+{
+    uint32_t writeCalls;  // Calls that wrote to a file
+    uint32_t bytesWritten;
+    uint32_t syncs;
+    uint32_t opens;
+};
+
+class SdFat
+{
+public:
+    bool begin(uint8_t csPin = 4, uint32_t spiSpeed = SPI_FULL_SPEED);
+    bool exists(const char *path);
+    bool remove(const char *path);
+    bool rename(const char *oldPath, const char *newPath);
+
+    // ---- Controls for the host build ----
+    // This sets the folder used as the card, making it if needed
+    static void setRoot(const char *folder);
+    static String getPath(const char *fileName);
+    // This takes the card out or puts it back.  Files open when it is taken
+    // out can no longer be written.
+    static void setCardPresent(bool present);
+    static bool isCardPresent(void);
+    // After this many more bytes have been written, all writes fail (as far
+    // as they got) until the limit is changed.  -1 turns the limit off.
+    static void setWriteLimit(long bytes);
+    static SdCardStats getStats(void);
+    static void resetStats(void);
+};
+
+class SdFile : public Print
+{
+public:
+    SdFile(void);
+    ~SdFile(void);
+
+    bool open(const char *path, uint8_t oflag = O_READ);
+    bool close(void);
+    bool isOpen(void) const {return _fp != NULL;}
+
+    int available(void);
+    int peek(void);
+    int read(void);
+    int read(void *buf, size_t nbyte);
+
+    virtual size_t write(uint8_t b) override;
+    virtual size_t write(const uint8_t *buf, size_t size) override;
+    int write(const void *buf, size_t nbyte);
+    using Print::write;
+
+    bool seekSet(uint32_t pos);
+    bool seekEnd(int32_t offset = 0);
+    uint32_t curPosition(void);
+    uint32_t fileSize(void);
+    bool truncate(uint32_t length);
+    bool sync(void);
+    virtual void flush(void) override {sync();}
+    bool timestamp(uint8_t flags, uint16_t year, uint8_t month, uint8_t day,
+                   uint8_t hour, uint8_t minute, uint8_t second);
+
+private:
+    FILE *_fp;
+    bool _writeError;
+};
+
+#endif
@@ -0,0 +1,177 @@
+/*
+ *Sodaq_DS3231.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the Sodaq DS3231 real time clock library for the host build.
+*/
+
+#include "Sodaq_DS3231.h"
+#include "HostShim.h"
+
+#define SECONDS_FROM_1970_TO_2000 946684800UL
+
+// ============================================================================
+//  Dates
+// ============================================================================
+
+// The number of days from 1970-01-01 to a date, for any date after it
+static long daysFromCivil(int y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    const long era = y / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);
+    const unsigned doy = (153*(m + (m > 2 ? -3 : 9)) + 2)/5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe/4 - yoe/100 + doy;
+    return era * 146097 + (long)doe - 719468;
+}
+
+DateTime::DateTime(long t)
+{
+    long days = t / 86400L;
+    long secs = t % 86400L;
+    ss = secs % 60;
+    mm = (secs / 60) % 60;
+    hh = secs / 3600;
+    // 2000-01-01 was a Saturday; Sunday is 0
+    wday = (days + 6) % 7;
+
+    // The date from the days since 1970
+    long z = days + SECONDS_FROM_1970_TO_2000/86400L + 719468;
+    const long era = z / 146097;
+    const unsigned doe = (unsigned)(z - era * 146097);
+    const unsigned yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365;
+    const long y = (long)yoe + era * 400;
+    const unsigned doy = doe - (365*yoe + yoe/4 - yoe/100);
+    const unsigned mp = (5*doy + 2)/153;
+    d = doy - (153*mp + 2)/5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    yOff = y + (m <= 2) - 2000;
+}
+
+DateTime::DateTime(uint16_t year, uint8_t month, uint8_t date,
+                   uint8_t hour, uint8_t min, uint8_t sec, uint8_t wd)
+{
+    if (year >= 2000) year -= 2000;
+    yOff = year;
+    m = month;
+    d = date;
+    hh = hour;
+    mm = min;
+    ss = sec;
+    wday = wd;
+}
+
+long DateTime::get() const
+{
+    long days = daysFromCivil(2000 + yOff, m, d) - SECONDS_FROM_1970_TO_2000/86400L;
+    return ((days * 24L + hh) * 60 + mm) * 60 + ss;
+}
+
+uint32_t DateTime::getEpoch() const
+{
+    return get() + SECONDS_FROM_1970_TO_2000;
+}
+
+static void addTwoDigits(String &str, uint8_t value)
+{
+    if (value < 10) str += '0';
+    str += value;
+}
+
+void DateTime::addToString(String &str) const
+{
+    str += year();
+    str += '-';
+    addTwoDigits(str, month());
+    str += '-';
+    addTwoDigits(str, date());
+    str += ' ';
+    addTwoDigits(str, hour());
+    str += ':';
+    addTwoDigits(str, minute());
+    str += ':';
+    addTwoDigits(str, second());
+}
+
+
+// ============================================================================
+//  The clock
+// ============================================================================
+
+Sodaq_DS3231 rtc;
+
+static uint64_t nextRTCAlarm(uint64_t nowMicros){return rtc.getNextAlarm(nowMicros);}
+
+uint8_t Sodaq_DS3231::begin(void){return 1;}
+
+void Sodaq_DS3231::setDateTime(const DateTime &dt){setEpoch(dt.getEpoch());}
+
+void Sodaq_DS3231::setEpoch(uint32_t ts)
+{
+    // Setting the clock starts the drift over
+    uint64_t now = HostShim::getMicros();
+    _offset_us = (int64_t)ts*1000000LL - ((int64_t)HOST_START_EPOCH*1000000LL + (int64_t)now);
+    _driftStart = now;
+}
+
+int64_t Sodaq_DS3231::getEpochMicros(void)
+{
+    uint64_t now = HostShim::getMicros();
+    int64_t drift = (int64_t)(_drift_ppm * (double)(now - _driftStart) / 1e6);
+    return (int64_t)HOST_START_EPOCH*1000000LL + (int64_t)now + _offset_us + drift;
+}
+
+DateTime Sodaq_DS3231::now(void)
+{
+    return DateTime((long)(getEpochMicros()/1000000LL - SECONDS_FROM_1970_TO_2000));
+}
+
+void Sodaq_DS3231::convertTemperature(bool waitToFinish){(void)waitToFinish;}
+float Sodaq_DS3231::getTemperature(void){return _temperature;}
+
+void Sodaq_DS3231::enableInterrupts(uint8_t periodicity)
+{
+    _alarm = periodicity;
+    HostShim::setWakeSource(nextRTCAlarm);
+}
+
+void Sodaq_DS3231::enableInterrupts(uint8_t hh24, uint8_t mm, uint8_t ss)
+{
+    (void)hh24; (void)mm; (void)ss;
+    enableInterrupts(EveryHour);
+}
+
+void Sodaq_DS3231::disableInterrupts(void){_alarm = 0;}
+void Sodaq_DS3231::clearINTStatus(void){}
+
+uint32_t Sodaq_DS3231::getTrueEpoch(void)
+{
+    return HOST_START_EPOCH + HostShim::getMicros()/1000000ULL;
+}
+
+void Sodaq_DS3231::setDrift(float ppm)
+{
+    // Keep the time the clock has now
+    setEpoch(0);
+    _offset_us = 0;
+    _drift_ppm = ppm;
+}
+
+void Sodaq_DS3231::setTemperature(float temperature){_temperature = temperature;}
+
+uint64_t Sodaq_DS3231::getNextAlarm(uint64_t nowMicros)
+{
+    int64_t period;
+    switch (_alarm)
+    {
+        case EverySecond: period = 1000000LL; break;
+        case EveryMinute: period = 60000000LL; break;
+        case EveryHour: period = 3600000000LL; break;
+        default: return 0;
+    }
+    int64_t clockNow = getEpochMicros();
+    int64_t untilAlarm = period - (clockNow % period);
+    return nowMicros + untilAlarm;
+}
@@ -0,0 +1,93 @@
+/*
+ *Sodaq_DS3231.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the Sodaq DS3231 real time clock library for the host build.
+ *The clock counts the virtual time from a starting date, and can be set to
+ *run fast or slow.  Once its every-minute alarm is turned on, sleeping wakes
+ *the board at the start of each minute on this clock.
+*/
+
+#ifndef Sodaq_DS3231_h
+#define Sodaq_DS3231_h
+
+#include "Arduino.h"
+
+// The alarm periods
+#define EverySecond 0x01
+#define EveryMinute 0x02
+#define EveryHour 0x03
+
+// The time the virtual clock starts at: 2017-01-01 00:00:00
+#define HOST_START_EPOCH 1483228800UL
+
+// A date and time.  A 32-bit time is the seconds since 2000-01-01 00:00:00.
+class DateTime
+{
+public:
+    DateTime(long t = 0);
+    DateTime(uint16_t year, uint8_t month, uint8_t date,
+             uint8_t hour, uint8_t min, uint8_t sec, uint8_t wday = 0);
+
+    uint16_t year() const {return 2000 + yOff;}
+    uint8_t month() const {return m;}
+    uint8_t date() const {return d;}
+    uint8_t hour() const {return hh;}
+    uint8_t minute() const {return mm;}
+    uint8_t second() const {return ss;}
+    uint8_t dayOfWeek() const {return wday;}
+
+    // The seconds since 2000-01-01 00:00:00
+    long get() const;
+    // The seconds since 1970-01-01 00:00:00
+    uint32_t getEpoch() const;
+
+    // This adds the time to a String as "YYYY-MM-DD hh:mm:ss"
+    void addToString(String &str) const;
+
+protected:
+    uint8_t yOff, m, d, hh, mm, ss, wday;
+};
+
+class Sodaq_DS3231
+{
+public:
+    uint8_t begin(void);
+    void setDateTime(const DateTime &dt);
+    void setEpoch(uint32_t ts);
+    DateTime now(void);
+
+    void convertTemperature(bool waitToFinish = true);
+    float getTemperature(void);
+
+    void enableInterrupts(uint8_t periodicity);
+    void enableInterrupts(uint8_t hh24, uint8_t mm, uint8_t ss);
+    void disableInterrupts(void);
+    void clearINTStatus(void);
+
+    // ---- Controls for the host build ----
+    // This returns the true time, which is what a time server gives
+    static uint32_t getTrueEpoch(void);
+    // This makes the clock run fast (positive) or slow, in parts per million
+    void setDrift(float ppm);
+    // This sets the temperature the clock reads
+    void setTemperature(float temperature);
+    // This returns the clock's time in microseconds since 1970
+    int64_t getEpochMicros(void);
+    // This returns the virtual time (from HostShim::getMicros()) of the next
+    // alarm, or 0 if the alarm is off
+    uint64_t getNextAlarm(uint64_t nowMicros);
+
+private:
+    int64_t _offset_us;
+    float _drift_ppm;
+    uint64_t _driftStart;
+    uint8_t _alarm;
+    float _temperature;
+};
+
+extern Sodaq_DS3231 rtc;
+
+#endif
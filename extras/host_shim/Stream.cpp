@@ -0,0 +1,160 @@
+/*
+ *Stream.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the Arduino Stream class for the host build, following the
+ *Arduino core's Stream.cpp.
+*/
+
+#include "Arduino.h"
+
+// Read a character, waiting up to the timeout for one to arrive
+int Stream::timedRead()
+{
+    int c;
+    _startMillis = millis();
+    do
+    {
+        c = read();
+        if (c >= 0) return c;
+        yield();
+    } while(millis() - _startMillis < _timeout);
+    return -1;
+}
+
+int Stream::timedPeek()
+{
+    int c;
+    _startMillis = millis();
+    do
+    {
+        c = peek();
+        if (c >= 0) return c;
+        yield();
+    } while(millis() - _startMillis < _timeout);
+    return -1;
+}
+
+int Stream::peekNextDigit(bool detectDecimal)
+{
+    int c;
+    while (1)
+    {
+        c = timedPeek();
+        if (c < 0 || c == '-' || (c >= '0' && c <= '9') || (detectDecimal && c == '.'))
+            return c;
+        read();
+    }
+}
+
+bool Stream::find(const char *target)
+{
+    size_t targetLen = strlen(target);
+    size_t index = 0;
+    if (targetLen == 0) return true;
+    int c;
+    while ((c = timedRead()) > 0)
+    {
+        if (c == target[index])
+        {
+            if (++index >= targetLen) return true;
+        }
+        else index = (c == target[0]) ? 1 : 0;
+    }
+    return false;
+}
+
+long Stream::parseInt()
+{
+    bool isNegative = false;
+    long value = 0;
+    int c = peekNextDigit(false);
+    if (c < 0) return 0;
+    do
+    {
+        if (c == '-') isNegative = true;
+        else if (c >= '0' && c <= '9') value = value * 10 + c - '0';
+        read();
+        c = timedPeek();
+    } while ((c >= '0' && c <= '9'));
+    if (isNegative) value = -value;
+    return value;
+}
+
+float Stream::parseFloat()
+{
+    bool isNegative = false;
+    bool isFraction = false;
+    long value = 0;
+    float fraction = 1.0;
+    int c = peekNextDigit(true);
+    if (c < 0) return 0;
+    do
+    {
+        if (c == '-') isNegative = true;
+        else if (c == '.') isFraction = true;
+        else if (c >= '0' && c <= '9')
+        {
+            value = value * 10 + c - '0';
+            if (isFraction) fraction *= 0.1;
+        }
+        read();
+        c = timedPeek();
+    } while ((c >= '0' && c <= '9') || (c == '.' && !isFraction));
+    if (isNegative) value = -value;
+    if (isFraction) return value * fraction;
+    return value;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length)
+{
+    size_t count = 0;
+    while (count < length)
+    {
+        int c = timedRead();
+        if (c < 0) break;
+        *buffer++ = (char)c;
+        count++;
+    }
+    return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length)
+{
+    if (length < 1) return 0;
+    size_t index = 0;
+    while (index < length)
+    {
+        int c = timedRead();
+        if (c < 0 || c == terminator) break;
+        *buffer++ = (char)c;
+        index++;
+    }
+    return index;
+}
+
+String Stream::readString()
+{
+    String ret;
+    int c = timedRead();
+    while (c >= 0)
+    {
+        ret += (char)c;
+        c = timedRead();
+    }
+    return ret;
+}
+
+String Stream::readStringUntil(char terminator)
+{
+    String ret;
+    int c = timedRead();
+    while (c >= 0 && c != terminator)
+    {
+        ret += (char)c;
+        c = timedRead();
+    }
+    return ret;
+}
@@ -0,0 +1,49 @@
+/*
+ *Stream.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the Arduino Stream class for the host build.  The timeouts are
+ *counted on the virtual clock.
+*/
+
+#ifndef Stream_h
+#define Stream_h
+
+#include "Print.h"
+
+class Stream : public Print
+{
+public:
+    Stream() {_timeout = 1000;}
+
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) {_timeout = timeout;}
+    unsigned long getTimeout(void) {return _timeout;}
+
+    bool find(const char *target);
+    long parseInt();
+    float parseFloat();
+
+    size_t readBytes(char *buffer, size_t length);
+    size_t readBytes(uint8_t *buffer, size_t length) {return readBytes((char *)buffer, length);}
+    size_t readBytesUntil(char terminator, char *buffer, size_t length);
+    size_t readBytesUntil(char terminator, uint8_t *buffer, size_t length)
+        {return readBytesUntil(terminator, (char *)buffer, length);}
+
+    String readString();
+    String readStringUntil(char terminator);
+
+protected:
+    unsigned long _timeout;
+    unsigned long _startMillis;
+    int timedRead();
+    int timedPeek();
+    int peekNextDigit(bool detectDecimal);
+};
+
+#endif
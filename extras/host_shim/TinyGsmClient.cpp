@@ -0,0 +1,255 @@
+/*
+ *TinyGsmClient.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the TinyGSM library for the host build.
+*/
+
+#include "TinyGsmClient.h"
+#include "HostShim.h"
+#include "Sodaq_DS3231.h"
+
+static bool networkAvailable = true;
+static uint32_t registrationTime_ms = 5000;
+static uint32_t connectTime_ms = 1500;
+static uint32_t responseTime_ms = 800;
+static int signalQuality = 20;
+static TinyGsm::Responder responder = TinyGsm::createdResponse;
+static TinyGsmHostStats stats = {0, 0, 0, 0, 0, 0};
+
+
+// ============================================================================
+//  The modem
+// ============================================================================
+
+TinyGsm::TinyGsm(Stream &stream) : _stream(stream)
+{
+    _registered = false;
+}
+
+bool TinyGsm::begin(void){return init();}
+
+bool TinyGsm::init(void)
+{
+    delay(100);
+    _registered = false;
+    return true;
+}
+
+bool TinyGsm::testAT(unsigned long timeout)
+{
+    (void)timeout;
+    delay(100);
+    return true;
+}
+
+int TinyGsm::getSignalQuality(void)
+{
+    delay(100);
+    return _registered ? signalQuality : 99;
+}
+
+bool TinyGsm::isNetworkConnected(void){return _registered;}
+
+bool TinyGsm::waitForNetwork(unsigned long timeout)
+{
+    stats.networkAttempts++;
+    if (_registered) return true;
+    if (!networkAvailable || registrationTime_ms > timeout)
+    {
+        delay(timeout);
+        return false;
+    }
+    delay(registrationTime_ms);
+    _registered = true;
+    return true;
+}
+
+bool TinyGsm::gprsConnect(const char *apn, const char *user, const char *pw)
+{
+    (void)apn; (void)user; (void)pw;
+    delay(2000);
+    return _registered;
+}
+
+bool TinyGsm::gprsDisconnect(void)
+{
+    delay(500);
+    _registered = false;
+    return true;
+}
+
+void TinyGsm::setNetworkAvailable(bool available){networkAvailable = available;}
+void TinyGsm::setRegistrationTime(uint32_t ms){registrationTime_ms = ms;}
+void TinyGsm::setConnectTime(uint32_t ms){connectTime_ms = ms;}
+void TinyGsm::setResponseTime(uint32_t ms){responseTime_ms = ms;}
+void TinyGsm::setSignalQuality(int csq){signalQuality = csq;}
+void TinyGsm::setResponder(Responder r){responder = (r == NULL) ? createdResponse : r;}
+TinyGsmHostStats TinyGsm::getStats(void){return stats;}
+
+void TinyGsm::resetStats(void)
+{
+    TinyGsmHostStats empty = {0, 0, 0, 0, 0, 0};
+    stats = empty;
+}
+
+String TinyGsm::createdResponse(const String &host, uint16_t port, const String &request)
+{
+    (void)host; (void)port; (void)request;
+    return F("HTTP/1.1 201 Created\r\nContent-Length: 0\r\n\r\n");
+}
+
+
+// ============================================================================
+//  The client
+// ============================================================================
+
+TinyGsm::GsmClient::GsmClient(void)
+{
+    _modem = NULL;
+    _connected = false;
+    _port = 0;
+    _responseRead = 0;
+    _responseReadyAt = 0;
+    _closeAfterResponse = false;
+}
+
+TinyGsm::GsmClient::GsmClient(TinyGsm &modem, uint8_t mux) : GsmClient()
+{
+    init(&modem, mux);
+}
+
+bool TinyGsm::GsmClient::init(TinyGsm *modem, uint8_t mux)
+{
+    (void)mux;
+    _modem = modem;
+    return true;
+}
+
+int TinyGsm::GsmClient::connect(const char *host, uint16_t port)
+{
+    stop();
+    if (_modem == NULL || !_modem->_registered)
+    {
+        stats.failedConnects++;
+        return 0;
+    }
+    delay(connectTime_ms);
+    stats.connects++;
+    _connected = true;
+    _host = host;
+    _port = port;
+    _closeAfterResponse = false;
+
+    // The time server sends the seconds since 1900 and closes the connection
+    if (port == 37)
+    {
+        uint32_t secFrom1900 = Sodaq_DS3231::getTrueEpoch() + 2208988800UL;
+        for (int i = 3; i >= 0; i--) _response += (char)((secFrom1900 >> (8*i)) & 0xFF);
+        _responseReadyAt = HostShim::getMicros() + 100000ULL;
+        _closeAfterResponse = true;
+    }
+    return 1;
+}
+
+int TinyGsm::GsmClient::connect(IPAddress ip, uint16_t port)
+{
+    char host[16];
+    sprintf(host, "%d.%d.%d.%d", ip[0], ip[1], ip[2], ip[3]);
+    return connect(host, port);
+}
+
+void TinyGsm::GsmClient::stop(void)
+{
+    if (_connected) delay(300);
+    _connected = false;
+    _request.clear();
+    _response.clear();
+    _responseRead = 0;
+}
+
+size_t TinyGsm::GsmClient::write(const uint8_t *buf, size_t size)
+{
+    if (!_connected) return 0;
+    // The modem sends about 5 kB/s
+    delayMicroseconds(size*200);
+    stats.bytesSent += size;
+    _request.append((const char *)buf, size);
+    serveRequests();
+    return size;
+}
+
+size_t TinyGsm::GsmClient::write(uint8_t c){return write(&c, 1);}
+
+// A whole request is the headers and as many bytes as the Content-Length
+void TinyGsm::GsmClient::serveRequests(void)
+{
+    while (true)
+    {
+        size_t headerEnd = _request.find("\r\n\r\n");
+        if (headerEnd == std::string::npos) return;
+        size_t bodyLength = 0;
+        std::string headers = _request.substr(0, headerEnd);
+        for (size_t i = 0; i < headers.size(); i++) headers[i] = tolower(headers[i]);
+        size_t lengthAt = headers.find("content-length:");
+        if (lengthAt != std::string::npos) bodyLength = atol(headers.c_str() + lengthAt + 15);
+        size_t requestLength = headerEnd + 4 + bodyLength;
+        if (_request.size() < requestLength) return;
+
+        String request(_request.substr(0, requestLength).c_str());
+        _request.erase(0, requestLength);
+        stats.requests++;
+        String response = responder(_host, _port, request);
+        if (response.length() == 0) continue;
+        if (_responseRead == _response.size())
+        {
+            _response.clear();
+            _responseRead = 0;
+        }
+        _response.append(response.c_str(), response.length());
+        _responseReadyAt = HostShim::getMicros() + (uint64_t)responseTime_ms*1000;
+        String lower = response;
+        lower.toLowerCase();
+        if (lower.indexOf(F("connection: close")) >= 0) _closeAfterResponse = true;
+    }
+}
+
+int TinyGsm::GsmClient::available(void)
+{
+    yield();
+    if (HostShim::getMicros() < _responseReadyAt) return 0;
+    return _response.size() - _responseRead;
+}
+
+int TinyGsm::GsmClient::read(uint8_t *buf, size_t size)
+{
+    size_t n = 0;
+    while (n < size && available() > 0) buf[n++] = read();
+    return n;
+}
+
+int TinyGsm::GsmClient::read(void)
+{
+    if (available() <= 0) return -1;
+    stats.bytesReceived++;
+    return (uint8_t)_response[_responseRead++];
+}
+
+int TinyGsm::GsmClient::peek(void)
+{
+    if (available() <= 0) return -1;
+    return (uint8_t)_response[_responseRead];
+}
+
+void TinyGsm::GsmClient::flush(void){}
+
+// The server closes the connection once its last answer has been read
+uint8_t TinyGsm::GsmClient::connected(void)
+{
+    if (_connected && _closeAfterResponse && _responseRead == _response.size()
+        && HostShim::getMicros() >= _responseReadyAt)
+        _connected = false;
+    return _connected || available() > 0;
+}
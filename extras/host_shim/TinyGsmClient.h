@@ -0,0 +1,114 @@
+/*
+ *TinyGsmClient.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the TinyGSM library for the host build: a cellular modem that
+ *talks to pretend servers instead of through a serial port.  A test decides
+ *whether there is a network, how long the modem takes to register, how long
+ *servers take to answer, and what they answer.  The time server on port 37
+ *always answers with the true time (see Sodaq_DS3231::getTrueEpoch()); every
+ *other server is answered by the responder, which by default answers every
+ *request with "201 Created".
+*/
+
+#ifndef TinyGsmClient_h
+#define TinyGsmClient_h
+
+#include <string>
+#include "Arduino.h"
+#include "Client.h"
+
+#define TINY_GSM_MODEM_HAS_GPRS
+#ifndef DBG
+  #define DBG(...)
+#endif
+
+// The counts of what has been done with the modem
+struct TinyGsmHostStats
+{
+    uint32_t networkAttempts;  // Calls to waitForNetwork()
+    uint32_t connects;  // TCP connections made
+    uint32_t failedConnects;
+    uint32_t requests;  // Whole HTTP requests received by the servers
+    uint32_t bytesSent;
+    uint32_t bytesReceived;
+};
+
+class TinyGsm
+{
+public:
+    // A responder is given each whole HTTP request sent to a server and returns
+    // the whole response.  An empty String means the server does not answer.
+    typedef String (*Responder)(const String &host, uint16_t port, const String &request);
+
+    class GsmClient : public Client
+    {
+        friend class TinyGsm;
+
+    public:
+        GsmClient(void);
+        GsmClient(TinyGsm &modem, uint8_t mux = 1);
+        bool init(TinyGsm *modem, uint8_t mux = 1);
+
+        virtual int connect(const char *host, uint16_t port) override;
+        virtual int connect(IPAddress ip, uint16_t port) override;
+        virtual void stop(void) override;
+        virtual size_t write(const uint8_t *buf, size_t size) override;
+        virtual size_t write(uint8_t c) override;
+        using Print::write;
+        virtual int available(void) override;
+        virtual int read(uint8_t *buf, size_t size) override;
+        virtual int read(void) override;
+        virtual int peek(void) override;
+        virtual void flush(void) override;
+        virtual uint8_t connected(void) override;
+        virtual operator bool() override {return connected();}
+
+    private:
+        void serveRequests(void);
+
+        TinyGsm *_modem;
+        bool _connected;
+        String _host;
+        uint16_t _port;
+        std::string _request;  // Sent but not yet answered
+        std::string _response;  // Answered but not yet read
+        size_t _responseRead;
+        uint64_t _responseReadyAt;
+        bool _closeAfterResponse;
+    };
+
+    TinyGsm(Stream &stream);
+
+    bool begin(void);
+    bool init(void);
+    bool testAT(unsigned long timeout = 10000L);
+    int getSignalQuality(void);
+    bool isNetworkConnected(void);
+    bool waitForNetwork(unsigned long timeout = 60000L);
+    bool gprsConnect(const char *apn, const char *user = "", const char *pw = "");
+    bool gprsDisconnect(void);
+    bool networkDisconnect(void){return gprsDisconnect();}
+
+    // ---- Controls for the host build ----
+    static void setNetworkAvailable(bool available);
+    static void setRegistrationTime(uint32_t ms);
+    static void setConnectTime(uint32_t ms);
+    static void setResponseTime(uint32_t ms);
+    static void setSignalQuality(int csq);
+    static void setResponder(Responder responder);
+    static TinyGsmHostStats getStats(void);
+    static void resetStats(void);
+    // The default answer: "HTTP/1.1 201 Created" with no body
+    static String createdResponse(const String &host, uint16_t port, const String &request);
+
+private:
+    Stream &_stream;
+    bool _registered;
+};
+
+typedef TinyGsm::GsmClient TinyGsmClient;
+
+#endif
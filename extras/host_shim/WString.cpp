@@ -0,0 +1,633 @@
+/*
+ *WString.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the Arduino String class for the host build, following the
+ *Arduino core's WString.cpp so that it makes the same heap allocations.
+*/
+
+#include "Arduino.h"
+
+// ============================================================================
+//  Counting the heap used by Strings
+// ============================================================================
+
+static StringHeapStats heapStats = {0, 0, 0, 0};
+
+// These wrap realloc and free, keeping the number of bytes of each block at
+// the front of it so the bytes in use are known when it is freed
+static void *countedRealloc(void *ptr, size_t size)
+{
+    size_t oldSize = 0;
+    uint8_t *block = NULL;
+    if (ptr != NULL)
+    {
+        block = (uint8_t *)ptr - sizeof(size_t);
+        memcpy(&oldSize, block, sizeof(size_t));
+    }
+    uint8_t *newBlock = (uint8_t *)realloc(block, size + sizeof(size_t));
+    if (newBlock == NULL) return NULL;
+    memcpy(newBlock, &size, sizeof(size_t));
+
+    heapStats.allocations++;
+    heapStats.bytesInUse += size - oldSize;
+    if (heapStats.bytesInUse > heapStats.peakBytes) heapStats.peakBytes = heapStats.bytesInUse;
+    return newBlock + sizeof(size_t);
+}
+
+static void countedFree(void *ptr)
+{
+    if (ptr == NULL) return;
+    uint8_t *block = (uint8_t *)ptr - sizeof(size_t);
+    size_t size;
+    memcpy(&size, block, sizeof(size_t));
+    heapStats.frees++;
+    heapStats.bytesInUse -= size;
+    free(block);
+}
+
+StringHeapStats String::getHeapStats(void){return heapStats;}
+
+void String::resetHeapStats(void)
+{
+    heapStats.allocations = 0;
+    heapStats.frees = 0;
+    heapStats.peakBytes = heapStats.bytesInUse;
+}
+
+
+// ============================================================================
+//  Constructors
+// ============================================================================
+
+String::String(const char *cstr)
+{
+    init();
+    if (cstr) copy(cstr, strlen(cstr));
+}
+
+String::String(const String &value)
+{
+    init();
+    *this = value;
+}
+
+String::String(const __FlashStringHelper *pstr)
+{
+    init();
+    *this = pstr;
+}
+
+String::String(String &&rval)
+{
+    init();
+    move(rval);
+}
+
+String::String(char c)
+{
+    init();
+    char buf[2] = {c, 0};
+    *this = buf;
+}
+
+String::String(unsigned char value, unsigned char base)
+{
+    init();
+    char buf[1 + 8 * sizeof(unsigned char)];
+    utoa(value, buf, base);
+    *this = buf;
+}
+
+String::String(int value, unsigned char base)
+{
+    init();
+    char buf[2 + 8 * sizeof(int)];
+    itoa(value, buf, base);
+    *this = buf;
+}
+
+String::String(unsigned int value, unsigned char base)
+{
+    init();
+    char buf[1 + 8 * sizeof(unsigned int)];
+    utoa(value, buf, base);
+    *this = buf;
+}
+
+String::String(long value, unsigned char base)
+{
+    init();
+    char buf[2 + 8 * sizeof(long)];
+    ltoa(value, buf, base);
+    *this = buf;
+}
+
+String::String(unsigned long value, unsigned char base)
+{
+    init();
+    char buf[1 + 8 * sizeof(unsigned long)];
+    ultoa(value, buf, base);
+    *this = buf;
+}
+
+String::String(float value, unsigned char decimalPlaces)
+{
+    init();
+    char buf[33];
+    *this = dtostrf(value, (decimalPlaces + 2), decimalPlaces, buf);
+}
+
+String::String(double value, unsigned char decimalPlaces)
+{
+    init();
+    char buf[33];
+    *this = dtostrf(value, (decimalPlaces + 2), decimalPlaces, buf);
+}
+
+String::~String()
+{
+    countedFree(buffer);
+}
+
+
+// ============================================================================
+//  Memory Management
+// ============================================================================
+
+inline void String::init(void)
+{
+    buffer = NULL;
+    capacity = 0;
+    len = 0;
+}
+
+void String::invalidate(void)
+{
+    if (buffer) countedFree(buffer);
+    buffer = NULL;
+    capacity = len = 0;
+}
+
+unsigned char String::reserve(unsigned int size)
+{
+    if (buffer && capacity >= size) return 1;
+    if (changeBuffer(size))
+    {
+        if (len == 0) buffer[0] = 0;
+        return 1;
+    }
+    return 0;
+}
+
+unsigned char String::changeBuffer(unsigned int maxStrLen)
+{
+    char *newbuffer = (char *)countedRealloc(buffer, maxStrLen + 1);
+    if (newbuffer)
+    {
+        buffer = newbuffer;
+        capacity = maxStrLen;
+        return 1;
+    }
+    return 0;
+}
+
+
+// ============================================================================
+//  Copy and Move
+// ============================================================================
+
+String &String::copy(const char *cstr, unsigned int length)
+{
+    if (!reserve(length))
+    {
+        invalidate();
+        return *this;
+    }
+    len = length;
+    strcpy(buffer, cstr);
+    return *this;
+}
+
+void String::move(String &rhs)
+{
+    if (buffer)
+    {
+        if (rhs.buffer && capacity >= rhs.len)
+        {
+            strcpy(buffer, rhs.buffer);
+            len = rhs.len;
+            rhs.len = 0;
+            return;
+        }
+        else countedFree(buffer);
+    }
+    buffer = rhs.buffer;
+    capacity = rhs.capacity;
+    len = rhs.len;
+    rhs.buffer = NULL;
+    rhs.capacity = 0;
+    rhs.len = 0;
+}
+
+String &String::operator=(const String &rhs)
+{
+    if (this == &rhs) return *this;
+    if (rhs.buffer) copy(rhs.buffer, rhs.len);
+    else invalidate();
+    return *this;
+}
+
+String &String::operator=(String &&rval)
+{
+    if (this != &rval) move(rval);
+    return *this;
+}
+
+String &String::operator=(const char *cstr)
+{
+    if (cstr) copy(cstr, strlen(cstr));
+    else invalidate();
+    return *this;
+}
+
+String &String::operator=(const __FlashStringHelper *pstr)
+{
+    return *this = reinterpret_cast<const char *>(pstr);
+}
+
+
+// ============================================================================
+//  Concatenate
+// ============================================================================
+
+unsigned char String::concat(const String &s){return concat(s.buffer, s.len);}
+
+unsigned char String::concat(const char *cstr, unsigned int length)
+{
+    unsigned int newlen = len + length;
+    if (!cstr) return 0;
+    if (length == 0) return 1;
+    if (!reserve(newlen)) return 0;
+    memmove(buffer + len, cstr, length);
+    len = newlen;
+    buffer[len] = 0;
+    return 1;
+}
+
+unsigned char String::concat(const char *cstr)
+{
+    if (!cstr) return 0;
+    return concat(cstr, strlen(cstr));
+}
+
+unsigned char String::concat(const __FlashStringHelper *str)
+{
+    return concat(reinterpret_cast<const char *>(str));
+}
+
+unsigned char String::concat(char c)
+{
+    char buf[2] = {c, 0};
+    return concat(buf, 1);
+}
+
+unsigned char String::concat(unsigned char num)
+{
+    char buf[1 + 3 * sizeof(unsigned char)];
+    itoa(num, buf, 10);
+    return concat(buf, strlen(buf));
+}
+
+unsigned char String::concat(int num)
+{
+    char buf[2 + 3 * sizeof(int)];
+    itoa(num, buf, 10);
+    return concat(buf, strlen(buf));
+}
+
+unsigned char String::concat(unsigned int num)
+{
+    char buf[1 + 3 * sizeof(unsigned int)];
+    utoa(num, buf, 10);
+    return concat(buf, strlen(buf));
+}
+
+unsigned char String::concat(long num)
+{
+    char buf[2 + 3 * sizeof(long)];
+    ltoa(num, buf, 10);
+    return concat(buf, strlen(buf));
+}
+
+unsigned char String::concat(unsigned long num)
+{
+    char buf[1 + 3 * sizeof(unsigned long)];
+    ultoa(num, buf, 10);
+    return concat(buf, strlen(buf));
+}
+
+unsigned char String::concat(float num)
+{
+    char buf[20];
+    char *string = dtostrf(num, 4, 2, buf);
+    return concat(string, strlen(string));
+}
+
+unsigned char String::concat(double num)
+{
+    char buf[20];
+    char *string = dtostrf(num, 4, 2, buf);
+    return concat(string, strlen(string));
+}
+
+
+// ============================================================================
+//  Comparison
+// ============================================================================
+
+int String::compareTo(const String &s) const
+{
+    if (!buffer || !s.buffer)
+    {
+        if (s.buffer && s.len > 0) return 0 - *(unsigned char *)s.buffer;
+        if (buffer && len > 0) return *(unsigned char *)buffer;
+        return 0;
+    }
+    return strcmp(buffer, s.buffer);
+}
+
+unsigned char String::equals(const String &s2) const
+{
+    return (len == s2.len && compareTo(s2) == 0);
+}
+
+unsigned char String::equals(const char *cstr) const
+{
+    if (len == 0) return (cstr == NULL || *cstr == 0);
+    if (cstr == NULL) return buffer[0] == 0;
+    return strcmp(buffer, cstr) == 0;
+}
+
+unsigned char String::equalsIgnoreCase(const String &s2) const
+{
+    if (this == &s2) return 1;
+    if (len != s2.len) return 0;
+    if (len == 0) return 1;
+    for (unsigned int i = 0; i < len; i++)
+    {
+        if (tolower(buffer[i]) != tolower(s2.buffer[i])) return 0;
+    }
+    return 1;
+}
+
+unsigned char String::startsWith(const String &s2) const
+{
+    if (len < s2.len) return 0;
+    return startsWith(s2, 0);
+}
+
+unsigned char String::startsWith(const String &s2, unsigned int offset) const
+{
+    if (offset > len - s2.len || !buffer || !s2.buffer) return 0;
+    return strncmp(&buffer[offset], s2.buffer, s2.len) == 0;
+}
+
+unsigned char String::endsWith(const String &s2) const
+{
+    if (len < s2.len || !buffer || !s2.buffer) return 0;
+    return strcmp(&buffer[len - s2.len], s2.buffer) == 0;
+}
+
+
+// ============================================================================
+//  Character Access
+// ============================================================================
+
+char String::charAt(unsigned int loc) const {return operator[](loc);}
+
+void String::setCharAt(unsigned int loc, char c)
+{
+    if (loc < len) buffer[loc] = c;
+}
+
+char &String::operator[](unsigned int index)
+{
+    static char dummy_writable_char;
+    if (index >= len || !buffer)
+    {
+        dummy_writable_char = 0;
+        return dummy_writable_char;
+    }
+    return buffer[index];
+}
+
+char String::operator[](unsigned int index) const
+{
+    if (index >= len || !buffer) return 0;
+    return buffer[index];
+}
+
+void String::getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index) const
+{
+    if (!bufsize || !buf) return;
+    if (index >= len)
+    {
+        buf[0] = 0;
+        return;
+    }
+    unsigned int n = bufsize - 1;
+    if (n > len - index) n = len - index;
+    strncpy((char *)buf, buffer + index, n);
+    buf[n] = 0;
+}
+
+
+// ============================================================================
+//  Search
+// ============================================================================
+
+int String::indexOf(char c) const {return indexOf(c, 0);}
+
+int String::indexOf(char ch, unsigned int fromIndex) const
+{
+    if (fromIndex >= len) return -1;
+    const char *temp = strchr(buffer + fromIndex, ch);
+    if (temp == NULL) return -1;
+    return temp - buffer;
+}
+
+int String::indexOf(const String &s2) const {return indexOf(s2, 0);}
+
+int String::indexOf(const String &s2, unsigned int fromIndex) const
+{
+    if (fromIndex >= len) return -1;
+    const char *found = strstr(buffer + fromIndex, s2.c_str());
+    if (found == NULL) return -1;
+    return found - buffer;
+}
+
+int String::lastIndexOf(char theChar) const
+{
+    if (len == 0) return -1;
+    const char *temp = strrchr(buffer, theChar);
+    if (temp == NULL) return -1;
+    return temp - buffer;
+}
+
+int String::lastIndexOf(const String &s2) const
+{
+    if (s2.len == 0 || len == 0 || s2.len > len) return -1;
+    int found = -1;
+    for (const char *p = buffer; p <= buffer + len - s2.len; p++)
+    {
+        p = strstr(p, s2.buffer);
+        if (!p) break;
+        found = p - buffer;
+    }
+    return found;
+}
+
+// Like the Arduino core, the ends are swapped if they are given backwards
+String String::substring(unsigned int left, unsigned int right) const
+{
+    if (left > right)
+    {
+        unsigned int temp = right;
+        right = left;
+        left = temp;
+    }
+    String out;
+    if (left >= len) return out;
+    if (right > len) right = len;
+    char temp = buffer[right];
+    buffer[right] = '\0';
+    out = buffer + left;
+    buffer[right] = temp;
+    return out;
+}
+
+
+// ============================================================================
+//  Modification
+// ============================================================================
+
+void String::replace(char find, char replace)
+{
+    if (!buffer) return;
+    for (char *p = buffer; *p; p++)
+    {
+        if (*p == find) *p = replace;
+    }
+}
+
+void String::replace(const String &find, const String &replace)
+{
+    if (len == 0 || find.len == 0) return;
+    int diff = replace.len - find.len;
+    char *readFrom = buffer;
+    char *foundAt;
+    if (diff == 0)
+    {
+        while ((foundAt = strstr(readFrom, find.buffer)) != NULL)
+        {
+            memcpy(foundAt, replace.buffer, replace.len);
+            readFrom = foundAt + replace.len;
+        }
+    }
+    else if (diff < 0)
+    {
+        char *writeTo = buffer;
+        while ((foundAt = strstr(readFrom, find.buffer)) != NULL)
+        {
+            unsigned int n = foundAt - readFrom;
+            memmove(writeTo, readFrom, n);
+            writeTo += n;
+            memcpy(writeTo, replace.buffer, replace.len);
+            writeTo += replace.len;
+            readFrom = foundAt + find.len;
+            len += diff;
+        }
+        memmove(writeTo, readFrom, strlen(readFrom) + 1);
+    }
+    else
+    {
+        unsigned int size = len;
+        while ((foundAt = strstr(readFrom, find.buffer)) != NULL)
+        {
+            readFrom = foundAt + find.len;
+            size += diff;
+        }
+        if (size == len) return;
+        if (size > capacity && !changeBuffer(size)) return;
+        int index = len - 1;
+        while (index >= 0 && (index = lastIndexOf(find.buffer)) >= 0)
+        {
+            readFrom = buffer + index + find.len;
+            memmove(readFrom + diff, readFrom, len - (readFrom - buffer));
+            len += diff;
+            buffer[len] = 0;
+            memcpy(buffer + index, replace.buffer, replace.len);
+            index--;
+        }
+    }
+}
+
+void String::remove(unsigned int index)
+{
+    remove(index, (unsigned int)-1);
+}
+
+void String::remove(unsigned int index, unsigned int count)
+{
+    if (index >= len) return;
+    if (count <= 0) return;
+    if (count > len - index) count = len - index;
+    char *writeTo = buffer + index;
+    len = len - count;
+    memmove(writeTo, buffer + index + count, len - index);
+    buffer[len] = 0;
+}
+
+void String::toLowerCase(void)
+{
+    if (!buffer) return;
+    for (char *p = buffer; *p; p++) *p = tolower(*p);
+}
+
+void String::toUpperCase(void)
+{
+    if (!buffer) return;
+    for (char *p = buffer; *p; p++) *p = toupper(*p);
+}
+
+void String::trim(void)
+{
+    if (!buffer || len == 0) return;
+    char *begin = buffer;
+    while (isspace(*begin)) begin++;
+    char *end = buffer + len - 1;
+    while (isspace(*end) && end >= begin) end--;
+    len = end + 1 - begin;
+    if (begin > buffer) memmove(buffer, begin, len);
+    buffer[len] = 0;
+}
+
+
+// ============================================================================
+//  Parsing / Conversion
+// ============================================================================
+
+long String::toInt(void) const
+{
+    if (buffer) return atol(buffer);
+    return 0;
+}
+
+float String::toFloat(void) const
+{
+    if (buffer) return (float)atof(buffer);
+    return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ *WString.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the Arduino String class for the host build.  It grows its
+ *buffer exactly the way the Arduino core does (to the exact length needed,
+ *with realloc), and every allocation and free goes through a counter, so the
+ *number of heap allocations and the most heap used by Strings can be measured
+ *for any function.  See String::getHeapStats().
+*/
+
+#ifndef WString_h
+#define WString_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Text in "program memory" is ordinary text on a computer, but keeps its own
+// type so the right print and String functions are picked
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+// The heap used by Strings since the counters were last reset
+struct StringHeapStats
+{
+    uint32_t allocations;  // Calls to malloc or realloc
+    uint32_t frees;
+    uint32_t bytesInUse;
+    uint32_t peakBytes;  // The most in use at once since the reset
+};
+
+class String
+{
+public:
+    String(const char *cstr = "");
+    String(const String &str);
+    String(const __FlashStringHelper *str);
+    String(String &&rval);
+    explicit String(char c);
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(float value, unsigned char decimalPlaces = 2);
+    explicit String(double value, unsigned char decimalPlaces = 2);
+    ~String(void);
+
+    // These return and reset the counts of heap use by all Strings
+    static StringHeapStats getHeapStats(void);
+    static void resetHeapStats(void);
+
+    unsigned char reserve(unsigned int size);
+    unsigned int length(void) const {return len;}
+
+    String &operator=(const String &rhs);
+    String &operator=(const char *cstr);
+    String &operator=(const __FlashStringHelper *str);
+    String &operator=(String &&rval);
+
+    unsigned char concat(const String &str);
+    unsigned char concat(const char *cstr);
+    unsigned char concat(const __FlashStringHelper *str);
+    unsigned char concat(char c);
+    unsigned char concat(unsigned char num);
+    unsigned char concat(int num);
+    unsigned char concat(unsigned int num);
+    unsigned char concat(long num);
+    unsigned char concat(unsigned long num);
+    unsigned char concat(float num);
+    unsigned char concat(double num);
+
+    template<typename T>
+    String &operator+=(const T &rhs) {concat(rhs); return *this;}
+    String &operator+=(const char *cstr) {concat(cstr); return *this;}
+
+    int compareTo(const String &s) const;
+    unsigned char equals(const String &s) const;
+    unsigned char equals(const char *cstr) const;
+    unsigned char operator==(const String &rhs) const {return equals(rhs);}
+    unsigned char operator==(const char *cstr) const {return equals(cstr);}
+    unsigned char operator!=(const String &rhs) const {return !equals(rhs);}
+    unsigned char operator!=(const char *cstr) const {return !equals(cstr);}
+    unsigned char operator<(const String &rhs) const {return compareTo(rhs) < 0;}
+    unsigned char operator>(const String &rhs) const {return compareTo(rhs) > 0;}
+    unsigned char equalsIgnoreCase(const String &s) const;
+    unsigned char startsWith(const String &prefix) const;
+    unsigned char startsWith(const String &prefix, unsigned int offset) const;
+    unsigned char endsWith(const String &suffix) const;
+
+    char charAt(unsigned int index) const;
+    void setCharAt(unsigned int index, char c);
+    char operator[](unsigned int index) const;
+    char &operator[](unsigned int index);
+    void getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index = 0) const;
+    void toCharArray(char *buf, unsigned int bufsize, unsigned int index = 0) const
+        {getBytes((unsigned char *)buf, bufsize, index);}
+    const char *c_str() const {return buffer ? buffer : "";}
+
+    int indexOf(char ch) const;
+    int indexOf(char ch, unsigned int fromIndex) const;
+    int indexOf(const String &str) const;
+    int indexOf(const String &str, unsigned int fromIndex) const;
+    int lastIndexOf(char ch) const;
+    int lastIndexOf(const String &str) const;
+    String substring(unsigned int beginIndex) const {return substring(beginIndex, len);}
+    String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+    void replace(char find, char replace);
+    void replace(const String &find, const String &replace);
+    void remove(unsigned int index);
+    void remove(unsigned int index, unsigned int count);
+    void toLowerCase(void);
+    void toUpperCase(void);
+    void trim(void);
+
+    long toInt(void) const;
+    float toFloat(void) const;
+
+protected:
+    char *buffer;
+    unsigned int capacity;
+    unsigned int len;
+
+    void init(void);
+    void invalidate(void);
+    unsigned char changeBuffer(unsigned int maxStrLen);
+    unsigned char concat(const char *cstr, unsigned int length);
+    String &copy(const char *cstr, unsigned int length);
+    void move(String &rhs);
+};
+
+// Like the Arduino core, adding to a String makes a new String and then
+// adds to that
+template<typename T>
+String operator+(String lhs, const T &rhs) {lhs.concat(rhs); return lhs;}
+inline String operator+(String lhs, const char *rhs) {lhs.concat(rhs); return lhs;}
+inline String operator+(const char *lhs, const String &rhs) {String s(lhs); s.concat(rhs); return s;}
+
+#endif
@@ -0,0 +1,12 @@
+/*
+ *Wire.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the Arduino I2C library for the host build.
+*/
+
+#include "Wire.h"
+
+TwoWire Wire;
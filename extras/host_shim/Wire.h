@@ -0,0 +1,38 @@
+/*
+ *Wire.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the Arduino I2C library for the host build.  There are no
+ *devices on the bus, so every transmission is not acknowledged.
+*/
+
+#ifndef Wire_h
+#define Wire_h
+
+#include "Arduino.h"
+
+class TwoWire : public Stream
+{
+public:
+    void begin(void) {}
+    void setClock(uint32_t clock) {(void)clock;}
+    void beginTransmission(uint8_t address) {(void)address;}
+    // 2 is "address not acknowledged"
+    uint8_t endTransmission(bool sendStop = true) {(void)sendStop; return 2;}
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop = true)
+    {
+        (void)address; (void)quantity; (void)sendStop;
+        return 0;
+    }
+    virtual size_t write(uint8_t c) override {(void)c; return 1;}
+    using Print::write;
+    virtual int available(void) override {return 0;}
+    virtual int read(void) override {return -1;}
+    virtual int peek(void) override {return -1;}
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ *YosemitechModbus.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the EnviroDIY Yosemitech Modbus library for the host build.
+ *Every sensor reads the values set with yosemitech::setValues().
+*/
+
+#ifndef YosemitechModbus_h
+#define YosemitechModbus_h
+
+#include "Arduino.h"
+
+typedef enum yosemitechModel
+{
+    Y502 = 0,
+    Y504,
+    Y510,
+    Y511,
+    Y514,
+    Y516,
+    Y520,
+    Y532,
+    Y533,
+    Y550,
+    Y4000,
+    UNKNOWN
+} yosemitechModel;
+
+class yosemitech
+{
+public:
+    bool begin(yosemitechModel model, byte modbusSlaveID, Stream *stream, int enablePin = -1)
+    {
+        (void)modbusSlaveID; (void)stream; (void)enablePin;
+        _model = model;
+        return true;
+    }
+    bool begin(yosemitechModel model, byte modbusSlaveID, Stream &stream, int enablePin = -1)
+    {
+        return begin(model, modbusSlaveID, &stream, enablePin);
+    }
+    void setDebugStream(Stream *stream){(void)stream;}
+    void stopDebugging(void){}
+    String getModel(void){return F("Yosemitech");}
+    String getSerialNumber(void){return F("00000000");}
+    bool getVersion(float &hardwareV, float &softwareV)
+    {
+        hardwareV = 1;
+        softwareV = 1;
+        return true;
+    }
+    // Each Modbus command and reply takes about 30 ms
+    bool startMeasurement(void){delay(30); return true;}
+    bool stopMeasurement(void){delay(30); return true;}
+    bool activateBrush(void){delay(30); return true;}
+    bool getValues(float &parmValue, float &tempValue, float &thirdValue)
+    {
+        delay(30);
+        parmValue = values()[0];
+        tempValue = values()[1];
+        thirdValue = values()[2];
+        return true;
+    }
+    bool getValues(float &parmValue, float &tempValue)
+    {
+        float thirdValue;
+        return getValues(parmValue, tempValue, thirdValue);
+    }
+
+    // ---- Controls for the host build ----
+    static void setValues(float parmValue, float tempValue, float thirdValue)
+    {
+        values()[0] = parmValue;
+        values()[1] = tempValue;
+        values()[2] = thirdValue;
+    }
+
+private:
+    yosemitechModel _model;
+    static float *values(void)
+    {
+        static float v[3] = {1, 20, 0};
+        return v;
+    }
+};
+
+#endif
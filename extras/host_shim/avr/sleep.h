@@ -0,0 +1,29 @@
+/*
+ *avr/sleep.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the AVR sleep functions for the host build.  Sleeping moves the
+ *virtual clock forward to the next time the board will be woken; see
+ *HostShim::sleepUntilWake().
+*/
+
+#ifndef avr_sleep_h
+#define avr_sleep_h
+
+#include <stdint.h>
+
+#define SLEEP_MODE_IDLE 0
+#define SLEEP_MODE_ADC 1
+#define SLEEP_MODE_PWR_SAVE 3
+#define SLEEP_MODE_STANDBY 6
+#define SLEEP_MODE_PWR_DOWN 2
+
+void set_sleep_mode(uint8_t mode);
+void sleep_enable(void);
+void sleep_disable(void);
+void sleep_bod_disable(void);
+void sleep_cpu(void);
+
+#endif
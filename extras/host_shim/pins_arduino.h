@@ -0,0 +1,33 @@
+/*
+ *pins_arduino.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is the pin names of an EnviroDIY Mayfly for the host build.
+*/
+
+#ifndef pins_arduino_h
+#define pins_arduino_h
+
+#define NUM_DIGITAL_PINS 32
+#define NUM_ANALOG_INPUTS 8
+
+#define A0 24
+#define A1 25
+#define A2 26
+#define A3 27
+#define A4 28
+#define A5 29
+#define A6 30
+#define A7 31
+
+#define SS 4
+#define MOSI 5
+#define MISO 6
+#define SCK 7
+#define SDA 17
+#define SCL 16
+#define LED_BUILTIN 8
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ *HostTest.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for the checks used by the tests built on a computer against
+ *extras/host_shim.  Each test is its own program; it prints every failed
+ *check and returns non-zero from main() if any failed, which is all ctest
+ *needs.
+*/
+
+#ifndef HostTest_h
+#define HostTest_h
+
+#include <stdio.h>
+#include "Arduino.h"
+#include "HostShim.h"
+
+static int hostTestFailures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) \
+        { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            hostTestFailures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQUAL(expected, actual) \
+    do { \
+        long long e_ = (long long)(expected); \
+        long long a_ = (long long)(actual); \
+        if (e_ != a_) \
+        { \
+            fprintf(stderr, "%s:%d: expected %s == %lld, got %lld\n", \
+                    __FILE__, __LINE__, #actual, e_, a_); \
+            hostTestFailures++; \
+        } \
+    } while (0)
+
+#define CHECK_CLOSE(expected, actual, tolerance) \
+    do { \
+        double e_ = (double)(expected); \
+        double a_ = (double)(actual); \
+        if (fabs(e_ - a_) > (tolerance)) \
+        { \
+            fprintf(stderr, "%s:%d: expected %s == %g, got %g\n", \
+                    __FILE__, __LINE__, #actual, e_, a_); \
+            hostTestFailures++; \
+        } \
+    } while (0)
+
+#define CHECK_STRING(expected, actual) \
+    do { \
+        String e_ = (expected); \
+        String a_ = (actual); \
+        if (e_ != a_) \
+        { \
+            fprintf(stderr, "%s:%d: expected %s == \"%s\", got \"%s\"\n", \
+                    __FILE__, __LINE__, #actual, e_.c_str(), a_.c_str()); \
+            hostTestFailures++; \
+        } \
+    } while (0)
+
+// Return this from main()
+#define TEST_RESULT() \
+    (hostTestFailures == 0 ? (printf("All checks passed\n"), 0) \
+                           : (printf("%d checks failed\n", hostTestFailures), 1))
+
+#endif
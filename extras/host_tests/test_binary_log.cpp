@@ -0,0 +1,111 @@
+/*
+ *test_binary_log.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This checks that a binary log file written by the logger is turned back by
+ *tools/BinaryLogToCSV into exactly the csv file a normal logger would have
+ *written: the text of generateFileHeader() and then generateSensorDataCSV()
+ *for each record.  It also checks that records taken when a sensor failed to
+ *update are counted.
+ *The path of the converter is given as the first argument.
+*/
+
+#include "HostTest.h"
+#include <LoggerBase.h>
+#include <string>
+
+#define BIN_NUM_VARIABLES 4
+
+// A sensor that gives the values it is handed, or fails
+class BinarySensor : public Sensor
+{
+public:
+    BinarySensor(int sensorNum)
+      : Sensor(-1, sensorNum, F("BinarySensor"), BIN_NUM_VARIABLES)
+    {
+        _fail = false;
+    }
+    bool update(void) override
+    {
+        for (uint8_t i = 0; i < BIN_NUM_VARIABLES; i++)
+            sensorValues[i] = _fail ? -9999 : nextValues[i];
+        notifyVariables();
+        return !_fail;
+    }
+    void setFail(bool fail){_fail = fail;}
+    float nextValues[BIN_NUM_VARIABLES];
+
+private:
+    bool _fail;
+};
+
+BinarySensor sensor(1);
+// Whole numbers, then 1, 2 and 4 decimal places
+Variable *variableList[BIN_NUM_VARIABLES] = {
+    new Variable(&sensor, 0, F("temperature"), F("degreeCelsius"), 0, F("BinTemp0")),
+    new Variable(&sensor, 1, F("temperature"), F("degreeCelsius"), 1, F("BinTemp1")),
+    new Variable(&sensor, 2, F("specificConductance"), F("microsiemenPerCentimeter"), 2, F("BinCond")),
+    new Variable(&sensor, 3, F("turbidity"), F("nephelometricTurbidityUnit"), 4, F("BinTurb"))
+};
+Logger logger;
+
+static std::string readFile(const String &path)
+{
+    std::string text;
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (fp == NULL) return text;
+    char buf[256];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) text.append(buf, n);
+    fclose(fp);
+    return text;
+}
+
+// Takes one reading and logs it, returning the csv line it should become
+static std::string logRecord(uint32_t epoch, bool fail)
+{
+    for (int i = 0; i < BIN_NUM_VARIABLES; i++)
+        sensor.nextValues[i] = 1.23456*(epoch % 1000) - 400 + 0.3*i;
+    sensor.setFail(fail);
+    logger.markTime(epoch);
+    logger.updateAllSensors();
+    logger.logToSD();
+    return std::string(logger.generateSensorDataCSV().c_str()) + "\r\n";
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s BinaryLogToCSV\n", argv[0]);
+        return 1;
+    }
+
+    SdFat::setRoot("card");
+    logger.init(12, -1, BIN_NUM_VARIABLES, variableList, 5, "Bin");
+    char fileName[] = "binary.bin";
+    logger.setFileName(fileName);
+    logger.setBinaryLogging(true);
+    String binPath = SdFat::getPath("binary.bin");
+    remove(binPath.c_str());
+    // This sets up the sensors and writes the header block
+    logger.begin();
+
+    std::string expected = logger.generateFileHeader().c_str();
+    uint32_t epoch = 1483228800;  // 2017-01-01 00:00:00
+    for (int i = 0; i < 12; i++)
+        expected += logRecord(epoch + 300*i, i == 4 || i == 9);
+    CHECK(logger.flushLogFile());
+
+    // Convert it back, keeping what the converter says
+    String command = String("\"") + argv[1] + "\" \"" + binPath + "\" converted.csv 2> converted.txt";
+    CHECK_EQUAL(0, system(command.c_str()));
+    std::string converted = readFile("converted.csv");
+    CHECK_STRING(expected.c_str(), converted.c_str());
+    CHECK_STRING("Converted 12 records (2 with a sensor update failure)\n",
+                 readFile("converted.txt").c_str());
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,129 @@
+/*
+ *test_csv_record.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This checks that the csv record printed by printSensorDataCSV() and written
+ *into a character buffer by generateSensorDataCSV(char*, size_t) is the same,
+ *byte for byte, as the String made by generateSensorDataCSV(), for values of
+ *every resolution, and that neither of them uses any heap.
+*/
+
+#include "HostTest.h"
+#include <LoggerBase.h>
+#include <string>
+
+#define CSV_NUM_SENSORS 4
+#define CSV_NUM_VARIABLES (CSV_NUM_SENSORS*MAX_NUMBER_VARS)
+
+// A sensor that gives the values it is handed
+class CsvSensor : public Sensor
+{
+public:
+    CsvSensor(int sensorNum, const float *values)
+      : Sensor(-1, sensorNum, F("CsvSensor"), MAX_NUMBER_VARS)
+    {
+        _values = values;
+    }
+    bool update(void) override
+    {
+        for (uint8_t i = 0; i < MAX_NUMBER_VARS; i++) sensorValues[i] = _values[i];
+        notifyVariables();
+        return true;
+    }
+
+private:
+    const float *_values;
+};
+
+// Prints into a std::string, so the printing itself uses no String memory
+class TextPrint : public Print
+{
+public:
+    virtual size_t write(uint8_t c) override
+    {
+        text += (char)c;
+        return 1;
+    }
+    using Print::write;
+    std::string text;
+};
+
+// Values that are awkward to round, with the resolution of each sensor's
+// variables: whole numbers, then 1, 2 and 4 decimal places
+static const float values[CSV_NUM_SENSORS][MAX_NUMBER_VARS] = {
+    {21.7, -3.9, -9999, 40000},
+    {0.04, -0.04, 99.95, -9999},
+    {2.675, 1234567.0, -0.001, 0},
+    {3.14159265, 0.00005, -273.15, 1e-7}
+};
+static const int resolutions[CSV_NUM_SENSORS] = {0, 1, 2, 4};
+
+Logger logger;
+
+static void testRecordsMatch(void)
+{
+    String expected = logger.generateSensorDataCSV();
+    CHECK(expected.length() > 0);
+
+    String::resetHeapStats();
+    TextPrint printed;
+    logger.printSensorDataCSV(&printed);
+    char buffer[512];
+    int length = logger.generateSensorDataCSV(buffer, sizeof(buffer));
+    CHECK_EQUAL(0, String::getHeapStats().allocations);
+
+    CHECK_STRING(expected, printed.text.c_str());
+    CHECK_STRING(expected, buffer);
+    CHECK_EQUAL(expected.length(), length);
+
+    // The values alone, without the time, match too
+    String expectedValues = logger.VariableArray::generateSensorDataCSV();
+    String::resetHeapStats();
+    TextPrint printedValues;
+    logger.VariableArray::printSensorDataCSV(&printedValues);
+    CHECK_EQUAL(0, String::getHeapStats().allocations);
+    CHECK_STRING(expectedValues, printedValues.text.c_str());
+}
+
+static void testBufferTooSmall(void)
+{
+    String expected = logger.generateSensorDataCSV();
+
+    // Exactly enough room for the text and the null
+    char buffer[512];
+    CHECK_EQUAL(expected.length(), logger.generateSensorDataCSV(buffer, expected.length() + 1));
+    CHECK_STRING(expected, buffer);
+
+    // One short: the text is cut off, but still ends with a null
+    CHECK_EQUAL(-1, logger.generateSensorDataCSV(buffer, expected.length()));
+    CHECK_EQUAL(expected.length() - 1, strlen(buffer));
+    CHECK(strncmp(expected.c_str(), buffer, expected.length() - 1) == 0);
+}
+
+int main(void)
+{
+    Variable *variableList[CSV_NUM_VARIABLES];
+    for (int s = 0; s < CSV_NUM_SENSORS; s++)
+    {
+        CsvSensor *sensor = new CsvSensor(s + 1, values[s]);
+        for (int v = 0; v < MAX_NUMBER_VARS; v++)
+        {
+            Variable *var = new Variable(sensor, v, F("temperature"),
+                                         F("degreeCelsius"), resolutions[s],
+                                         F("CsvTemp"));
+            var->setup();
+            variableList[s*MAX_NUMBER_VARS + v] = var;
+        }
+        sensor->update();
+    }
+    logger.init(-1, -1, CSV_NUM_VARIABLES, variableList, 5, "CsvTest");
+    logger.setTimeZone(-5);
+    logger.markTime(1500000000);
+
+    testRecordsMatch();
+    testBufferTooSmall();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,162 @@
+/*
+ *test_envirodiy_request.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This checks that the post streamed to EnviroDIY - the headers from
+ *streamEnviroDIYHeaders() with the Content-Length from
+ *getSensorDataJSONLength(), then the body from printSensorDataJSON() - is the
+ *same, byte for byte, as the request the library used to build as Strings,
+ *for values of every resolution, and that streaming it uses no heap.  It also
+ *checks the request the pretend portal gets from postDataEnviroDIY().
+*/
+
+#define TINY_GSM_MODEM_SIM800
+#include "HostTest.h"
+#include <LoggerEnviroDIY.h>
+#include <string>
+
+#define REQ_NUM_SENSORS 4
+#define REQ_NUM_VARIABLES (REQ_NUM_SENSORS*MAX_NUMBER_VARS)
+
+// A sensor that gives the values it is handed
+class RequestSensor : public Sensor
+{
+public:
+    RequestSensor(int sensorNum, const float *values)
+      : Sensor(-1, sensorNum, F("RequestSensor"), MAX_NUMBER_VARS)
+    {
+        _values = values;
+    }
+    bool update(void) override
+    {
+        for (uint8_t i = 0; i < MAX_NUMBER_VARS; i++) sensorValues[i] = _values[i];
+        notifyVariables();
+        return true;
+    }
+
+private:
+    const float *_values;
+};
+
+// A stream that keeps what is written to it in a std::string, so the
+// writing itself uses no String memory
+class TextStream : public Stream
+{
+public:
+    virtual size_t write(uint8_t c) override
+    {
+        text += (char)c;
+        return 1;
+    }
+    using Print::write;
+    virtual int available() override {return 0;}
+    virtual int read() override {return -1;}
+    virtual int peek() override {return -1;}
+    std::string text;
+};
+
+// Values that are awkward to round, with the resolution of each sensor's
+// variables: whole numbers, then 1, 2 and 4 decimal places
+static const float values[REQ_NUM_SENSORS][MAX_NUMBER_VARS] = {
+    {21.7, -3.9, -9999, 40000},
+    {0.04, -0.04, 99.95, -9999},
+    {2.675, 1234567.0, -0.001, 0},
+    {3.14159265, 0.00005, -273.15, 1e-7}
+};
+static const int resolutions[REQ_NUM_SENSORS] = {0, 1, 2, 4};
+static const char *UUIDs[REQ_NUM_VARIABLES];
+
+LoggerEnviroDIY logger;
+static std::string portalRequest;
+
+static String portalResponder(const String &host, uint16_t port, const String &request)
+{
+    if (host != "data.envirodiy.org")
+        return TinyGsm::createdResponse(host, port, request);
+    portalRequest = request.c_str();
+    return "HTTP/1.1 201 Created\r\nContent-Length: 0\r\n\r\n";
+}
+
+// The request as it used to be made: the JSON built as a String, and each
+// header line concatenated into a String before it was printed
+static String oldRequest(void)
+{
+    String jsonString = logger.generateSensorDataJSON();
+    String request = String(F("POST /api/data-stream/ HTTP/1.1"));
+    request += String(F("\r\nHost: data.envirodiy.org"));
+    request += String(F("\r\nTOKEN: ")) + String("12345678-abcd-1234-abcd-1234567890ab");
+    request += String(F("\r\nContent-Length: ")) + String(jsonString.length());
+    request += String(F("\r\nContent-Type: application/json\r\n\r\n"));
+    request += jsonString;
+    return request;
+}
+
+static void testRequestMatches(void)
+{
+    String expected = oldRequest();
+
+    String::resetHeapStats();
+    TextStream streamed;
+    logger.streamEnviroDIYRequest(&streamed);
+    CHECK_EQUAL(0, String::getHeapStats().allocations);
+    CHECK_STRING(expected, streamed.text.c_str());
+
+    // The same, piece by piece
+    String::resetHeapStats();
+    TextStream pieces;
+    size_t length = logger.getSensorDataJSONLength();
+    logger.streamEnviroDIYHeaders(&pieces, length);
+    logger.printSensorDataJSON(&pieces);
+    CHECK_EQUAL(0, String::getHeapStats().allocations);
+    CHECK_STRING(expected, pieces.text.c_str());
+    CHECK_EQUAL(logger.generateSensorDataJSON().length(), length);
+}
+
+static void testPortalGetsRequest(void)
+{
+    String expected = oldRequest();
+    logger.modem.wake();
+    CHECK(logger.modem.connectNetwork());
+    portalRequest.clear();
+    CHECK_EQUAL(201, logger.postDataEnviroDIY());
+    CHECK_STRING(expected, portalRequest.c_str());
+    logger.modem.disconnectNetwork();
+    logger.modem.off();
+}
+
+int main(void)
+{
+    SdFat::setRoot("card");
+    HostShim::linkPin(19, 23);
+    TinyGsm::setResponder(portalResponder);
+
+    Variable *variableList[REQ_NUM_VARIABLES];
+    for (int s = 0; s < REQ_NUM_SENSORS; s++)
+    {
+        RequestSensor *sensor = new RequestSensor(s + 1, values[s]);
+        for (int v = 0; v < MAX_NUMBER_VARS; v++)
+        {
+            Variable *var = new Variable(sensor, v, F("temperature"),
+                                         F("degreeCelsius"), resolutions[s],
+                                         F("ReqTemp"));
+            var->setup();
+            variableList[s*MAX_NUMBER_VARS + v] = var;
+            UUIDs[s*MAX_NUMBER_VARS + v] = "12345678-abcd-1234-abcd-1234567890ab";
+        }
+        sensor->update();
+    }
+    logger.init(12, -1, REQ_NUM_VARIABLES, variableList, 5, "Request");
+    logger.setToken("12345678-abcd-1234-abcd-1234567890ab");
+    logger.setSamplingFeature("12345678-abcd-1234-abcd-1234567890ab");
+    logger.setUUIDs(UUIDs);
+    logger.modem.setupModem(&Serial1, 18, 19, 23, held, "apn");
+    logger.setTimeZone(-5);
+    logger.markTime(1500000000);
+
+    testRequestMatches();
+    testPortalGetsRequest();
+
+    return TEST_RESULT();
+}
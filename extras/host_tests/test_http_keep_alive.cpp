@@ -0,0 +1,162 @@
+/*
+ *test_http_keep_alive.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This checks that a batch of queued records is sent to EnviroDIY oldest first
+ *over a single connection when the portal keeps it open, over a new
+ *connection for each record when the portal closes it, and that a failed post
+ *leaves it and everything after it in the queue for the next batch.
+*/
+
+#define TINY_GSM_MODEM_SIM800
+#include "HostTest.h"
+#include <LoggerEnviroDIY.h>
+#include <MaximDS3231.h>
+#include <string>
+#include <vector>
+
+MaximDS3231 ds3231(1);
+Variable *variableList[] = {new MaximDS3231_Temp(&ds3231)};
+const char *UUIDs[] = {"12345678-abcd-1234-abcd-1234567890ab"};
+LoggerEnviroDIY logger;
+
+// What the pretend portal has been sent and how it should answer
+static std::vector<std::string> postedBodies;
+static std::vector<uint32_t> postConnections;  // The connection each came on
+static bool portalCloses = false;
+static int portalFailsAt = -1;  // The post to answer with "503", if any
+
+static String portalResponder(const String &host, uint16_t port, const String &request)
+{
+    if (host != "data.envirodiy.org")
+        return TinyGsm::createdResponse(host, port, request);
+    std::string text = request.c_str();
+    size_t bodyStart = text.find("\r\n\r\n");
+    int postNumber = postedBodies.size();
+    postConnections.push_back(TinyGsm::getStats().connects);
+    postedBodies.push_back(bodyStart == std::string::npos ? "" : text.substr(bodyStart + 4));
+    if (postNumber == portalFailsAt)
+        return "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n";
+    if (portalCloses)
+        return "HTTP/1.1 201 Created\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    return "HTTP/1.1 201 Created\r\nContent-Length: 2\r\n\r\nOK";
+}
+
+// Put the given number of records in the queue, a minute apart, and return
+// what each one should be posted as
+static std::vector<std::string> queueRecords(int count)
+{
+    static uint32_t nextEpoch = HOST_START_EPOCH;
+    std::vector<std::string> records;
+    for (int i = 0; i < count; i++)
+    {
+        nextEpoch += 60;
+        logger.markTime(nextEpoch);
+        records.push_back(logger.generateSensorDataJSON().c_str());
+        CHECK(logger.queueDataEnviroDIY());
+    }
+    return records;
+}
+
+static void resetPortal(void)
+{
+    postedBodies.clear();
+    postConnections.clear();
+    portalCloses = false;
+    portalFailsAt = -1;
+    TinyGsm::resetStats();
+}
+
+static void testBatchUsesOneConnection(void)
+{
+    std::vector<std::string> records = queueRecords(5);
+    resetPortal();
+    CHECK_EQUAL(5, logger.sendQueueEnviroDIY());
+
+    TinyGsmHostStats stats = TinyGsm::getStats();
+    CHECK_EQUAL(1, stats.connects);
+    CHECK_EQUAL(5, stats.requests);
+    CHECK(postedBodies == records);
+    CHECK_EQUAL(0, logger.getQueuedBytes());
+}
+
+static void testClosedConnectionIsReopened(void)
+{
+    std::vector<std::string> records = queueRecords(3);
+    resetPortal();
+    portalCloses = true;
+    CHECK_EQUAL(3, logger.sendQueueEnviroDIY());
+
+    TinyGsmHostStats stats = TinyGsm::getStats();
+    CHECK_EQUAL(3, stats.connects);
+    CHECK_EQUAL(3, stats.requests);
+    CHECK(postedBodies == records);
+    CHECK_EQUAL(0, logger.getQueuedBytes());
+}
+
+static void testFailedPostStaysQueued(void)
+{
+    std::vector<std::string> records = queueRecords(4);
+    resetPortal();
+    portalFailsAt = 2;
+    CHECK_EQUAL(2, logger.sendQueueEnviroDIY());
+    CHECK_EQUAL(3, postedBodies.size());
+    CHECK(logger.getQueuedBytes() > 0);
+
+    // The next batch starts again with the record that failed
+    resetPortal();
+    CHECK_EQUAL(2, logger.sendQueueEnviroDIY());
+    CHECK_EQUAL(1, TinyGsm::getStats().connects);
+    CHECK(postedBodies == std::vector<std::string>(records.begin() + 2, records.end()));
+    CHECK_EQUAL(0, logger.getQueuedBytes());
+}
+
+// Logging with a batch of three, the modem connects once for each batch and
+// the portal gets every record exactly once
+static void testLoggingInBatches(void)
+{
+    resetPortal();
+    logger.setBatchSize(3);
+    while (HostShim::getMicros() < 3*3600000000ULL) logger.log();
+
+    int numPosts = postedBodies.size();
+    CHECK(numPosts >= 36);
+    CHECK_EQUAL(numPosts/3, TinyGsm::getStats().connects);
+    for (int i = 0; i < numPosts; i++)
+    {
+        CHECK_EQUAL(i/3 + 1, postConnections[i]);
+        if (i > 0) CHECK(postedBodies[i] != postedBodies[i - 1]);
+    }
+    // Only the readings since the last batch are waiting
+    CHECK(logger.getQueuedBytes() <= 2*(postedBodies[0].size() + 2));
+}
+
+int main(void)
+{
+    SdFat::setRoot("card");
+    remove(SdFat::getPath(ENVIRODIY_QUEUE_FILE).c_str());
+    remove(SdFat::getPath(ENVIRODIY_CURSOR_FILE).c_str());
+    HostShim::linkPin(19, 23);
+    TinyGsm::setResponder(portalResponder);
+
+    logger.init(12, 10, 1, variableList, 5, "KeepAlive");
+    logger.setToken("12345678-abcd-1234-abcd-1234567890ab");
+    logger.setSamplingFeature("12345678-abcd-1234-abcd-1234567890ab");
+    logger.setUUIDs(UUIDs);
+    logger.modem.setupModem(&Serial1, 18, 19, 23, held, "apn");
+    logger.begin();
+
+    logger.modem.wake();
+    CHECK(logger.modem.connectNetwork());
+    testBatchUsesOneConnection();
+    testClosedConnectionIsReopened();
+    testFailedPostStaysQueued();
+    logger.modem.disconnectNetwork();
+    logger.modem.off();
+
+    testLoggingInBatches();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,79 @@
+/*
+ *test_http_response_parser.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This checks that HTTPResponseParser gives the final response code, reading
+ *past any "100 Continue" before it, and knows when the whole response has
+ *been read and whether the connection can be used again, whatever bytes are
+ *in the headers.
+*/
+
+#include "HostTest.h"
+#include <HTTPResponseParser.h>
+
+static void testContinueThenCreated(void)
+{
+    Serial1.inject("HTTP/1.1 100 Continue\r\n\r\n"
+                   "HTTP/1.1 201 Created\r\nContent-Length: 2\r\n\r\nOK");
+    HTTPResponseParser response;
+    CHECK_EQUAL(201, response.readStatus(&Serial1, 1000));
+    CHECK_EQUAL(201, response.getStatusCode());
+    CHECK(response.readToEnd(&Serial1, 1000));
+    CHECK(response.canReuseConnection());
+    CHECK_EQUAL(0, Serial1.available());
+}
+
+static void testContinueHeadersAreNotKept(void)
+{
+    Serial1.inject("HTTP/1.1 100 Continue\r\nConnection: close\r\n\r\n"
+                   "HTTP/1.1 500 Internal Server Error\r\nTransfer-Encoding: chunked\r\n\r\n"
+                   "4\r\nfail\r\n0\r\n\r\n");
+    HTTPResponseParser response;
+    CHECK_EQUAL(500, response.readStatus(&Serial1, 1000));
+    CHECK(response.readToEnd(&Serial1, 1000));
+    CHECK(response.canReuseConnection());
+    CHECK_EQUAL(0, Serial1.available());
+}
+
+static void testOnlyContinueIsNoResponse(void)
+{
+    Serial1.inject("HTTP/1.1 100 Continue\r\n\r\n");
+    HTTPResponseParser response;
+    uint32_t start = millis();
+    CHECK_EQUAL(0, response.readStatus(&Serial1, 1000));
+    CHECK(millis() - start >= 1000);
+    CHECK(!response.canReuseConnection());
+}
+
+static void testClosingResponse(void)
+{
+    Serial1.inject("HTTP/1.1 201 Created\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+    HTTPResponseParser response;
+    CHECK_EQUAL(201, response.readStatus(&Serial1, 1000));
+    CHECK(response.readToEnd(&Serial1, 1000));
+    CHECK(!response.canReuseConnection());
+}
+
+// Characters above 127 in the headers are only passed over
+static void testHighCharactersInHeaders(void)
+{
+    Serial1.inject("HTTP/1.1 201 Cr\xe9\xe9\r\nX-Caf\xe9: \xff\xc0\r\n"
+                   "Content-Length: 2\r\n\r\nOK");
+    HTTPResponseParser response;
+    CHECK_EQUAL(201, response.readStatus(&Serial1, 1000));
+    CHECK(response.readToEnd(&Serial1, 1000));
+    CHECK(response.canReuseConnection());
+    CHECK_EQUAL(0, Serial1.available());
+}
+
+int main(void)
+{
+    testContinueThenCreated();
+    testContinueHeadersAreNotKept();
+    testOnlyContinueIsNoResponse();
+    testClosingResponse();
+    testHighCharactersInHeaders();
+    return TEST_RESULT();
+}
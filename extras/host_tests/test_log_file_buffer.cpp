@@ -0,0 +1,159 @@
+/*
+ *test_log_file_buffer.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This checks that LogFileBuffer only leaves whole records on the card when
+ *writes fail: a record split over a good write and a failed one is cut off
+ *the card, even if the card has to be put back first, and a failed write of
+ *whole records does not leave them on the card twice.
+*/
+
+#include "HostTest.h"
+#include <LogFileBuffer.h>
+#include <string>
+
+#define FILE_NAME "buffer.csv"
+
+SdFat sd;
+SdFile logFile;
+LogFileBuffer logBuffer;
+
+static std::string readCard(void)
+{
+    std::string text;
+    FILE *fp = fopen(SdFat::getPath(FILE_NAME).c_str(), "rb");
+    if (fp == NULL) return text;
+    char buf[256];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) text.append(buf, n);
+    fclose(fp);
+    return text;
+}
+
+// A record of the given length: a letter repeated, then a new line
+static std::string makeRecord(char letter, int length)
+{
+    return std::string(length - 1, letter) + "\n";
+}
+
+// Start a file with 500 bytes already on it, so the buffer is written after
+// 12 more bytes to line up with the card blocks
+static std::string startFile(void)
+{
+    logBuffer.detach();
+    if (logFile.isOpen()) logFile.close();
+    SdFat::setCardPresent(true);
+    SdFat::setWriteLimit(-1);
+    sd.remove(FILE_NAME);
+    logFile.open(FILE_NAME, O_CREAT | O_WRITE | O_AT_END);
+    std::string start = makeRecord('a', 500);
+    logFile.write(start.c_str(), start.size());
+    logFile.sync();
+    logBuffer.attach(&logFile);
+    return start;
+}
+
+static bool logRecord(const std::string &record)
+{
+    logBuffer.beginRecord();
+    logBuffer.print(record.c_str());
+    return logBuffer.endRecord();
+}
+
+static void reattach(void)
+{
+    logBuffer.detach();
+    logFile.close();
+    logFile.open(FILE_NAME, O_WRITE | O_AT_END);
+    logBuffer.attach(&logFile);
+}
+
+static void testSplitRecordIsCutOff(void)
+{
+    std::string start = startFile();
+    // The first 12 bytes of the record are written, then only 100 of the next
+    // 512 fit before the card fails
+    SdFat::setWriteLimit(112);
+    CHECK(!logRecord(makeRecord('b', 600)));
+    CHECK(logBuffer.writeFailed());
+    CHECK_EQUAL(0, logBuffer.length());
+    CHECK(readCard() == start);
+
+    // Once the card works again the next record follows the old ones
+    SdFat::setWriteLimit(-1);
+    reattach();
+    std::string next = makeRecord('c', 40);
+    CHECK(logRecord(next));
+    CHECK(logBuffer.writeBuffer());
+    CHECK(readCard() == start + next);
+}
+
+static void testCutWaitsForCard(void)
+{
+    std::string start = startFile();
+    // The start of the record is written, then the card is taken out
+    logBuffer.beginRecord();
+    std::string record = makeRecord('b', 600);
+    logBuffer.print(record.substr(0, 20).c_str());
+    CHECK_EQUAL(500 + 12, readCard().size());
+    SdFat::setCardPresent(false);
+    logBuffer.print(record.substr(20).c_str());
+    CHECK(!logBuffer.endRecord());
+    CHECK_EQUAL(500 + 12, readCard().size());
+
+    // The part of the record is cut off when the card is back
+    SdFat::setCardPresent(true);
+    reattach();
+    CHECK(readCard() == start);
+    std::string next = makeRecord('c', 40);
+    CHECK(logRecord(next));
+    CHECK(logBuffer.writeBuffer());
+    CHECK(readCard() == start + next);
+}
+
+static void testFailedFlushIsNotRepeated(void)
+{
+    std::string start = startFile();
+    std::string first = makeRecord('b', 5);
+    std::string second = makeRecord('c', 5);
+    CHECK(logRecord(first));
+    CHECK(logRecord(second));
+
+    // Only part of the buffer is written before the card fails
+    SdFat::setWriteLimit(7);
+    CHECK(!logBuffer.writeBuffer());
+    CHECK(readCard() == start);
+    CHECK_EQUAL(10, logBuffer.length());
+
+    // Writing again puts both records on the card once
+    SdFat::setWriteLimit(-1);
+    reattach();
+    CHECK(logBuffer.writeBuffer());
+    CHECK(readCard() == start + first + second);
+}
+
+static void testWholeRecordsAcrossBlocks(void)
+{
+    std::string start = startFile();
+    std::string expected = start;
+    for (int i = 0; i < 30; i++)
+    {
+        std::string record = makeRecord('d' + i % 10, 55);
+        CHECK(logRecord(record));
+        expected += record;
+    }
+    CHECK(logBuffer.writeBuffer());
+    CHECK(readCard() == expected);
+}
+
+int main(void)
+{
+    SdFat::setRoot("card");
+    testSplitRecordIsCutOff();
+    testCutWaitsForCard();
+    testFailedFlushIsNotRepeated();
+    testWholeRecordsAcrossBlocks();
+    return TEST_RESULT();
+}
@@ -0,0 +1,69 @@
+/*
+ *test_logger_smoke.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This checks that a logger built against the host shim starts, sleeps between
+ *readings, and writes a header and one record per reading to the card.
+*/
+
+#include "HostTest.h"
+#include <LoggerBase.h>
+#include <MaximDS3231.h>
+#include <ProcessorMetadata.h>
+#include <string>
+
+MaximDS3231 ds3231(1);
+ProcessorMetadata mayfly("v0.5");
+Variable *variableList[] = {
+    new MaximDS3231_Temp(&ds3231),
+    new ProcessorMetadata_Batt(&mayfly)
+};
+Logger logger;
+
+static std::string readFile(const String &path)
+{
+    std::string text;
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (fp == NULL) return text;
+    char buf[256];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) text.append(buf, n);
+    fclose(fp);
+    return text;
+}
+
+int main(void)
+{
+    SdFat::setRoot("card");
+    remove(SdFat::getPath("Smoke_2017-01-01.csv").c_str());
+    rtc.setTemperature(21.5);
+
+    logger.init(12, 10, 2, variableList, 5, "Smoke");
+    logger.setAlertPin(8);
+    logger.begin();
+    CHECK_STRING("Smoke_2017-01-01.csv", logger.getFileName());
+
+    // Log for an hour; the logger sleeps until the clock wakes it each minute
+    while (HostShim::getMicros() < 3600000000ULL) logger.log();
+    logger.flushLogFile();
+
+    CHECK(HostShim::getSleepCount() >= 59);
+    CHECK(HostShim::getSleepCount() <= 61);
+
+    std::string text = readFile(SdFat::getPath("Smoke_2017-01-01.csv"));
+    CHECK(text.find("temperatureRTC") != std::string::npos);
+    // Every two minutes (and at five) for the first ten readings, then every five
+    int records = 0;
+    size_t at = 0;
+    while ((at = text.find("\n2017-01-01 ", at)) != std::string::npos)
+    {
+        records++;
+        at++;
+    }
+    CHECK_EQUAL(10 + (60 - 20)/5, records);
+    CHECK(text.find("2017-01-01 00:20:00,21.50") != std::string::npos);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,107 @@
+/*
+ *test_maxbotix_sonar.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This checks that MaxBotixFrameParser only gives ranges from whole "Rxxxx<CR>"
+ *frames, skipping the header lines, and that MaxBotixSonar reports the median
+ *of the good ranges, leaving out the values the sonar sends when it has no
+ *good range.
+*/
+
+#include "HostTest.h"
+#include <MaxBotixSonar.h>
+
+// Feed text to a parser, returning the ranges found, separated by commas
+static String parseAll(MaxBotixFrameParser &parser, const char *text)
+{
+    String ranges;
+    for (const char *c = text; *c != '\0'; c++)
+    {
+        int16_t range = parser.parse(*c);
+        if (range < 0) continue;
+        if (ranges.length() > 0) ranges += ',';
+        ranges += range;
+    }
+    return ranges;
+}
+
+static void testFrameParser(void)
+{
+    MaxBotixFrameParser parser;
+    CHECK_STRING("1234", parseAll(parser, "R1234\r"));
+    CHECK_STRING("501,9999", parseAll(parser, "R0501\rR9999\r"));
+
+    // The header the sonar sends when it is powered on has no frames in it,
+    // even though some of its lines have an "R" in them
+    CHECK_STRING("", parseAll(parser, "HRXL-MaxSonar-WRL\rPN:MB7386\rCopyright 2011-2013\r"
+                                      "MaxBotix Inc.\rRoHS 1.8b090  0713\rTempI\r"));
+    CHECK_STRING("2000", parseAll(parser, "TempI\rR2000\r"));
+
+    // Frames with too few or too many digits, or anything else in them
+    CHECK_STRING("", parseAll(parser, "R123\r"));
+    CHECK_STRING("", parseAll(parser, "R12345\r"));
+    CHECK_STRING("", parseAll(parser, "R12a4\r"));
+    CHECK_STRING("", parseAll(parser, "R1234\n"));
+
+    // A frame cut off by the start of the next one
+    CHECK_STRING("4321", parseAll(parser, "R12R4321\r"));
+
+    // A frame split across reads of the stream
+    CHECK_STRING("", parseAll(parser, "R08"));
+    CHECK_STRING("876", parseAll(parser, "76\r"));
+    parser.reset();
+    CHECK_STRING("", parseAll(parser, "55\r"));
+}
+
+// Take one measurement, with the sonar sending the given text once it starts
+static SENSOR_STATUS measure(MaxBotixSonar &sonar, const char *frames)
+{
+    sonar.startMeasurement();
+    Serial1.inject(frames);
+    while (!sonar.isMeasurementReady()) {}
+    return sonar.collectMeasurement();
+}
+
+static void testMedianOfGoodRanges(void)
+{
+    MaxBotixSonar sonar(-1, Serial1, -1, 5);
+    sonar.setup();
+    // The 300, 500 and 9999 are what the sonar sends when it has no good range
+    CHECK_EQUAL(SENSOR_READY, measure(sonar, "RoHS 1.8b090  0713\rTempI\r"
+                                             "R1000\rR0300\rR1200\rR9999\rR0900\r"
+                                             "R0500\rR1100\rR1050\rR2000\r"));
+    CHECK_CLOSE(1050, sonar.sensorValues[HRXL_VAR_NUM], 0.001);
+    // The range after the fifth good one was not used
+    CHECK(Serial1.available() > 0);
+    while (Serial1.available() > 0) Serial1.read();
+}
+
+static void testMedianOfEvenCount(void)
+{
+    MaxBotixSonar sonar(-1, Serial1, -1, 5);
+    sonar.setup();
+    // Only four good ranges come in before the time runs out
+    uint32_t start = millis();
+    CHECK_EQUAL(SENSOR_READY, measure(sonar, "R1000\rR1200\rR4999\rR0900\rR1100\r"));
+    CHECK(millis() - start >= HRXL_TIME_BUDGET);
+    CHECK_CLOSE(1050, sonar.sensorValues[HRXL_VAR_NUM], 0.001);
+}
+
+static void testNoGoodRanges(void)
+{
+    MaxBotixSonar sonar(-1, Serial1, -1, 3);
+    sonar.setup();
+    CHECK_EQUAL(SENSOR_ERROR, measure(sonar, "R9999\rR0300\rR123\r"));
+    CHECK_EQUAL(-9999, sonar.sensorValues[HRXL_VAR_NUM]);
+}
+
+int main(void)
+{
+    testFrameParser();
+    testMedianOfGoodRanges();
+    testMedianOfEvenCount();
+    testNoGoodRanges();
+    return TEST_RESULT();
+}
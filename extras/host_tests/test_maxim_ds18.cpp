@@ -0,0 +1,97 @@
+/*
+ *test_maxim_ds18.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This checks that a DS18 which gives a bad result (85 C) is tried again with
+ *a new conversion of its own, even while a slower sensor on the same pin is
+ *still converting, and that setting the resolution writes the sensor's
+ *EEPROM only once, and only when it has changed.  It also checks that setting
+ *up a sensor searches the bus again, so a sensor added later is found.
+*/
+
+#include "HostTest.h"
+#include <MaximDS18.h>
+
+#define DATA_PIN 5
+#define POWER_PIN 22
+
+static DeviceAddress addressFast = {0x28, 0xFF, 0x10, 0x20, 0x30, 0x40, 0x50, 0};
+static DeviceAddress addressSlow = {0x28, 0xFF, 0x11, 0x21, 0x31, 0x41, 0x51, 0};
+static DeviceAddress addressLate = {0x28, 0xFF, 0x12, 0x22, 0x32, 0x42, 0x52, 0};
+
+static void testResolutionIsWrittenOnce(MaximDS18 *fast, MaximDS18 *slow)
+{
+    OneWireHostDevice *fastDevice = OneWire::findDevice(DATA_PIN, addressFast);
+    OneWireHostDevice *slowDevice = OneWire::findDevice(DATA_PIN, addressSlow);
+    CHECK_EQUAL(SENSOR_READY, fast->setup());
+    CHECK_EQUAL(SENSOR_READY, slow->setup());
+    CHECK_EQUAL(9, fastDevice->resolution);
+    CHECK_EQUAL(1, fastDevice->eepromWrites);
+    // The slow sensor already has the default resolution
+    CHECK_EQUAL(0, slowDevice->eepromWrites);
+
+    // Nothing has changed, so nothing is written
+    CHECK_EQUAL(SENSOR_READY, fast->setup());
+    CHECK_EQUAL(1, fastDevice->eepromWrites);
+}
+
+static void testBadResultIsConvertedAgain(MaximDS18 *fast, MaximDS18 *slow)
+{
+    OneWire::findDevice(DATA_PIN, addressFast)->badConversions = 1;
+    uint32_t conversions = OneWire::getConversionCount();
+    uint32_t start = millis();
+    CHECK(MaximDS18::updateBus(DATA_PIN));
+
+    // The slow sensor's conversion was still running when the fast one was
+    // tried again, but the fast one got a new conversion of its own
+    CHECK_EQUAL(conversions + 2, OneWire::getConversionCount());
+    CHECK_CLOSE(12.5, fast->sensorValues[DS18_TEMP_VAR_NUM], 0.001);
+    CHECK_CLOSE(21.25, slow->sensorValues[DS18_TEMP_VAR_NUM], 0.001);
+    // and both were finished within the warm up and the slow sensor's
+    // conversion time
+    CHECK(millis() - start < DS18_WARM_UP + 800);
+}
+
+static void testBadResultsGiveUp(MaximDS18 *fast)
+{
+    OneWire::findDevice(DATA_PIN, addressFast)->badConversions = 100;
+    uint32_t conversions = OneWire::getConversionCount();
+    MaximDS18::updateBus(DATA_PIN);
+    CHECK_EQUAL(85, fast->sensorValues[DS18_TEMP_VAR_NUM]);
+    // The first conversion of the bus, then one for each of 49 retries
+    CHECK_EQUAL(conversions + 50, OneWire::getConversionCount());
+    OneWire::findDevice(DATA_PIN, addressFast)->badConversions = 0;
+}
+
+// A sensor plugged in after the bus was first searched is found by its setup
+static void testSetupSearchesBus(void)
+{
+    OneWire::addDevice(DATA_PIN, addressLate, 4.5);
+    MaximDS18 *late = new MaximDS18(addressLate, POWER_PIN, DATA_PIN);
+    CHECK_EQUAL(SENSOR_READY, late->setup());
+    CHECK_EQUAL(3, OneWireBus::getBus(DATA_PIN)->begin()->getDeviceCount());
+    CHECK(MaximDS18::updateBus(DATA_PIN));
+    CHECK_CLOSE(4.5, late->sensorValues[DS18_TEMP_VAR_NUM], 0.001);
+}
+
+int main(void)
+{
+    addressFast[7] = OneWire::crc8(addressFast, 7);
+    addressSlow[7] = OneWire::crc8(addressSlow, 7);
+    addressLate[7] = OneWire::crc8(addressLate, 7);
+    OneWire::addDevice(DATA_PIN, addressFast, 12.5);
+    OneWire::addDevice(DATA_PIN, addressSlow, 21.25);
+
+    MaximDS18 *fast = new MaximDS18(addressFast, POWER_PIN, DATA_PIN);
+    MaximDS18 *slow = new MaximDS18(addressSlow, POWER_PIN, DATA_PIN);
+    fast->setResolution(9);
+
+    testResolutionIsWrittenOnce(fast, slow);
+    testBadResultIsConvertedAgain(fast, slow);
+    testBadResultsGiveUp(fast);
+    testSetupSearchesBus();
+
+    return TEST_RESULT();
+}
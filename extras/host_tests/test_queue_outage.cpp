@@ -0,0 +1,156 @@
+/*
+ *test_queue_outage.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This checks that the records queued for EnviroDIY while the network is down
+ *for two days are all sent, in order and exactly once, within a few
+ *connections once it comes back.  It also checks that the place reached in
+ *the queue is saved once per connection instead of once per record, that the
+ *sent records are cut off the front of the queue file so it does not keep
+ *growing, and that a cut-off that was interrupted by a reset is finished.
+*/
+
+#define TINY_GSM_MODEM_SIM800
+#include "HostTest.h"
+#include <LoggerEnviroDIY.h>
+#include <MaximDS3231.h>
+#include <string>
+#include <vector>
+
+MaximDS3231 ds3231(1);
+Variable *variableList[] = {new MaximDS3231_Temp(&ds3231)};
+const char *UUIDs[] = {"12345678-abcd-1234-abcd-1234567890ab"};
+LoggerEnviroDIY logger;
+
+// Everything the pretend portal has been sent
+static std::vector<std::string> postedBodies;
+
+static String portalResponder(const String &host, uint16_t port, const String &request)
+{
+    if (host != "data.envirodiy.org")
+        return TinyGsm::createdResponse(host, port, request);
+    std::string text = request.c_str();
+    size_t bodyStart = text.find("\r\n\r\n");
+    postedBodies.push_back(bodyStart == std::string::npos ? "" : text.substr(bodyStart + 4));
+    return "HTTP/1.1 201 Created\r\nContent-Length: 0\r\n\r\n";
+}
+
+static uint32_t fileSize(const char *fileName)
+{
+    FILE *fp = fopen(SdFat::getPath(fileName).c_str(), "rb");
+    if (fp == NULL) return 0;
+    fseek(fp, 0, SEEK_END);
+    uint32_t size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+// Logs until the logger has connected to send the given number more times
+static void logSessions(int numSessions)
+{
+    uint32_t target = TinyGsm::getStats().networkAttempts + numSessions;
+    while (TinyGsm::getStats().networkAttempts < target) logger.log();
+}
+
+static void testOutageDrains(void)
+{
+    // Two days without the network
+    TinyGsm::setNetworkAvailable(false);
+    while (HostShim::getMicros() < 2*86400000000ULL) logger.log();
+    CHECK(postedBodies.empty());
+    uint32_t queued = logger.getQueuedBytes();
+    CHECK(queued > 2*ENVIRODIY_QUEUE_COMPACT_BYTES);
+
+    // Once the network is back, each connection sends as much as its time
+    // budget allows, so the backlog is gone within a few hours of batches
+    TinyGsm::setNetworkAvailable(true);
+    int numSessions = 0;
+    int maxSessions = 12;
+    while (logger.getQueuedBytes() > 0 && numSessions < maxSessions)
+    {
+        logSessions(1);
+        numSessions++;
+        // The records already sent never take up much of the file
+        CHECK(fileSize(ENVIRODIY_QUEUE_FILE) - logger.getQueuedBytes() < ENVIRODIY_QUEUE_COMPACT_BYTES);
+    }
+    CHECK_EQUAL(0, logger.getQueuedBytes());
+    CHECK(numSessions <= maxSessions);
+    CHECK(numSessions > 1);
+
+    // Every reading was sent once, oldest first
+    for (size_t i = 0; i < postedBodies.size(); i++)
+    {
+        size_t at = postedBodies[i].find("\"timestamp\":");
+        CHECK(at != std::string::npos);
+        if (i > 0) CHECK(postedBodies[i].substr(at, 40) > postedBodies[i - 1].substr(at, 40));
+    }
+    CHECK(postedBodies.size() > 2*288);
+}
+
+static void testCursorIsSavedOncePerConnection(void)
+{
+    // Build up a backlog of 20 records
+    uint32_t epoch = Logger::markedEpochTime;
+    for (int i = 0; i < 20; i++)
+    {
+        epoch += 300;
+        logger.markTime(epoch);
+        CHECK(logger.queueDataEnviroDIY());
+    }
+
+    logger.modem.wake();
+    CHECK(logger.modem.connectNetwork());
+    SdFat::resetStats();
+    size_t numPosted = postedBodies.size();
+    CHECK_EQUAL(20, logger.sendQueueEnviroDIY());
+    CHECK_EQUAL(numPosted + 20, postedBodies.size());
+    // The queue was opened to read it, then removed and the cursor saved
+    CHECK(SdFat::getStats().opens <= 2);
+    logger.modem.disconnectNetwork();
+    logger.modem.off();
+}
+
+static void testInterruptedCutOffIsFinished(void)
+{
+    // A reset after the old queue was removed, but before the new one was
+    // renamed, leaves only the new file
+    remove(SdFat::getPath(ENVIRODIY_QUEUE_FILE).c_str());
+    FILE *fp = fopen(SdFat::getPath(ENVIRODIY_QUEUE_TEMP_FILE).c_str(), "wb");
+    fputs("{\"a\":1}\r\n{\"b\":2}\r\n", fp);
+    fclose(fp);
+
+    LoggerEnviroDIY restarted;
+    restarted.init(12, 10, 1, variableList, 5, "Restart");
+    restarted.setToken("12345678-abcd-1234-abcd-1234567890ab");
+    restarted.setSamplingFeature("12345678-abcd-1234-abcd-1234567890ab");
+    restarted.setUUIDs(UUIDs);
+    CHECK_EQUAL(18, restarted.getQueuedBytes());
+    CHECK_EQUAL(18, fileSize(ENVIRODIY_QUEUE_FILE));
+    CHECK_EQUAL(0, fileSize(ENVIRODIY_QUEUE_TEMP_FILE));
+}
+
+int main(void)
+{
+    SdFat::setRoot("card");
+    remove(SdFat::getPath(ENVIRODIY_QUEUE_FILE).c_str());
+    remove(SdFat::getPath(ENVIRODIY_CURSOR_FILE).c_str());
+    remove(SdFat::getPath(ENVIRODIY_QUEUE_TEMP_FILE).c_str());
+    HostShim::linkPin(19, 23);
+    TinyGsm::setResponder(portalResponder);
+
+    logger.init(12, 10, 1, variableList, 5, "Outage");
+    logger.setToken("12345678-abcd-1234-abcd-1234567890ab");
+    logger.setSamplingFeature("12345678-abcd-1234-abcd-1234567890ab");
+    logger.setUUIDs(UUIDs);
+    logger.setBatchSize(3);
+    logger.modem.setupModem(&Serial1, 18, 19, 23, held, "apn");
+    logger.begin();
+
+    testOutageDrains();
+    testCursorIsSavedOncePerConnection();
+        testInterruptedCutOffIsFinished();
+
+    return TEST_RESULT();
+}
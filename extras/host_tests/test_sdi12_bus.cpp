@@ -0,0 +1,159 @@
+/*
+ *test_sdi12_bus.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This checks that DecagonSDI12::updateBus() measures every sensor on a data
+ *pin concurrently: the whole bus takes as long as the slowest sensor, each
+ *sensor is collected as soon as it is finished, a sensor that does not answer
+ *does not hold up the rest, and the other sensors' update() uses the values
+ *measured along with the bus instead of measuring again.
+*/
+
+#include "HostTest.h"
+#include <DecagonSDI12.h>
+#include <SDI12_ExtInts.h>
+
+#define DATA_PIN 7
+#define OTHER_PIN 8
+#define POWER_PIN 22
+
+// The pretend sensors: their address, the seconds they say a measurement
+// takes, and the values they return
+struct BusSensor
+{
+    char address;
+    int waitSeconds;
+    const char *values;
+    bool present;
+    uint64_t startedAt;  // When the last "aC!" was sent, in microseconds
+};
+static BusSensor busSensors[] = {
+    {'1', 3, "+1.5+10.25", true, 0},
+    {'2', 1, "+2.5+20.25", true, 0},
+    {'3', 2, "+3.5+30.25", true, 0},
+    {'4', 1, "+4.5+40.25", false, 0}
+};
+#define NUM_BUS_SENSORS (sizeof(busSensors)/sizeof(busSensors[0]))
+
+// The addresses of the "aD0!" commands answered with values, in order
+static String collectOrder;
+static String otherPinCommands;
+
+static String busResponder(int dataPin, const String &command)
+{
+    if (dataPin != DATA_PIN)
+    {
+        otherPinCommands += command;
+        return "";
+    }
+    BusSensor *sensor = NULL;
+    for (size_t i = 0; i < NUM_BUS_SENSORS; i++)
+    {
+        if (busSensors[i].address == command[0]) sensor = &busSensors[i];
+    }
+    if (sensor == NULL || !sensor->present) return "";
+
+    String reply = String(sensor->address);
+    String request = command.substring(1);
+    if (request == "!") return reply;
+    if (request == "I!") return reply + "13DECAGON 5TM   410";
+    if (request == "C!")
+    {
+        sensor->startedAt = HostShim::getMicros();
+        return reply + "00" + String(sensor->waitSeconds) + "02";
+    }
+    if (request == "D0!")
+    {
+        // The values are only there once the measurement is finished
+        if (HostShim::getMicros() - sensor->startedAt < sensor->waitSeconds*1000000ULL)
+            return reply;
+        collectOrder += sensor->address;
+        return reply + sensor->values;
+    }
+    return "";
+}
+
+DecagonSDI12 sensor1('1', POWER_PIN, DATA_PIN, 1, "Bus1", 2);
+DecagonSDI12 sensor2('2', POWER_PIN, DATA_PIN, 1, "Bus2", 2);
+DecagonSDI12 sensor3('3', POWER_PIN, DATA_PIN, 1, "Bus3", 2);
+DecagonSDI12 otherSensor('5', POWER_PIN, OTHER_PIN, 1, "Other", 2);
+
+static void testBusIsMeasuredConcurrently(void)
+{
+    collectOrder = "";
+    otherPinCommands = "";
+    uint32_t start = millis();
+    CHECK(DecagonSDI12::updateBus(DATA_PIN));
+    uint32_t elapsed = millis() - start;
+
+    // The slowest sensor takes 3 seconds; one after another would take 6
+    CHECK(elapsed >= 3000);
+    CHECK(elapsed < 3500);
+    CHECK_STRING("231", collectOrder);
+    CHECK_CLOSE(1.5, sensor1.sensorValues[0], 0.001);
+    CHECK_CLOSE(20.25, sensor2.sensorValues[1], 0.001);
+    CHECK_CLOSE(3.5, sensor3.sensorValues[0], 0.001);
+    CHECK_STRING("", otherPinCommands);
+    // The sensors were powered down again once all of them were finished
+    CHECK_EQUAL(LOW, HostShim::getOutputLevel(POWER_PIN));
+}
+
+static void testSharedValuesAreUsed(void)
+{
+    // The values measured in the last test are too old to be used
+    delay(SDI12_BUS_SHARED_MS);
+    collectOrder = "";
+    CHECK(sensor3.update());
+    CHECK_STRING("231", collectOrder);
+
+    // The rest of the bus was measured along with sensor 3
+    SDI12::resetCommandCount();
+    CHECK(sensor1.update());
+    CHECK(sensor2.update());
+    CHECK_EQUAL(0, SDI12::getCommandCount());
+
+    // but only once; the next update measures the bus again
+    CHECK(sensor1.update());
+    CHECK(SDI12::getCommandCount() > 0);
+}
+
+static void testSharedValuesExpire(void)
+{
+    CHECK(sensor1.update());
+    delay(SDI12_BUS_SHARED_MS);
+    SDI12::resetCommandCount();
+    CHECK(sensor2.update());
+    CHECK(SDI12::getCommandCount() > 0);
+}
+
+static void testMissingSensorDoesNotHoldUpBus(void)
+{
+    busSensors[2].present = false;
+    collectOrder = "";
+    uint32_t start = millis();
+    CHECK(!DecagonSDI12::updateBus(DATA_PIN));
+    CHECK(millis() - start < 3500);
+    CHECK_STRING("21", collectOrder);
+
+    // Only the sensor that did not answer reports the failure
+    CHECK(!sensor3.update());
+    CHECK(sensor1.update());
+    busSensors[2].present = true;
+}
+
+int main(void)
+{
+    SDI12::setResponder(busResponder);
+    CHECK_EQUAL(SENSOR_READY, sensor1.setup());
+    CHECK_EQUAL(SENSOR_READY, sensor2.setup());
+    CHECK_EQUAL(SENSOR_READY, sensor3.setup());
+
+    testBusIsMeasuredConcurrently();
+    testSharedValuesAreUsed();
+    testSharedValuesExpire();
+    testMissingSensorDoesNotHoldUpBus();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,123 @@
+/*
+ *test_sdi12_data.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This checks that SDI12Bus decodes the values in SDI-12 data replies, rejects
+ *replies that are not in the SDI-12 value format, and follows the data pages
+ *(aD0!, aD1!, ...) until all of the expected values have come in.
+*/
+
+#include "HostTest.h"
+#include <SDI12Bus.h>
+
+#define DATA_PIN 7
+
+static void testParseValues(void)
+{
+    float values[5];
+    CHECK_EQUAL(3, SDI12Bus::parseValues("1+1.23-4.5+67", '1', values, 5));
+    CHECK_CLOSE(1.23, values[0], 0.0001);
+    CHECK_CLOSE(-4.5, values[1], 0.0001);
+    CHECK_CLOSE(67, values[2], 0.0001);
+
+    // A decimal point may start or end the digits
+    CHECK_EQUAL(2, SDI12Bus::parseValues("a+.5-3.", 'a', values, 5));
+    CHECK_CLOSE(0.5, values[0], 0.0001);
+    CHECK_CLOSE(-3, values[1], 0.0001);
+    // Seven digits is the most allowed
+    CHECK_EQUAL(1, SDI12Bus::parseValues("0-1234.567", '0', values, 5));
+    CHECK_CLOSE(-1234.567, values[0], 0.001);
+
+    // An empty page has no values
+    CHECK_EQUAL(0, SDI12Bus::parseValues("1", '1', values, 5));
+}
+
+static void testParseValuesKeepsOnlyMax(void)
+{
+    float values[3] = {-9999, -9999, -9999};
+    CHECK_EQUAL(3, SDI12Bus::parseValues("1+1+2+3", '1', values, 2));
+    CHECK_CLOSE(1, values[0], 0.0001);
+    CHECK_CLOSE(2, values[1], 0.0001);
+    CHECK_CLOSE(-9999, values[2], 0.0001);
+}
+
+static void testParseValuesRejectsMalformed(void)
+{
+    float values[5];
+    // The wrong address
+    CHECK_EQUAL(-1, SDI12Bus::parseValues("2+1.0", '1', values, 5));
+    // No sign
+    CHECK_EQUAL(-1, SDI12Bus::parseValues("11.0", '1', values, 5));
+    // A sign with no digits
+    CHECK_EQUAL(-1, SDI12Bus::parseValues("1+1.0+", '1', values, 5));
+    CHECK_EQUAL(-1, SDI12Bus::parseValues("1+.", '1', values, 5));
+    // Two decimal points
+    CHECK_EQUAL(-1, SDI12Bus::parseValues("1+1.2.3", '1', values, 5));
+    // More than seven digits
+    CHECK_EQUAL(-1, SDI12Bus::parseValues("1+12345678", '1', values, 5));
+    // Anything else in the reply
+    CHECK_EQUAL(-1, SDI12Bus::parseValues("1+1.0 ", '1', values, 5));
+}
+
+static void testParseDigits(void)
+{
+    CHECK_EQUAL(12, SDI12Bus::parseDigits("012", 3));
+    CHECK_EQUAL(5, SDI12Bus::parseDigits("05x", 2));
+    CHECK_EQUAL(0, SDI12Bus::parseDigits("", 0));
+    CHECK_EQUAL(-1, SDI12Bus::parseDigits("0a2", 3));
+    // A reply that ends early is not digits
+    CHECK_EQUAL(-1, SDI12Bus::parseDigits("1", 3));
+}
+
+// A sensor that splits five values over the pages aD0! to aD2!, the way a
+// sensor does when they will not fit in one reply
+static String pagedResponder(int dataPin, const String &command)
+{
+    if (command == "3D0!") return "3+1.1-2.2";
+    if (command == "3D1!") return "3+3.3";
+    if (command == "3D2!") return "3+4.4+5.5";
+    if (command.startsWith("3D")) return "3";
+    if (command == "4D0!") return "4+1.1+garbage";
+    return "";
+}
+
+static void testGetDataFollowsPages(void)
+{
+    SDI12::setResponder(pagedResponder);
+    SDI12Bus *bus = SDI12Bus::getBus(DATA_PIN);
+
+    float values[6];
+    SDI12::resetCommandCount();
+    CHECK_EQUAL(5, bus->getData('3', values, 5));
+    CHECK_EQUAL(3, SDI12::getCommandCount());
+    CHECK_CLOSE(-2.2, values[1], 0.0001);
+    CHECK_CLOSE(3.3, values[2], 0.0001);
+    CHECK_CLOSE(5.5, values[4], 0.0001);
+
+    // Only the pages needed are asked for
+    SDI12::resetCommandCount();
+    CHECK_EQUAL(2, bus->getData('3', values, 2));
+    CHECK_EQUAL(1, SDI12::getCommandCount());
+
+    // An empty page ends the values early
+    SDI12::resetCommandCount();
+    CHECK_EQUAL(5, bus->getData('3', values, 6));
+    CHECK_EQUAL(4, SDI12::getCommandCount());
+
+    // A malformed page, or no answer at all
+    CHECK_EQUAL(-1, bus->getData('4', values, 2));
+    CHECK_EQUAL(-1, bus->getData('5', values, 2));
+    bus->end();
+}
+
+int main(void)
+{
+    testParseValues();
+    testParseValuesKeepsOnlyMax();
+    testParseValuesRejectsMalformed();
+    testParseDigits();
+    testGetDataFollowsPages();
+    return TEST_RESULT();
+}
@@ -0,0 +1,253 @@
+/*
+ *test_sensor_schedule.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This checks that VariableArray::updateAllSensorsScheduled() services the
+ *sensors earliest-ready first (not in list order), that staggered waking
+ *powers each sensor so they are all ready together, that the time spent
+ *waiting for each sensor to warm up is counted, and that the array keeps
+ *each sensor once, at the position of its last variable.
+*/
+
+#include "HostTest.h"
+#include <VariableArray.h>
+
+#define MAX_EVENTS 64
+
+// What happened to which sensor, and when
+struct Event
+{
+    char what;  // 'P'owered, 'S'tarted, 'C'ollected
+    char sensor;
+    uint32_t at_ms;
+};
+static Event events[MAX_EVENTS];
+static int numEvents = 0;
+
+static void addEvent(char what, char sensor)
+{
+    if (numEvents >= MAX_EVENTS) return;
+    events[numEvents].what = what;
+    events[numEvents].sensor = sensor;
+    events[numEvents].at_ms = HostShim::getMicros()/1000;
+    numEvents++;
+}
+
+// The time of the first event of a kind for a sensor, or -1
+static long eventTime(char what, char sensor)
+{
+    for (int i = 0; i < numEvents; i++)
+    {
+        if (events[i].what == what && events[i].sensor == sensor) return events[i].at_ms;
+    }
+    return -1;
+}
+
+// The order the sensors were collected in, ie "BCA"
+static String collectOrder(void)
+{
+    String order;
+    for (int i = 0; i < numEvents; i++)
+    {
+        if (events[i].what == 'C') order += events[i].sensor;
+    }
+    return order;
+}
+
+// A sensor that takes a set time to warm up, stabilize and measure
+class ScheduleSensor : public Sensor
+{
+public:
+    ScheduleSensor(char id, int powerPin, int warmUp_ms, int stabilization_ms, uint32_t measure_ms)
+      : Sensor(powerPin, -1, String(id), 1, warmUp_ms, stabilization_ms)
+    {
+        _id = id;
+        _measure_ms = measure_ms;
+        _fail = false;
+    }
+    String getSensorLocation(void) override {return String(F("Pin")) + String(_powerPin);}
+    bool wake(void) override
+    {
+        addEvent('P', _id);
+        return Sensor::wake();
+    }
+    bool startMeasurement(void) override
+    {
+        addEvent('S', _id);
+        return Sensor::startMeasurement();
+    }
+    bool isMeasurementReady(void) override
+    {
+        return millis() - _millisMeasurementRequested >= _measure_ms;
+    }
+    bool update(void) override
+    {
+        addEvent('C', _id);
+        sensorValues[0] = _id;
+        notifyVariables();
+        return !_fail;
+    }
+    void setFail(bool fail){_fail = fail;}
+
+private:
+    char _id;
+    uint32_t _measure_ms;
+    bool _fail;
+};
+
+static void startCycle(void)
+{
+    numEvents = 0;
+    HostShim::advanceMillis(60000);
+}
+
+// The sensors, listed slowest first: A is ready after 1000 ms, B after 100 ms
+// and C after 500 ms (300 warming up + 200 stabilizing)
+ScheduleSensor sensorA('A', 20, 1000, 0, 50);
+ScheduleSensor sensorB('B', 21, 100, 0, 50);
+ScheduleSensor sensorC('C', 22, 300, 200, 50);
+
+static void testEarliestReadyFirst(void)
+{
+    Variable *variableList[] = {
+        new Variable(&sensorA, 0, "A"),
+        new Variable(&sensorB, 0, "B"),
+        new Variable(&sensorC, 0, "C")
+    };
+    VariableArray array;
+    array.init(3, variableList);
+    array.setupSensors();
+    CHECK_EQUAL(3, array.getSensorCount());
+    CHECK_EQUAL(1000, array.planCycleTime());
+
+    startCycle();
+    uint32_t start = HostShim::getMicros()/1000;
+    CHECK(array.updateAllSensorsScheduled());
+    array.sensorsSleep();
+
+    // Everything is powered at once and collected in the order it is ready
+    CHECK_STRING("BCA", collectOrder());
+    CHECK_EQUAL(start, eventTime('P', 'A'));
+    CHECK_EQUAL(start, eventTime('P', 'C'));
+    CHECK_CLOSE(start + 100, eventTime('S', 'B'), 2);
+    // C is started once warmed up, before it has stabilized
+    CHECK_CLOSE(start + 300, eventTime('S', 'C'), 2);
+    CHECK_CLOSE(start + 1000, eventTime('S', 'A'), 2);
+    CHECK_EQUAL(1000, array.getPlannedCycleTime());
+    CHECK_CLOSE(1050, array.getLastCycleTime(), 5);
+}
+
+static void testStaggeredWake(void)
+{
+    Variable *variableList[] = {
+        new Variable(&sensorA, 0, "A"),
+        new Variable(&sensorB, 0, "B"),
+        new Variable(&sensorC, 0, "C")
+    };
+    VariableArray array;
+    array.init(3, variableList);
+    array.setupSensors();
+    array.setStaggeredWake(true);
+
+    startCycle();
+    uint32_t start = HostShim::getMicros()/1000;
+    CHECK(array.updateAllSensorsScheduled());
+    array.sensorsSleep();
+
+    // The quicker sensors are powered later so all are ready at 1000 ms
+    CHECK_CLOSE(start, eventTime('P', 'A'), 2);
+    CHECK_CLOSE(start + 900, eventTime('P', 'B'), 2);
+    CHECK_CLOSE(start + 500, eventTime('P', 'C'), 2);
+    CHECK_CLOSE(start + 1000, eventTime('S', 'A'), 2);
+    CHECK_CLOSE(start + 1000, eventTime('S', 'B'), 2);
+    CHECK_CLOSE(start + 800, eventTime('S', 'C'), 2);
+    // Each sensor was on only as long as it needed
+    CHECK_CLOSE(150, sensorB.getLastPoweredTime(), 5);
+    CHECK_CLOSE(550, sensorC.getLastPoweredTime(), 5);
+    // C can be started once warm, so it finishes first; A and B tie and
+    // keep their list order
+    CHECK_STRING("CAB", collectOrder());
+    CHECK_CLOSE(1050, array.getLastCycleTime(), 5);
+}
+
+static void testWarmUpWaitIsCounted(void)
+{
+    Variable *variableList[] = {
+        new Variable(&sensorA, 0, "A"),
+        new Variable(&sensorB, 0, "B"),
+        new Variable(&sensorC, 0, "C")
+    };
+    VariableArray array;
+    array.init(3, variableList);
+    array.setupSensors();
+
+    // Each sensor waits from power-on until it is warm enough to start
+    uint32_t waitA = sensorA.getWarmUpWaitTime();
+    uint32_t waitB = sensorB.getWarmUpWaitTime();
+    uint32_t waitC = sensorC.getWarmUpWaitTime();
+    startCycle();
+    CHECK(array.updateAllSensorsScheduled());
+    array.sensorsSleep();
+    CHECK_CLOSE(1000, sensorA.getWarmUpWaitTime() - waitA, 2);
+    CHECK_CLOSE(100, sensorB.getWarmUpWaitTime() - waitB, 2);
+    CHECK_CLOSE(300, sensorC.getWarmUpWaitTime() - waitC, 2);
+
+    // Sensors that were powered before the update only count the wait
+    // during it
+    waitA = sensorA.getWarmUpWaitTime();
+    waitB = sensorB.getWarmUpWaitTime();
+    waitC = sensorC.getWarmUpWaitTime();
+    startCycle();
+    array.sensorsWake();
+    delay(200);
+    CHECK(array.updateAllSensorsOverlapped());
+    array.sensorsSleep();
+    CHECK_CLOSE(800, sensorA.getWarmUpWaitTime() - waitA, 2);
+    CHECK_CLOSE(0, sensorB.getWarmUpWaitTime() - waitB, 2);
+    CHECK_CLOSE(100, sensorC.getWarmUpWaitTime() - waitC, 2);
+}
+
+static void testSensorListAndFailures(void)
+{
+    // B has two variables, one before and one after C's, so it is listed
+    // once, at its last variable
+    Variable *variableList[] = {
+        new Variable(&sensorB, 0, "B1"),
+        new Variable(&sensorC, 0, "C"),
+        new Variable(&sensorB, 0, "B2"),
+        new Variable(&sensorA, 0, "A")
+    };
+    VariableArray array;
+    array.init(4, variableList);
+    array.setupSensors();
+    CHECK_EQUAL(3, array.getSensorCount());
+
+    // The sensors are updated one at a time in list order
+    startCycle();
+    array.sensorsWake();
+    CHECK(array.updateAllSensors());
+    array.sensorsSleep();
+    CHECK_STRING("CBA", collectOrder());
+
+    // A failure of any sensor is reported, not just the last
+    sensorC.setFail(true);
+    startCycle();
+    array.sensorsWake();
+    CHECK(!array.updateAllSensors());
+    array.sensorsSleep();
+    startCycle();
+    CHECK(!array.updateAllSensorsScheduled());
+    array.sensorsSleep();
+    sensorC.setFail(false);
+}
+
+int main(void)
+{
+    testEarliestReadyFirst();
+    testStaggeredWake();
+    testWarmUpWaitIsCounted();
+    testSensorListAndFailures();
+    return TEST_RESULT();
+}
@@ -0,0 +1,459 @@
+/*
+ *simulator.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This is a program to run on a computer (NOT on the logger) that runs a whole
+ *EnviroDIY station in virtual time against extras/host_shim for days or weeks
+ *at a time, to see how the logging interval, staggered sensor wake, SD card
+ *flush settings and batch size change how long the logger is awake, how
+ *often it writes the card and uses the modem, and how much charge it uses.
+ *
+ *The library's own LoggerEnviroDIY::log() runs the station; nothing here
+ *works the numbers out from one sample.  The sensors are models that take as
+ *long as the real ones to warm up, stabilize and measure, the modem and
+ *portal are the host build's stand-ins, and the portal can be made to fail
+ *posts or the network to go down, so the queued records are retried the way
+ *they would be in the field.
+ *
+ *To use it (all options are optional):
+ *  ModularSensorsSimulator --days=14 --interval=5 --batch=6 --fail-percent=5
+ *The results for each day are printed as csv, with a line for the total and
+ *one for the average day.  Lines starting with # describe the settings.
+ *The first day has a few more readings than the rest.  The logger is still
+ *starting up at midnight, so it misses that reading, and it then takes its
+ *first 10 readings every 2 minutes as well as on the interval.  At 5 minutes
+ *that makes 294 readings: 287 on the interval, plus 7 at 2, 4, 6, 8, 12, 14
+ *and 16 minutes past midnight.
+ *
+ *With --check=1, it also checks that every day had the readings it should
+ *have and that the modem, the SD card and the portal were all used each
+ *day, and returns 1 if not.
+*/
+
+#define TINY_GSM_MODEM_SIM800
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <HostShim.h>
+#include <LoggerEnviroDIY.h>
+#include <ProcessorMetadata.h>
+#include <MaximDS3231.h>
+// These are only for the warm up, stabilization and measurement times and
+// the currents
+#include <DecagonCTD.h>
+#include <CampbellOBS3.h>
+#include <MaximDS18.h>
+#include <YosemitechY504.h>
+
+// The settings, with their defaults
+struct SimulatorOptions
+{
+    long days;
+    float interval;  // Logging interval in minutes
+    long batch;  // Readings per connection to the portal
+    long recordsPerFlush;
+    long flushMinutes;  // Longest time between SD card writes, 0 for none
+    long stagger;  // 1 to stagger sensor wake
+    long failPercent;  // Percent of posts the portal answers with an error
+    long outageHours;  // Hours at the start of each day with no network
+    long seed;
+    long check;  // 1 to check the readings and use of the modem and card
+    // The currents not known to the library, in mA.  These are assumptions
+    // for an EnviroDIY Mayfly with a SIM800 and should be set for the board
+    // being planned for.
+    float awake_mA;  // The board while awake, without the sensors or modem
+    float sleep_mA;  // The board while asleep
+    float modem_mA;  // The average of the modem while it is on
+};
+
+static SimulatorOptions options = {7, 5, 1, 1, 0, 1, 0, 0, 1, 0, 8.0, 0.25, 100.0};
+
+// Each option is given as --name=value
+static bool parseOption(const char *arg)
+{
+    const char *equals = strchr(arg, '=');
+    if (strncmp(arg, "--", 2) != 0 || equals == NULL) return false;
+    String name = String(arg + 2).substring(0, equals - arg - 2);
+    const char *value = equals + 1;
+    if (name == "days") options.days = atol(value);
+    else if (name == "interval") options.interval = atof(value);
+    else if (name == "batch") options.batch = atol(value);
+    else if (name == "records-per-flush") options.recordsPerFlush = atol(value);
+    else if (name == "flush-minutes") options.flushMinutes = atol(value);
+    else if (name == "stagger") options.stagger = atol(value);
+    else if (name == "fail-percent") options.failPercent = atol(value);
+    else if (name == "outage-hours") options.outageHours = atol(value);
+    else if (name == "seed") options.seed = atol(value);
+    else if (name == "check") options.check = atol(value);
+    else if (name == "awake-mA") options.awake_mA = atof(value);
+    else if (name == "sleep-mA") options.sleep_mA = atof(value);
+    else if (name == "modem-mA") options.modem_mA = atof(value);
+    else return false;
+    return true;
+}
+
+
+// ==========================================================================
+//    A sensor that only takes time and uses power
+// ==========================================================================
+// The first reading cannot finish until the sensor has been powered for its
+// warm up and stabilization times; each reading then takes the measurement
+// time.  If more than one reading is averaged, they are taken one after
+// another, the way the SDI-12 and Modbus sensors do.
+class ModelSensor : public Sensor
+{
+public:
+    ModelSensor(const char *name, int powerPin, int numReturnedVars,
+                uint32_t warmUp_ms, uint32_t stabilization_ms,
+                uint32_t measurement_ms, uint8_t readingsToAverage, float current_mA)
+      : Sensor(powerPin, -1, name, numReturnedVars, warmUp_ms, stabilization_ms)
+    {
+        _measurement_ms = measurement_ms;
+        _readingsToAverage = readingsToAverage;
+        _readingsTaken = 0;
+        _numMeasurements = 0;
+        setPowerDraw(current_mA);
+    }
+
+    virtual String getSensorLocation(void) override {return String(F("Pin")) + _powerPin;}
+
+    virtual bool startMeasurement(void) override
+    {
+        _readingsTaken = 0;
+        return Sensor::startMeasurement();
+    }
+
+    virtual bool isMeasurementReady(void) override
+    {
+        uint32_t now = millis();
+        if (now - _millisPowerOn < _WarmUpTime_ms + _StabilizationTime_ms + _measurement_ms)
+            return false;
+        return (now - _millisMeasurementRequested >= _measurement_ms);
+    }
+
+    virtual SENSOR_STATUS collectMeasurement(void) override
+    {
+        _readingsTaken++;
+        if (_readingsTaken < _readingsToAverage)
+        {
+            _millisMeasurementRequested = millis();
+            return SENSOR_WAITING;
+        }
+        _millisMeasurementRequested = 0;
+        for (int i = 0; i < _numReturnedVars; i++) sensorValues[i] = 10*i + 1;
+        _numMeasurements++;
+        notifyVariables();
+        return SENSOR_READY;
+    }
+
+    // The whole measurement, for when the sensors are not scheduled
+    virtual bool update(void) override
+    {
+        bool wasOn = checkPowerOn();
+        if(!wasOn){powerUp();}
+        waitForWarmUp();
+        bool success = runMeasurement();
+        if(!wasOn){powerDown();}
+        return success;
+    }
+
+    uint32_t getMeasurementTime(void){return _measurement_ms;}
+    uint32_t getNumMeasurements(void){return _numMeasurements;}
+
+private:
+    uint32_t _measurement_ms;
+    uint8_t _readingsToAverage;
+    uint8_t _readingsTaken;
+    uint32_t _numMeasurements;
+};
+
+// A variable of a model sensor
+class ModelVariable : public Variable
+{
+public:
+    ModelVariable(Sensor *parentSense, int varNum, const char *varCode)
+      : Variable(parentSense, varNum, F("modelled"), F("unknown"), 2, varCode)
+    {}
+};
+
+
+// ==========================================================================
+//    The station: a DRWI citizen science station with a DS18 and a Y504
+// ==========================================================================
+// Each kind of sensor has its own switched power pin, so staggered wake can
+// keep the ones with short warm ups off; the two OBS3's share one.
+#define CTD_POWER 22
+#define OBS3_POWER 5
+#define DS18_POWER 4
+#define Y504_POWER 6
+// The modem's DTR pin, which is high while the modem is on
+#define MODEM_ON_PIN 23
+
+// The currents are the drivers' datasheet values; the measurement times not
+// given by the drivers are typical values for each sensor
+ModelSensor ctd("DecagonCTD", CTD_POWER, 3, CTD_WARM_UP, 0, 1000, 6, CTD_POWER_DRAW);
+ModelSensor obs3low("CampbellOBS3", OBS3_POWER, 1, OBS3_WARM_UP, 0, 100, 1, OBS3_POWER_DRAW);
+ModelSensor obs3high("CampbellOBS3", OBS3_POWER, 1, OBS3_WARM_UP, 0, 100, 1, OBS3_POWER_DRAW);
+ModelSensor ds18("MaximDS18", DS18_POWER, 1, DS18_WARM_UP, 0, DS18_MEASUREMENT_TIME, 1, DS18_POWER_DRAW);
+ModelSensor y504("YosemitechY504", Y504_POWER, 2, Y504_WARM_UP, Y504_STABILIZATION, 1500, 1, YOSEMITECH_POWER_DRAW);
+ModelSensor *modelSensors[] = {&ctd, &obs3low, &obs3high, &ds18, &y504};
+#define NUM_MODEL_SENSORS (sizeof(modelSensors)/sizeof(modelSensors[0]))
+
+ProcessorMetadata mayfly("v0.5");
+MaximDS3231 ds3231(1);
+Variable *variableList[] = {
+    new ProcessorMetadata_Batt(&mayfly),
+    new MaximDS3231_Temp(&ds3231),
+    new ModelVariable(&ctd, 0, "CTDcond"),
+    new ModelVariable(&ctd, 1, "CTDtemp"),
+    new ModelVariable(&ctd, 2, "CTDdepth"),
+    new ModelVariable(&obs3low, 0, "TurbLow"),
+    new ModelVariable(&obs3high, 0, "TurbHigh"),
+    new ModelVariable(&ds18, 0, "DS18temp"),
+    new ModelVariable(&y504, 0, "Y504DOpct"),
+    new ModelVariable(&y504, 1, "Y504DOmgL"),
+};
+int variableCount = sizeof(variableList) / sizeof(variableList[0]);
+const char *UUIDs[] = {
+    "12345678-abcd-1234-efgh-1234567890ab", "12345678-abcd-1234-efgh-1234567890ab",
+    "12345678-abcd-1234-efgh-1234567890ab", "12345678-abcd-1234-efgh-1234567890ab",
+    "12345678-abcd-1234-efgh-1234567890ab", "12345678-abcd-1234-efgh-1234567890ab",
+    "12345678-abcd-1234-efgh-1234567890ab", "12345678-abcd-1234-efgh-1234567890ab",
+    "12345678-abcd-1234-efgh-1234567890ab", "12345678-abcd-1234-efgh-1234567890ab",
+};
+LoggerEnviroDIY logger;
+
+
+// ==========================================================================
+//    The modem and portal
+// ==========================================================================
+static uint32_t numPosts = 0;
+static uint32_t numFailedPosts = 0;
+
+// The portal answers each post, failing the given percent of them
+static String portalResponder(const String &host, uint16_t port, const String &request)
+{
+    if (host != "data.envirodiy.org")
+        return TinyGsm::createdResponse(host, port, request);
+    numPosts++;
+    if (random(100) < options.failPercent)
+    {
+        numFailedPosts++;
+        return "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n";
+    }
+    return "HTTP/1.1 201 Created\r\nContent-Length: 0\r\n\r\n";
+}
+
+// The modem's on time, from its DTR pin
+static uint64_t modemOnMicros = 0;
+static uint64_t modemOnSince = 0;
+static bool modemOn = false;
+
+static void pinListener(uint8_t pin, uint8_t level)
+{
+    if (pin != MODEM_ON_PIN) return;
+    if (level == HIGH && !modemOn) modemOnSince = HostShim::getMicros();
+    if (level == LOW && modemOn) modemOnMicros += HostShim::getMicros() - modemOnSince;
+    modemOn = (level == HIGH);
+}
+
+
+// ==========================================================================
+//    The results
+// ==========================================================================
+// The running totals, so each day is the difference between two of these
+struct SimulatorTotals
+{
+    uint64_t micros;
+    uint64_t sleepMicros;
+    uint64_t modemMicros;
+    uint32_t readings;
+    uint32_t syncs;
+    uint32_t bytesWritten;
+    uint32_t posts;
+    uint32_t failedPosts;
+    uint32_t connects;
+    float sensor_mAh;
+};
+
+static SimulatorTotals getTotals(void)
+{
+    SimulatorTotals totals;
+    totals.micros = HostShim::getMicros();
+    totals.sleepMicros = HostShim::getSleepMicros();
+    totals.modemMicros = modemOnMicros;
+    if (modemOn) totals.modemMicros += totals.micros - modemOnSince;
+    totals.readings = ctd.getNumMeasurements();
+    totals.syncs = SdFat::getStats().syncs;
+    totals.bytesWritten = SdFat::getStats().bytesWritten;
+    totals.posts = numPosts;
+    totals.failedPosts = numFailedPosts;
+    totals.connects = TinyGsm::getStats().connects;
+    totals.sensor_mAh = 0;
+    for (size_t i = 0; i < NUM_MODEL_SENSORS; i++)
+        totals.sensor_mAh += modelSensors[i]->getChargeUsed();
+    return totals;
+}
+
+// This prints one line of results for the time between two totals, divided
+// by the given number of days
+static void printResults(const char *day, const SimulatorTotals &start,
+                         const SimulatorTotals &end, float numDays)
+{
+    float total_s = (end.micros - start.micros) / 1e6;
+    float asleep_s = (end.sleepMicros - start.sleepMicros) / 1e6;
+    float awake_s = total_s - asleep_s;
+    float modem_s = (end.modemMicros - start.modemMicros) / 1e6;
+    float sensor_mAh = end.sensor_mAh - start.sensor_mAh;
+    float board_mAh = (awake_s*options.awake_mA + asleep_s*options.sleep_mA) / 3600;
+    float modem_mAh = modem_s*options.modem_mA / 3600;
+    printf("%s,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%lu,%.2f,%.2f,%.2f,%.2f\n",
+           day, (end.readings - start.readings) / numDays, awake_s / numDays,
+           modem_s / numDays, (end.syncs - start.syncs) / numDays,
+           (end.bytesWritten - start.bytesWritten) / numDays,
+           (end.posts - start.posts) / numDays,
+           (end.failedPosts - start.failedPosts) / numDays,
+           (end.connects - start.connects) / numDays,
+           (unsigned long)logger.getQueuedBytes(), sensor_mAh / numDays,
+           board_mAh / numDays, modem_mAh / numDays,
+           (sensor_mAh + board_mAh + modem_mAh) / numDays);
+}
+
+// The first minute, in seconds from midnight, at which the logger checks
+// whether to take a reading, once it has started up
+static uint32_t firstCheck_s;
+
+// This returns the number of readings that should be taken on the given day.
+// On the first day, the logger's first 10 readings are taken every 2 minutes
+// as well as on the interval, starting from the first check.
+static uint32_t expectedReadings(long day)
+{
+    uint32_t interval_s = options.interval*60;
+    if (day > 1) return 86400/interval_s;
+    uint32_t readings = 0;
+    for (uint32_t t = firstCheck_s; t < 86400; t += 60)
+    {
+        if (t % interval_s == 0 || (readings < 10 && t % 120 == 0)) readings++;
+    }
+    return readings;
+}
+
+// This returns the number of problems with one day's results
+static int checkDay(long day, const SimulatorTotals &start, const SimulatorTotals &end)
+{
+    int problems = 0;
+    uint32_t readings = end.readings - start.readings;
+    if (readings != expectedReadings(day))
+    {
+        fprintf(stderr, "Day %ld: %lu readings, not %lu\n", day,
+                (unsigned long)readings, (unsigned long)expectedReadings(day));
+        problems++;
+    }
+    if (end.modemMicros == start.modemMicros)
+    {
+        fprintf(stderr, "Day %ld: the modem was never on\n", day);
+        problems++;
+    }
+    if (end.syncs == start.syncs)
+    {
+        fprintf(stderr, "Day %ld: the SD card was never written\n", day);
+        problems++;
+    }
+    if (end.connects == start.connects)
+    {
+        fprintf(stderr, "Day %ld: the portal was never connected to\n", day);
+        problems++;
+    }
+    return problems;
+}
+
+static void printSettings(void)
+{
+    printf("# Logging every %g minutes for %ld days\n", options.interval, options.days);
+    printf("# Staggered sensor wake: %s\n", options.stagger ? "on" : "off");
+    printf("# SD card written every %ld records", options.recordsPerFlush);
+    if (options.flushMinutes > 0) printf(" or %ld minutes", options.flushMinutes);
+    printf("\n# %ld readings per batch sent to the portal\n", options.batch);
+    printf("# %ld%% of posts fail; no network for the first %ld hours of each day\n",
+           options.failPercent, options.outageHours);
+    printf("# Assumed currents (mA): board awake %g, board asleep %g, modem on %g\n",
+           options.awake_mA, options.sleep_mA, options.modem_mA);
+    for (size_t i = 0; i < NUM_MODEL_SENSORS; i++)
+    {
+        ModelSensor *s = modelSensors[i];
+        printf("# %s at %s: warm up %lu ms, stabilization %lu ms, "
+               "measurement %lu ms, %g mA\n",
+               s->getSensorName().c_str(), s->getSensorLocation().c_str(),
+               (unsigned long)s->getWarmUpTime(), (unsigned long)s->getStabilizationTime(),
+               (unsigned long)s->getMeasurementTime(), s->getPowerDraw());
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (!parseOption(argv[i]))
+        {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    randomSeed(options.seed);
+
+    // Keep the logger's own printing off the screen
+    Serial.setEcho(NULL);
+    SdFat::setRoot("simulator_card");
+    remove(SdFat::getPath(ENVIRODIY_QUEUE_FILE).c_str());
+    remove(SdFat::getPath(ENVIRODIY_CURSOR_FILE).c_str());
+    HostShim::linkPin(19, MODEM_ON_PIN);
+    HostShim::setPinListener(pinListener);
+    TinyGsm::setResponder(portalResponder);
+
+    logger.init(12, A7, variableCount, variableList, options.interval, "Simulated");
+    logger.setToken("12345678-abcd-1234-efgh-1234567890ab");
+    logger.setSamplingFeature("12345678-abcd-1234-efgh-1234567890ab");
+    logger.setUUIDs(UUIDs);
+    logger.setStaggeredWake(options.stagger != 0);
+    logger.setSDFlushPolicy(options.recordsPerFlush, options.flushMinutes);
+    logger.setBatchSize(options.batch);
+    logger.modem.setupModem(&Serial1, 18, 19, MODEM_ON_PIN, held, "apn");
+    logger.begin();
+    firstCheck_s = (HostShim::getMicros() + 59999999ULL)/60000000ULL*60;
+
+    printSettings();
+    printf("Day,Readings,Awake_s,Modem_on_s,SD_syncs,SD_bytes,Posts,Failed_posts,"
+           "Connects,Queued_bytes,Sensor_mAh,Board_mAh,Modem_mAh,Total_mAh\n");
+
+    // The virtual clock starts at midnight
+    uint64_t dayMicros = 86400000000ULL;
+    uint64_t nextDay = 0;
+    SimulatorTotals first = getTotals();
+    SimulatorTotals dayStart = first;
+    int problems = 0;
+    for (long day = 1; day <= options.days; day++)
+    {
+        nextDay += dayMicros;
+        while (HostShim::getMicros() < nextDay)
+        {
+            // The network is down for the first hours of each day
+            uint64_t hour = (HostShim::getMicros() % dayMicros) / 3600000000ULL;
+            TinyGsm::setNetworkAvailable(hour >= (uint64_t)options.outageHours);
+            logger.log();
+            Serial.clearSent();
+            Serial1.clearSent();
+        }
+        SimulatorTotals dayEnd = getTotals();
+        char dayName[24];
+        snprintf(dayName, sizeof(dayName), "%ld", day);
+        printResults(dayName, dayStart, dayEnd, 1);
+        if (options.check) problems += checkDay(day, dayStart, dayEnd);
+        dayStart = dayEnd;
+    }
+    printResults("Total", first, dayStart, 1);
+    printResults("Average", first, dayStart, options.days);
+    return problems > 0 ? 1 : 0;
+}
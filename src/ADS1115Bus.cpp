@@ -0,0 +1,196 @@
+/*
+ *ADS1115Bus.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for a TI ADS1115 analog to digital converter shared by all of
+ *the analog sensors attached to it.
+*/
+
+#include "ADS1115Bus.h"
+
+// The converter's registers
+#define ADS1115_REG_CONVERSION 0x00
+#define ADS1115_REG_CONFIG 0x01
+#define ADS1115_REG_LO_THRESH 0x02
+#define ADS1115_REG_HI_THRESH 0x03
+
+// The parts of the config register
+#define ADS1115_OS_SINGLE 0x8000  // Start a single conversion / conversion done
+#define ADS1115_MUX_SINGLE_0 0x4000  // AIN0 to ground; the next 3 channels follow
+#define ADS1115_PGA_SHIFT 9
+#define ADS1115_MODE_SINGLE 0x0100
+#define ADS1115_DR_SHIFT 5
+#define ADS1115_COMP_ASSERT_1 0x0000  // Use ALERT/RDY after one conversion
+#define ADS1115_COMP_DISABLE 0x0003
+
+// The volts per bit at each gain, in µV
+static const float ADS1115_LSB_UV[] = {187.5, 125.0, 62.5, 31.25, 15.625, 7.8125};
+// The samples per second at each data rate
+static const uint16_t ADS1115_SPS[] = {8, 16, 32, 64, 128, 250, 475, 860};
+
+// The list of converters
+ADS1115Bus *ADS1115Bus::_firstBus = NULL;
+
+
+ADS1115Bus::ADS1115Bus(uint8_t i2cAddress)
+{
+    _i2cAddress = i2cAddress;
+    _readyPin = -1;
+    _channelsUsed = 0;
+    for (uint8_t i = 0; i < ADS1115_NUM_CHANNELS; i++)
+    {
+        _gain[i] = ADS1115_GAIN_6_144V;
+        _rate[i] = ADS1115_RATE_128SPS;
+        _voltage[i] = -9999;
+        _millisRead[i] = 0;
+    }
+    _nextBus = NULL;
+}
+
+
+// Find the converter at the address, or create one for the first sensor on it
+ADS1115Bus *ADS1115Bus::getBus(uint8_t i2cAddress)
+{
+    for (ADS1115Bus *bus = _firstBus; bus != NULL; bus = bus->_nextBus)
+    {
+        if (bus->_i2cAddress == i2cAddress) return bus;
+    }
+    ADS1115Bus *bus = new ADS1115Bus(i2cAddress);
+    bus->_nextBus = _firstBus;
+    _firstBus = bus;
+    Wire.begin();
+    return bus;
+}
+
+
+void ADS1115Bus::setChannel(uint8_t channel, ADS1115_GAIN gain, ADS1115_RATE rate)
+{
+    if (channel >= ADS1115_NUM_CHANNELS) return;
+    _gain[channel] = gain;
+    _rate[channel] = rate;
+    _channelsUsed |= (1 << channel);
+    _millisRead[channel] = 0;
+}
+
+void ADS1115Bus::addChannel(uint8_t channel)
+{
+    if (channel >= ADS1115_NUM_CHANNELS) return;
+    _channelsUsed |= (1 << channel);
+}
+
+
+// Set the thresholds so the ALERT/RDY pin goes low when a conversion is done
+void ADS1115Bus::setReadyPin(int readyPin)
+{
+    _readyPin = readyPin;
+    if (_readyPin < 0) return;
+    pinMode(_readyPin, INPUT_PULLUP);
+    writeRegister(ADS1115_REG_HI_THRESH, 0x8000);
+    writeRegister(ADS1115_REG_LO_THRESH, 0x0000);
+}
+
+
+float ADS1115Bus::getVoltsPerBit(ADS1115_GAIN gain)
+{
+    return ADS1115_LSB_UV[gain] / 1000000.0;
+}
+
+
+// Use the last reading if it is recent enough, otherwise read everything
+float ADS1115Bus::getVoltage(uint8_t channel, uint32_t notBefore)
+{
+    if (channel >= ADS1115_NUM_CHANNELS) return -9999;
+    addChannel(channel);
+
+    uint32_t readAt = _millisRead[channel];
+    if (readAt == 0 || (int32_t)(readAt - notBefore) < 0
+        || millis() - readAt > ADS1115_SHARED_MS)
+    {
+        readAllChannels();
+    }
+    else DBGM(F("Using ADS1115 channel "), channel, F(" read with the other channels\n"));
+    return _voltage[channel];
+}
+
+
+bool ADS1115Bus::readAllChannels(void)
+{
+    bool success = true;
+    for (uint8_t i = 0; i < ADS1115_NUM_CHANNELS; i++)
+    {
+        if (_channelsUsed & (1 << i)) success &= readChannel(i);
+    }
+    return success;
+}
+
+
+// Run a single conversion on one channel and wait for it to finish
+bool ADS1115Bus::readChannel(uint8_t channel)
+{
+    uint16_t config = ADS1115_OS_SINGLE
+                    | (ADS1115_MUX_SINGLE_0 + (channel << 12))
+                    | (_gain[channel] << ADS1115_PGA_SHIFT)
+                    | ADS1115_MODE_SINGLE
+                    | (_rate[channel] << ADS1115_DR_SHIFT)
+                    | (_readyPin >= 0 ? ADS1115_COMP_ASSERT_1 : ADS1115_COMP_DISABLE);
+
+    _voltage[channel] = -9999;
+    _millisRead[channel] = 0;
+    if (!writeRegister(ADS1115_REG_CONFIG, config))
+    {
+        DBGM(F("ADS1115 at 0x"), String(_i2cAddress, HEX), F(" did not answer\n"));
+        return false;
+    }
+
+    // Wait out half of the conversion before checking on it
+    uint32_t start = millis();
+    delay(500 / ADS1115_SPS[_rate[channel]]);
+    bool finished = false;
+    while (!finished && millis() - start < ADS1115_CONVERSION_TIMEOUT)
+    {
+        if (_readyPin >= 0) finished = (digitalRead(_readyPin) == LOW);
+        else
+        {
+            uint16_t status = 0;
+            finished = readRegister(ADS1115_REG_CONFIG, &status)
+                       && (status & ADS1115_OS_SINGLE);
+        }
+    }
+
+    int16_t adcResult = 0;
+    if (!finished || !readRegister(ADS1115_REG_CONVERSION, (uint16_t *)&adcResult))
+    {
+        DBGM(F("ADS1115 channel "), channel, F(" did not finish converting\n"));
+        return false;
+    }
+
+    _voltage[channel] = adcResult * getVoltsPerBit(_gain[channel]);
+    _millisRead[channel] = millis();
+    DBGM(F("ADS1115 channel "), channel, F(": "), adcResult, F(" = "),
+         String(_voltage[channel], 6), F(" V\n"));
+    return true;
+}
+
+
+bool ADS1115Bus::writeRegister(uint8_t reg, uint16_t value)
+{
+    Wire.beginTransmission(_i2cAddress);
+    Wire.write(reg);
+    Wire.write((uint8_t)(value >> 8));
+    Wire.write((uint8_t)(value & 0xFF));
+    return Wire.endTransmission() == 0;
+}
+
+bool ADS1115Bus::readRegister(uint8_t reg, uint16_t *value)
+{
+    Wire.beginTransmission(_i2cAddress);
+    Wire.write(reg);
+    if (Wire.endTransmission() != 0) return false;
+    if (Wire.requestFrom(_i2cAddress, (uint8_t)2) != 2) return false;
+    uint8_t highByte = Wire.read();
+    uint8_t lowByte = Wire.read();
+    *value = ((uint16_t)highByte << 8) | lowByte;
+    return true;
+}
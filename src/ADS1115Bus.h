@@ -0,0 +1,107 @@
+/*
+ *ADS1115Bus.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for a TI ADS1115 analog to digital converter shared by all of
+ *the analog sensors attached to it.  There is one of these for each I2C
+ *address.  Every channel in use is read in one pass, each with its own gain
+ *(PGA) and data rate, and the results are kept so the other sensors on the
+ *same converter do not need to visit it again.  The volts per bit come from the
+ *gain setting, instead of being worked out in each sensor.
+ *
+ *Documentation for the ADS1115 registers can be found at:
+ * http://www.ti.com/lit/ds/symlink/ads1115.pdf
+*/
+
+#ifndef ADS1115Bus_h
+#define ADS1115Bus_h
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// #define MODULES_DBG Serial
+#include "ModSensorDebugger.h"
+
+#define ADS1115_NUM_CHANNELS 4
+// How long readings are used by the other sensors on the converter instead of
+// reading again
+#define ADS1115_SHARED_MS 5000L
+// The longest to wait for one conversion; the slowest data rate takes 125ms
+#define ADS1115_CONVERSION_TIMEOUT 200L
+
+// The full scale ranges of the programmable gain amplifier
+typedef enum ADS1115_GAIN
+{
+    ADS1115_GAIN_6_144V = 0,  // 187.5 µV per bit; the power-on default
+    ADS1115_GAIN_4_096V,      // 125 µV per bit
+    ADS1115_GAIN_2_048V,      // 62.5 µV per bit
+    ADS1115_GAIN_1_024V,      // 31.25 µV per bit
+    ADS1115_GAIN_0_512V,      // 15.625 µV per bit
+    ADS1115_GAIN_0_256V       // 7.8125 µV per bit
+} ADS1115_GAIN;
+
+// The data rates, in samples per second
+typedef enum ADS1115_RATE
+{
+    ADS1115_RATE_8SPS = 0,
+    ADS1115_RATE_16SPS,
+    ADS1115_RATE_32SPS,
+    ADS1115_RATE_64SPS,
+    ADS1115_RATE_128SPS,      // the power-on default
+    ADS1115_RATE_250SPS,
+    ADS1115_RATE_475SPS,
+    ADS1115_RATE_860SPS
+} ADS1115_RATE;
+
+class ADS1115Bus
+{
+public:
+    // This returns the converter at the given I2C address, creating it the
+    // first time
+    static ADS1115Bus *getBus(uint8_t i2cAddress);
+
+    // This sets the gain and data rate used for a single-ended channel (0-3)
+    // and adds it to the channels read together
+    void setChannel(uint8_t channel, ADS1115_GAIN gain = ADS1115_GAIN_6_144V,
+                    ADS1115_RATE rate = ADS1115_RATE_128SPS);
+    // This adds a channel with the default settings, unless it has already
+    // been set up
+    void addChannel(uint8_t channel);
+
+    // This sets a pin attached to the converter's ALERT/RDY output, which is
+    // then used to tell when each conversion is done instead of asking over I2C
+    void setReadyPin(int readyPin);
+
+    // This returns the voltage on a channel.  The last reading is used if it
+    // was taken after notBefore (ie, once the sensor was warmed up) and within
+    // the last few seconds; otherwise every channel is read again.  Returns
+    // -9999 if the converter does not answer.
+    float getVoltage(uint8_t channel, uint32_t notBefore = 0);
+
+    // This reads every channel in use, one after another
+    bool readAllChannels(void);
+
+    // This returns the volts per bit for a gain
+    static float getVoltsPerBit(ADS1115_GAIN gain);
+
+private:
+    ADS1115Bus(uint8_t i2cAddress);
+    bool readChannel(uint8_t channel);
+    bool writeRegister(uint8_t reg, uint16_t value);
+    bool readRegister(uint8_t reg, uint16_t *value);
+
+    uint8_t _i2cAddress;
+    int _readyPin;
+    uint8_t _channelsUsed;  // One bit per channel
+    ADS1115_GAIN _gain[ADS1115_NUM_CHANNELS];
+    ADS1115_RATE _rate[ADS1115_NUM_CHANNELS];
+    float _voltage[ADS1115_NUM_CHANNELS];
+    uint32_t _millisRead[ADS1115_NUM_CHANNELS];
+    ADS1115Bus *_nextBus;
+
+    static ADS1115Bus *_firstBus;
+};
+
+#endif
@@ -26,7 +26,9 @@
 // The constructor - because this is I2C, only need the power pin
 AOSongAM2315::AOSongAM2315(int powerPin)
 : Sensor(powerPin, -1, F("AOSongAM2315"), AM2315_NUM_MEASUREMENTS, AM2315_WARM_UP)
-{}
+{
+    _powerDraw_mA = AM2315_POWER_DRAW;
+}
 
 String AOSongAM2315::getSensorLocation(void){return F("I2C_0xB8");}
 
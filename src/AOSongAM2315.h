@@ -19,6 +19,7 @@
  *  Range is -40°C to +125°C
  *
  * Warm up/sampling time: 2sec
+ * Current while measuring: 10 mA at most
 */
 
 #ifndef AOSongAM2315_h
@@ -32,6 +33,7 @@
 
 #define AM2315_NUM_MEASUREMENTS 2
 #define AM2315_WARM_UP 2000
+#define AM2315_POWER_DRAW 10  // Most current while measuring in mA
 
 #define AM2315_HUMIDITY_RESOLUTION 1
 #define AM2315_HUMIDITY_VAR_NUM 0
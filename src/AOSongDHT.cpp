@@ -31,6 +31,7 @@ AOSongDHT::AOSongDHT(int powerPin, int dataPin, DHTtype type)
   dht_internal(dataPin, type)
 {
     _dhtType = type;
+    _powerDraw_mA = DHT_POWER_DRAW;
 }
 
 SENSOR_STATUS AOSongDHT::setup(void)
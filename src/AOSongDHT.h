@@ -42,6 +42,7 @@
 
 #define DHT_NUM_MEASUREMENTS 3
 #define DHT_WARM_UP 1700
+#define DHT_POWER_DRAW 1.5  // Current while measuring in mA
 
 #define DHT_HUMIDITY_RESOLUTION 1
 #define DHT_HUMIDITY_VAR_NUM 0
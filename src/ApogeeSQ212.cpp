@@ -6,7 +6,7 @@
  * Adapted from CampbellOBS3.h by Sara Damiano (sdamiano@stroudcenter.org)
 
  * This file is for the Apogee SQ-212 Quantum Light sensor
- * This is dependent on the Adafruit ADS1015 library.
+ * This reads the voltage through the shared ADS1115 converter (ADS1115Bus).
  *
  * Apogee SQ-212 Quantum Light sensor measures photosynthetically active radiation (PAR)
  and is typically defined as total radiation across a range of 400 to 700 nm.
@@ -24,13 +24,13 @@
 
 
 #include "ApogeeSQ212.h"
-#include <Adafruit_ADS1015.h>
 
 // The constructor - need the power pin and the data pin
 ApogeeSQ212::ApogeeSQ212(int powerPin, int dataPin, uint8_t i2cAddress)
   : Sensor(powerPin, dataPin, F("ApogeeSQ212"), SQ212_NUM_VARIABLES, SQ212_WARM_UP)
 {
     _i2cAddress = i2cAddress;
+    _powerDraw_mA = SQ212_POWER_DRAW;
 }
 
 
@@ -41,13 +41,14 @@ String ApogeeSQ212::getSensorLocation(void)
     return sensorLocation;
 }
 
-bool ApogeeSQ212::update(void)
+SENSOR_STATUS ApogeeSQ212::setup(void)
 {
+    ADS1115Bus::getBus(_i2cAddress)->addChannel(_dataPin);
+    return Sensor::setup();
+}
 
-    // Start the Auxillary ADD
-    Adafruit_ADS1115 ads(_i2cAddress);     /* Use this for the 16-bit version */
-    ads.begin();
-
+bool ApogeeSQ212::update(void)
+{
     // Check if the power is on, turn it on if not
     bool wasOn = checkPowerOn();
     if(!wasOn){powerUp();}
@@ -57,26 +58,17 @@ bool ApogeeSQ212::update(void)
     // Clear values before starting loop
     clearValues();
 
-    // Variables to store the results in
-    int16_t adcResult = 0;
-    float voltage = 0;
-    float calibResult = 0;
-
     // Read Analog to Digital Converter (ADC)
-    adcResult = ads.readADC_SingleEnded(_dataPin);  // Getting the reading
-    DBGM(F("ads.readADC_SingleEnded("), _dataPin, F("): "), ads.readADC_SingleEnded(_dataPin), F("\t\t"));
-
-    // Convert bits into volts
-    voltage = adcResult * 0.1875/1000;  // in units of V. See Adafruit_ADS1X15 library for AD conversion factors.
-    // Alternately could use:
-    // voltage = (adcResult * 3.3) / 17585.0;
-    // where 3.3V is the voltage of the Mayfly board and
-    // 17585 is the number of register bits for the ADS1115 at standard (2/3) gain
-    // 17585 ~ 17600 = 3.3V / 0.1875 mV/bit (17585 vs 17600 based on actually tests)
-
+    // The whole converter is read at once, so a reading taken along with
+    // another sensor since this one warmed up is used.  The converter turns
+    // the bits into volts using the channel's gain.
+    float voltage = ADS1115Bus::getBus(_i2cAddress)->getVoltage(_dataPin, _millisPowerOn + _WarmUpTime_ms);
     DBGM("Voltage: ", String(voltage, 6), F("\t\t"));
+
     // Apogee SQ-212 Calibration Factor = 1.0 μmol m-2 s-1 per mV;
-    calibResult = 1 * voltage * 1000 ;  // in units of μmol m-2 s-1 (microeinsteinPerSquareMeterPerSecond)
+    float calibResult = -9999;
+    if (voltage != -9999)
+        calibResult = 1 * voltage * 1000 ;  // in units of μmol m-2 s-1 (microeinsteinPerSquareMeterPerSecond)
     DBGM(F("calibResult: "), calibResult, F("\n"));
 
     sensorValues[SQ212_PAR_VAR_NUM] = calibResult;
@@ -88,5 +80,5 @@ bool ApogeeSQ212::update(void)
     notifyVariables();
 
     // Return true when finished
-    return true;
+    return (voltage != -9999);
 }
@@ -6,7 +6,7 @@
  * Adapted from CampbellOBS3.h by Sara Damiano (sdamiano@stroudcenter.org)
 
  * This file is for the Apogee SQ-212 Quantum Light sensor
- * This is dependent on the Adafruit ADS1015 library.
+ * This reads the voltage through the shared ADS1115 converter (ADS1115Bus).
  *
  * Apogee SQ-212 Quantum Light sensor measures photosynthetically active radiation (PAR)
  and is typically defined as total radiation across a range of 400 to 700 nm.
@@ -32,10 +32,13 @@
 // #define MODULES_DBG Serial
 #include "ModSensorDebugger.h"
 
+#include "ADS1115Bus.h"
+
 #define ADS1015_ADDRESS (0x48) // 1001 000 (ADDR = GND)
 
 #define SQ212_NUM_VARIABLES 1
 #define SQ212_WARM_UP 2     // Time in ms
+#define SQ212_POWER_DRAW 0.3  // Current in mA
 #define SQ212_PAR_VAR_NUM 0
 #define SQ212_PAR_RESOLUTION 2
 
@@ -48,6 +51,9 @@ public:
 
     String getSensorLocation(void) override;
 
+    // This adds the sensor's channel to the ones read on the converter
+    SENSOR_STATUS setup(void) override;
+
     bool update(void) override;
 
 protected:
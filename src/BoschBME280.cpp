@@ -35,6 +35,7 @@ BoschBME280::BoschBME280(int powerPin, uint8_t i2cAddressHex)
  : Sensor(powerPin, -1, F("BoschBME280"), BoschBME280_NUM_MEASUREMENTS, BoschBME280_WARM_UP)
 {
     _i2cAddressHex  = i2cAddressHex;
+    _powerDraw_mA = BoschBME280_POWER_DRAW;
 }
 
 String BoschBME280::getSensorLocation(void)
@@ -75,20 +76,34 @@ SENSOR_STATUS BoschBME280::setup(void)
 }
 
 bool BoschBME280::update(void)
+{
+    return runMeasurement();
+}
+
+bool BoschBME280::startMeasurement(void)
 {
     // Check if the power is on, turn it on if not
-    bool wasOn = checkPowerOn();
-    if(!wasOn){powerUp();}
-    // Wait until the sensor is warmed up
-    waitForWarmUp();
+    if(!checkPowerOn()){powerUp();}
+    // Don't wait for the warm-up here, so the caller can do other work
+    if (!isWarmedUp()) return false;
 
     // Clear values before starting loop
     clearValues();
 
     delay(10); // let the sensor settle in after power-up
-    bme_internal.begin(0x76);  // Restart needed after power-up
-    delay(100); // And now let the sensor boot up (time cannot be decreased)
+    bme_internal.begin(_i2cAddressHex);  // Restart needed after power-up
+    // The sensor now needs time to boot up (time cannot be decreased)
+    _millisMeasurementRequested = millis();
+    return true;
+}
 
+bool BoschBME280::isMeasurementReady(void)
+{
+    return (millis() - _millisMeasurementRequested) >= BoschBME280_MEASUREMENT_TIME;
+}
+
+SENSOR_STATUS BoschBME280::collectMeasurement(void)
+{
     // Read values
     float temp = bme_internal.readTemperature();
     float press = bme_internal.readPressure();
@@ -104,13 +119,10 @@ bool BoschBME280::update(void)
     DBGM(F(" Humidity: "), sensorValues[BoschBME280_HUMIDITY_VAR_NUM]);
     DBGM(F(" Barometric Pressure: "), sensorValues[BoschBME280_PRESSURE_VAR_NUM]);
     DBGM(F(" Calculated Altitude: "), sensorValues[BoschBME280_ALTITUDE_VAR_NUM], F("\n"));
-
-    // Turn the power back off it it had been turned on
-    if(!wasOn){powerDown();}
+    _millisMeasurementRequested = 0;
 
     // Update the registered variables with the new values
     notifyVariables();
 
-    // Return true when finished
-    return true;
+    return SENSOR_READY;
 }
@@ -26,6 +26,7 @@
  *  Accuracy is ± 3 % RH
  *
  * Slowest response time (humidity): 1sec
+ * Current while measuring: 0.714 mA at most (pressure)
 */
 
 #ifndef BoschBME280_h
@@ -41,6 +42,8 @@
 
 #define BoschBME280_NUM_MEASUREMENTS 4
 #define BoschBME280_WARM_UP 1000
+#define BoschBME280_MEASUREMENT_TIME 100
+#define BoschBME280_POWER_DRAW 0.714  // Most current while measuring in mA
 
 #define BoschBME280_TEMP_RESOLUTION 2
 #define BoschBME280_TEMP_VAR_NUM 0
@@ -66,6 +69,10 @@ public:
     String getSensorLocation(void) override;
 
     bool update(void) override;
+
+    bool startMeasurement(void) override;
+    bool isMeasurementReady(void) override;
+    SENSOR_STATUS collectMeasurement(void) override;
 protected:
     Adafruit_BME280 bme_internal;
     uint8_t _i2cAddressHex;
@@ -5,7 +5,7 @@
  *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
  *
  *This file is for the Campbell Scientific OBS-3+
- *This is dependent on the Adafruit ADS1015 library.
+ *This reads the voltage through the shared ADS1115 converter (ADS1115Bus).
  *
  * Ranges: (depends on sediment size, particle shape, and reflectivity)
  *  Turbidity (low/high): 250/1000 NTU; 500/2000 NTU; 1000/4000 NTU
@@ -25,7 +25,6 @@
 */
 
 #include "CampbellOBS3.h"
-#include <Adafruit_ADS1015.h>
 
 // The constructor - need the power pin, the data pin, and the calibration info
 CampbellOBS3::CampbellOBS3(int powerPin, int dataPin, float A, float B, float C, uint8_t i2cAddress)
@@ -35,6 +34,7 @@ CampbellOBS3::CampbellOBS3(int powerPin, int dataPin, float A, float B, float C,
     _Bvalue = B;
     _Cvalue = C;
     _i2cAddress = i2cAddress;
+    _powerDraw_mA = OBS3_POWER_DRAW;
 }
 
 
@@ -45,13 +45,14 @@ String CampbellOBS3::getSensorLocation(void)
     return sensorLocation;
 }
 
-bool CampbellOBS3::update(void)
+SENSOR_STATUS CampbellOBS3::setup(void)
 {
+    ADS1115Bus::getBus(_i2cAddress)->addChannel(_dataPin);
+    return Sensor::setup();
+}
 
-    // Start the Auxillary ADD
-    Adafruit_ADS1115 ads(_i2cAddress);     /* Use this for the 16-bit version */
-    ads.begin();
-
+bool CampbellOBS3::update(void)
+{
     // Check if the power is on, turn it on if not
     bool wasOn = checkPowerOn();
     if(!wasOn){powerUp();}
@@ -61,22 +62,15 @@ bool CampbellOBS3::update(void)
     // Clear values before starting loop
     clearValues();
 
-    // Variables to store the results in
-    int16_t adcResult = 0;
-    float voltage = 0;
-    float calibResult = 0;
-
     // Read Analog to Digital Converter (ADC)
-    adcResult = ads.readADC_SingleEnded(_dataPin);  // Getting the reading
-    DBGM(F("ads.readADC_SingleEnded("), _dataPin, F("): "), ads.readADC_SingleEnded(_dataPin), F("\t\t"));
-
-    // now convert bits into millivolts
-    // 3.3 is the voltage applied to the sensor (and its return range)
-    // The 17585 is the default bit gain of the ADS1115
-    voltage = (adcResult * 3.3) / 17585.0;
+    // The whole converter is read at once, so a reading taken along with
+    // another sensor since this one warmed up is used
+    float voltage = ADS1115Bus::getBus(_i2cAddress)->getVoltage(_dataPin, _millisPowerOn + _WarmUpTime_ms);
     DBGM("Voltage: ", String(voltage, 6), F("\t\t"));
 
-    calibResult = (_Avalue * sq(voltage)) + (_Bvalue * voltage) + _Cvalue;
+    float calibResult = -9999;
+    if (voltage != -9999)
+        calibResult = (_Avalue * sq(voltage)) + (_Bvalue * voltage) + _Cvalue;
     DBGM(F("Calibration Curve: "));
     DBGM(_Avalue, F("x^2 + "), _Bvalue, F("x + "), _Cvalue, F("\n"));
     DBGM(F("calibResult: "), calibResult, F("\n"));
@@ -90,5 +84,5 @@ bool CampbellOBS3::update(void)
     notifyVariables();
 
     // Return true when finished
-    return true;
+    return (voltage != -9999);
 }
@@ -5,7 +5,7 @@
  *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
  *
  *This file is for the Campbell Scientific OBS-3+
- *This is dependent on the Adafruit ADS1015 library.
+ *This reads the voltage through the shared ADS1115 converter (ADS1115Bus).
  *
  * Ranges: (depends on sediment size, particle shape, and reflectivity)
  *  Turbidity (low/high): 250/1000 NTU; 500/2000 NTU; 1000/4000 NTU
@@ -22,6 +22,7 @@
  *      Turbidity: 0.06/0.2 NTU; 0.1/0.5 NTU; 0.2/1.0 NTU
  *
  * Minimum warm-up time: 2s
+ * Current while powered: 15 mA at most
 */
 
 #ifndef CampbellOBS3_h
@@ -33,10 +34,13 @@
 // #define MODULES_DBG Serial
 #include "ModSensorDebugger.h"
 
+#include "ADS1115Bus.h"
+
 #define ADS1015_ADDRESS (0x48) // 1001 000 (ADDR = GND)
 
 #define OBS3_NUM_VARIABLES 1  // low and high range are treated as completely independent
 #define OBS3_WARM_UP 2000
+#define OBS3_POWER_DRAW 15  // Most current while powered in mA
 #define OBS3_TURB_VAR_NUM 0
 #define OBS3_RESOLUTION 3
 #define OBS3_HR_RESOLUTION 2
@@ -50,6 +54,9 @@ public:
 
     String getSensorLocation(void) override;
 
+    // This adds the sensor's channel to the ones read on the converter
+    SENSOR_STATUS setup(void) override;
+
     bool update(void) override;
 
 protected:
@@ -0,0 +1,56 @@
+/*
+ *CharBufferPrint.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for a Print object which writes into a fixed-size character
+ *buffer.  This allows anything that can be printed to a stream to also be
+ *formatted into a buffer without creating Arduino Strings.
+*/
+
+#ifndef CharBufferPrint_h
+#define CharBufferPrint_h
+
+#include <Arduino.h>
+
+class CharBufferPrint : public Print
+{
+public:
+    // The buffer must have room for the terminating null character
+    CharBufferPrint(char *buffer, size_t bufferSize)
+    {
+        _buffer = buffer;
+        _bufferSize = bufferSize;
+        _length = 0;
+        _overflow = false;
+        if (_bufferSize > 0) _buffer[0] = '\0';
+    }
+
+    // Adds a single character, keeping the buffer null-terminated
+    virtual size_t write(uint8_t c) override
+    {
+        if (_length + 1 >= _bufferSize)
+        {
+            _overflow = true;
+            return 0;
+        }
+        _buffer[_length++] = c;
+        _buffer[_length] = '\0';
+        return 1;
+    }
+    using Print::write;
+
+    // This returns the number of characters in the buffer
+    size_t length(void){return _length;}
+    // This returns true if anything was cut off because the buffer was full
+    bool overflowed(void){return _overflow;}
+
+private:
+    char *_buffer;
+    size_t _bufferSize;
+    size_t _length;
+    bool _overflow;
+};
+
+#endif
@@ -0,0 +1,40 @@
+/*
+ *CountingPrint.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for a Print object which only counts the characters printed to
+ *it.  This is used to find the length of some text (ie, for a Content-Length
+ *header) before printing it for real, without storing it anywhere.
+*/
+
+#ifndef CountingPrint_h
+#define CountingPrint_h
+
+#include <Arduino.h>
+
+class CountingPrint : public Print
+{
+public:
+    CountingPrint(void){_count = 0;}
+
+    virtual size_t write(uint8_t) override
+    {
+        _count++;
+        return 1;
+    }
+    virtual size_t write(const uint8_t *, size_t size) override
+    {
+        _count += size;
+        return size;
+    }
+
+    // This returns the number of characters printed so far
+    size_t count(void){return _count;}
+
+private:
+    size_t _count;
+};
+
+#endif
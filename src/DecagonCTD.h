@@ -27,6 +27,7 @@
  *  Range is 0 to 5 m or 0 to 10 m, depending on model
  *
  * Maximum warm-up time in SDI-12 mode: 500ms
+ * Current while measuring: 0.5 mA (0.03 mA between measurements)
 */
 
 
@@ -38,6 +39,7 @@
 
 #define CTD_NUM_MEASUREMENTS 3
 #define CTD_WARM_UP 500
+#define CTD_POWER_DRAW 0.5  // Current while measuring in mA
 
 #define CTD_COND_RESOLUTION 0
 #define CTD_COND_VAR_NUM 2
@@ -56,15 +58,15 @@ public:
     DecagonCTD(char SDI12address, int powerPin, int dataPin, int numReadings = 1)
      : DecagonSDI12(SDI12address, powerPin, dataPin, numReadings,
                     F("DecagonCTD"), CTD_NUM_MEASUREMENTS, CTD_WARM_UP)
-    {}
+    {_powerDraw_mA = CTD_POWER_DRAW;}
     DecagonCTD(char *SDI12address, int powerPin, int dataPin, int numReadings = 1)
      : DecagonSDI12(SDI12address, powerPin, dataPin, numReadings,
                     F("DecagonCTD"), CTD_NUM_MEASUREMENTS, CTD_WARM_UP)
-    {}
+    {_powerDraw_mA = CTD_POWER_DRAW;}
     DecagonCTD(int SDI12address, int powerPin, int dataPin, int numReadings = 1)
      : DecagonSDI12(SDI12address, powerPin, dataPin, numReadings,
                     F("DecagonCTD"), CTD_NUM_MEASUREMENTS, CTD_WARM_UP)
-    {}
+    {_powerDraw_mA = CTD_POWER_DRAW;}
 };
 
 
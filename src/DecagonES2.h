@@ -22,6 +22,7 @@
  *  Range is -40°C to +50°C
  *
  * Maximum warm-up time in SDI-12 mode: 250ms
+ * Current while measuring: 0.5 mA (0.03 mA between measurements)
 */
 
 #ifndef DecagonES2_h
@@ -32,6 +33,7 @@
 
 #define ES2_NUM_MEASUREMENTS 2
 #define ES2_WARM_UP 250
+#define ES2_POWER_DRAW 0.5  // Current while measuring in mA
 
 #define ES2_COND_RESOLUTION 0
 #define ES2_COND_VAR_NUM 0
@@ -47,15 +49,15 @@ public:
     DecagonES2(char SDI12address, int powerPin, int dataPin, int numReadings = 1)
      : DecagonSDI12(SDI12address, powerPin, dataPin, numReadings,
                     F("DecagonES2"), ES2_NUM_MEASUREMENTS, ES2_WARM_UP)
-    {}
+    {_powerDraw_mA = ES2_POWER_DRAW;}
     DecagonES2(char *SDI12address, int powerPin, int dataPin, int numReadings = 1)
      : DecagonSDI12(SDI12address, powerPin, dataPin, numReadings,
                     F("DecagonES2"), ES2_NUM_MEASUREMENTS, ES2_WARM_UP)
-    {}
+    {_powerDraw_mA = ES2_POWER_DRAW;}
     DecagonES2(int SDI12address, int powerPin, int dataPin, int numReadings = 1)
      : DecagonSDI12(SDI12address, powerPin, dataPin, numReadings,
                     F("DecagonES2"), ES2_NUM_MEASUREMENTS, ES2_WARM_UP)
-    {}
+    {_powerDraw_mA = ES2_POWER_DRAW;}
 };
 
 
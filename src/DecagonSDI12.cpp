@@ -9,36 +9,58 @@
  *It is dependent on the EnviroDIY SDI-12 library.
 */
 
-#define LIBCALL_ENABLEINTERRUPT  // To prevent compiler/linker crashes
-#include <EnableInterrupt.h>  // To handle external and pin change interrupts
-#include <SDI12_ExtInts.h>
-
 #include "DecagonSDI12.h"
+#include "SDI12Bus.h"
 
 // The constructor - need the number of measurements the sensor will return, SDI-12 address, the power pin, and the data pin
 DecagonSDI12::DecagonSDI12(char SDI12address, int powerPin, int dataPin,
                            int numReadings, String sensName,
                            int numMeasurements, int WarmUpTime_ms)
-    : Sensor(powerPin, dataPin, sensName, numMeasurements, WarmUpTime_ms)
+    : SharedBusSensor(powerPin, dataPin, sensName, numMeasurements,
+                      WarmUpTime_ms, SDI12_BUS_TIMEOUT)
 {
     _SDI12address = SDI12address;
     _numReadings = numReadings;
+    _minReadings = numReadings;
+    _numReadingsTaken = 0;
+    _measurementWait_ms = 0;
+    _numMeasurementsExpected = 0;
+    _bus = NULL;
 }
 DecagonSDI12::DecagonSDI12(char *SDI12address, int powerPin, int dataPin,
                            int numReadings, String sensName,
                            int numMeasurements, int WarmUpTime_ms)
-    : Sensor(powerPin, dataPin, sensName, numMeasurements, WarmUpTime_ms)
+    : SharedBusSensor(powerPin, dataPin, sensName, numMeasurements,
+                      WarmUpTime_ms, SDI12_BUS_TIMEOUT)
 {
     _SDI12address = *SDI12address;
     _numReadings = numReadings;
+    _minReadings = numReadings;
+    _numReadingsTaken = 0;
+    _measurementWait_ms = 0;
+    _numMeasurementsExpected = 0;
+    _bus = NULL;
 }
 DecagonSDI12::DecagonSDI12(int SDI12address, int powerPin, int dataPin,
                            int numReadings, String sensName,
                            int numMeasurements, int WarmUpTime_ms)
-    : Sensor(powerPin, dataPin, sensName, numMeasurements, WarmUpTime_ms)
+    : SharedBusSensor(powerPin, dataPin, sensName, numMeasurements,
+                      WarmUpTime_ms, SDI12_BUS_TIMEOUT)
 {
     _SDI12address = SDI12address + '0';
     _numReadings = numReadings;
+    _minReadings = numReadings;
+    _numReadingsTaken = 0;
+    _measurementWait_ms = 0;
+    _numMeasurementsExpected = 0;
+    _bus = NULL;
+}
+
+// The SDI-12 data line this sensor is attached to
+SDI12Bus *DecagonSDI12::getBus(void)
+{
+    if (_bus == NULL) _bus = SDI12Bus::getBus(_dataPin);
+    return _bus;
 }
 
 
@@ -67,35 +89,23 @@ SENSOR_STATUS DecagonSDI12::getStatus(void)
     // Wait until the sensor is warmed up
     waitForWarmUp();
 
-    SDI12 mySDI12(_dataPin);
-    mySDI12.begin();
-    mySDI12.setTimeout(15);  // SDI-12 protocol says sensors must respond within 15 milliseconds
-    enableInterrupt(_dataPin, SDI12::handleInterrupt, CHANGE);
-
     DBGM(F("Asking for sensor acknowlegement\n"));
-    String myCommand = "";
-    myCommand += (char) _SDI12address;
-    myCommand += "!"; // sends 'acknowledge active' command [address][!]
-    mySDI12.sendCommand(myCommand);
-    DBGM(F(">>"), myCommand, F("\n"));
-    delay(30);
-
+    char myCommand[] = {_SDI12address, '!', '\0'};  // sends 'acknowledge active' command [address][!]
     // wait for acknowlegement with format:
     // [address]<CR><LF>
-    String sdiResponse = mySDI12.readStringUntil('\n');
-    sdiResponse.trim();
-    DBGM(F("<<"), sdiResponse, F("\n"));
-
-    // Kill the SDI-12 Object
-    disableInterrupt(_dataPin);
-    mySDI12.clearBuffer();
-    mySDI12.forceHold();
-    mySDI12.end();
+    char sdiResponse[SDI12_BUFFER_SIZE];
+    uint8_t length = getBus()->sendCommand(myCommand, sdiResponse, sizeof(sdiResponse));
+    bool acknowledged = (length == 1 && sdiResponse[0] == _SDI12address);
+    getBus()->setAcknowledged(_SDI12address, acknowledged);
 
     // Turn the power back off it it had been turned on
-    if(!wasOn){powerDown();}
+    if(!wasOn)
+    {
+        getBus()->end();
+        powerDown();
+    }
 
-    if (sdiResponse == String(_SDI12address)) return SENSOR_READY;
+    if (acknowledged) return SENSOR_READY;
     else return SENSOR_ERROR;
 }
 
@@ -112,34 +122,20 @@ bool DecagonSDI12::getSensorInfo(void)
     // Check that the sensor is there and responding
     if (getStatus() == SENSOR_ERROR) return false;
 
-    // Start a new SDI-12 instance
-    SDI12 mySDI12(_dataPin);
-    mySDI12.begin();
-    mySDI12.setTimeout(15);  // SDI-12 protocol says sensors must respond within 15 milliseconds
-    enableInterrupt(_dataPin, SDI12::handleInterrupt, CHANGE);
-
     DBGM(F("Getting sensor info\n"));
     String myCommand = "";
     myCommand += (char) _SDI12address;
     myCommand += "I!"; // sends 'info' command [address][I][!]
-    mySDI12.sendCommand(myCommand);
-    DBGM(F(">>"), myCommand, F("\n"));
-    delay(30);
-
     // wait for acknowlegement with format:
     // [address][SDI12 version supported (2 char)][vendor (8 char)][model (6 char)][version (3 char)][serial number (<14 char)]<CR><LF>
-    String sdiResponse = mySDI12.readStringUntil('\n');
-    sdiResponse.trim();
-    DBGM(F("<<"), sdiResponse, F("\n"));
-
-    // Kill the SDI-12 Object
-    disableInterrupt(_dataPin);
-    mySDI12.clearBuffer();
-    mySDI12.forceHold();
-    mySDI12.end();
+    String sdiResponse = getBus()->sendCommand(myCommand);
 
     // Turn the power back off it it had been turned on
-    if(!wasOn){powerDown();}
+    if(!wasOn)
+    {
+        getBus()->end();
+        powerDown();
+    }
 
     if (sdiResponse.length() > 1)
     {
@@ -183,110 +179,151 @@ String DecagonSDI12::getSensorLocation(void)
     return sensorLocation;
 }
 
-// Uses SDI-12 to communicate with a Decagon Devices 5TM
-bool DecagonSDI12::update()
+// Stops the SDI-12 bus and powers down the sensor
+bool DecagonSDI12::sleep(void)
+{
+    getBus()->end();
+    return Sensor::sleep();
+}
+
+
+// Stops listening on the data pin, after the bus has been measured
+void DecagonSDI12::releaseBus(void)
+{
+    getBus()->end();
+}
+
+
+// This starts the first of the readings to average
+bool DecagonSDI12::startMeasurement(void)
 {
     // Check if the power is on, turn it on if not
-    bool wasOn = checkPowerOn();
-    if(!wasOn){powerUp();}
-    // Wait until the sensor is warmed up
-    waitForWarmUp();
+    if(!checkPowerOn()){powerUp();}
+    // Don't wait for the warm-up here, so the caller can do other work
+    if (!isWarmedUp()) return false;
 
     // Clear values before starting loop
     clearValues();
+    _numReadingsTaken = 0;
+    for (int i = 0; i < _numReturnedVars; i++) _readingStats[i].reset();
 
-    // Check that the sensor is there and responding
-    if (getStatus() == SENSOR_ERROR) return false;
+    // Check that the sensor is there and responding, unless it has already
+    // answered on this bus
+    if (!getBus()->isAcknowledged(_SDI12address) && getStatus() == SENSOR_ERROR)
+        return false;
+
+    return startConcurrentMeasurement();
+}
 
-    // Start a new SDI-12 instance
-    SDI12 mySDI12(_dataPin);
-    mySDI12.begin();
-    mySDI12.setTimeout(15);  // SDI-12 protocol says sensors must respond within 15 milliseconds
-    enableInterrupt(_dataPin, SDI12::handleInterrupt, CHANGE);
 
-    // averages x readings in this one loop
-    for (int j = 0; j < _numReadings; j++)
+// The sensor has finished once the time it reported has passed
+bool DecagonSDI12::isMeasurementReady(void)
+{
+    return (millis() - _millisMeasurementRequested) >= _measurementWait_ms;
+}
+
+
+// A helper function to send the "concurrent measurement" command
+// A concurrent measurement is used instead of the standard "aM!" because
+// the sensor will not abort the measurement if other sensors on the same
+// data line are spoken to while it is measuring.
+bool DecagonSDI12::startConcurrentMeasurement(void)
+{
+    DBGM(F("Taking reading #"), _numReadingsTaken, F("\n"));
+    char myCommand[] = {_SDI12address, 'C', '!', '\0'};  // SDI-12 concurrent measurement command format  [address]['C'][!]
+    // wait for acknowlegement with format
+    // [address][ttt (3 char, seconds)][number of measurments available, 0-99]<CR><LF>
+    char sdiResponse[SDI12_BUFFER_SIZE];
+    uint8_t length = getBus()->sendCommand(myCommand, sdiResponse, sizeof(sdiResponse));
+    int16_t waitSeconds = SDI12Bus::parseDigits(sdiResponse + 1, 3);
+    int16_t numMeasurements = SDI12Bus::parseDigits(sdiResponse + 4, 2);
+
+    if (length != 6 || sdiResponse[0] != _SDI12address
+        || waitSeconds < 0 || numMeasurements < 0)
     {
-        DBGM(F("Taking reading #"), j, F("\n"));
-        String myCommand = "";
-        myCommand += _SDI12address;
-        myCommand += "M!"; // SDI-12 measurement myCommand format  [address]['M'][!]
-        mySDI12.sendCommand(myCommand);
-        DBGM(F(">>"), myCommand, F("\n"));
-        delay(30);  // It just needs this little delay
-
-        // wait for acknowlegement with format
-        // [address][ttt (3 char, seconds)][number of measurments available, 0-9]<CR><LF>
-        String sdiResponse = mySDI12.readStringUntil('\n');
-        sdiResponse.trim();
-        mySDI12.clearBuffer();
-        DBGM(F("<<"), sdiResponse, F("\n"));
-
-        // find out how long we have to wait (in seconds).
-        unsigned int wait = 0;
-        wait = sdiResponse.substring(1,4).toInt();
-        DBGM(F("Waiting "), wait, F(" seconds for measurement\n"));
-
-        // Set up the number of results to expect
-        int numMeasurements = sdiResponse.substring(4,5).toInt();
-        DBGM(numMeasurements, F(" results expected\n"));
-        if (numMeasurements != _numReturnedVars)
-        {
-            DBGM(F("This differs from the sensor's standard design of "));
-            DBGM(_numReturnedVars, F(" measurements!!\n"));
-        }
+        DBGM(F("Failed to start measurement!\n"));
+        _millisMeasurementRequested = 0;
+        // Check that the sensor is still there before the next measurement
+        getBus()->setAcknowledged(_SDI12address, false);
+        return false;
+    }
+    _millisMeasurementRequested = millis();
 
-        unsigned long timerStart = millis();
-        while((millis() - timerStart) < (1000 * wait))
-        {
-            if(mySDI12.available())  // sensor can interrupt us to let us know it is done early
-            {
-                DBGM(F("<<"), mySDI12.readString());  // Read the service request (the address again)
-                DBGM("Wait interrupted!", F("\n"));
-                mySDI12.clearBuffer();
-                delay(5);  // Necessary for reasons unbeknownst to me (else it just fails sometimes..)
-                break;
-            }
-        }
+    // find out how long we have to wait (in seconds).
+    _measurementWait_ms = 1000L * waitSeconds;
+    DBGM(F("Measurement will be ready in "), _measurementWait_ms, F(" ms\n"));
 
-        myCommand = "";
-        myCommand += _SDI12address;
-        myCommand += "D0!";  // SDI-12 command to get data [address][D][dataOption][!]
-        mySDI12.sendCommand(myCommand);
-        DBGM(F(">>"), myCommand, F("\n"));
-        delay(30);  // It just needs this little delay
+    // Set up the number of results to expect
+    DBGM(numMeasurements, F(" results expected\n"));
+    if (numMeasurements != _numReturnedVars)
+    {
+        DBGM(F("This differs from the sensor's standard design of "));
+        DBGM(_numReturnedVars, F(" measurements!!\n"));
+    }
+    // Only read as many values as the sensor has variables for
+    _numMeasurementsExpected = min(numMeasurements, (int16_t)_numReturnedVars);
+
+    return true;
+}
 
-        DBGM(F("Receiving data\n"));
-        mySDI12.read();  // ignore the repeated SDI12 address
-        for (int i = 0; i < _numReturnedVars; i++)
+
+// This reads the data from a finished reading, starting the next reading if
+// more are needed for the average
+SENSOR_STATUS DecagonSDI12::collectMeasurement(void)
+{
+    // SDI-12 command to get data [address][D][dataOption][!], repeated for
+    // each page of values
+    float results[MAX_NUMBER_VARS];
+    int8_t numReceived = getBus()->getData(_SDI12address, results, _numMeasurementsExpected);
+    // A failed reading is left out of the average
+    if (numReceived < _numMeasurementsExpected)
+    {
+        DBGM(F("Failed to read measurement!\n"));
+    }
+    else
+    {
+        for (int i = 0; i < numReceived; i++)
         {
-            float result = mySDI12.parseFloat();
-            sensorValues[i] += result;
-            DBGM(F("Result #"), i, F(": "), result, F("\n"));
+            _readingStats[i].add(results[i]);
+            DBGM(F("Result #"), i, F(": "), results[i], F("\n"));
         }
-        mySDI12.clearBuffer();
     }
 
-    // Average over the number of readings
-    DBGM(F("Averaging over "), _numReadings, F(" readings\n"));
-    for (int i = 0; i < _numReturnedVars; i++)
+    // Start the next reading, if there are more to take
+    _numReadingsTaken++;
+    if (!ReadingStats::isFinished(_readingStats, _numReturnedVars, _numReadingsTaken,
+                                  _minReadings, _numReadings))
     {
-        sensorValues[i] /=  _numReadings;
-        DBGM(F("Result #"), i, F(": "), sensorValues[i], F("\n"));
+        if (startConcurrentMeasurement()) return SENSOR_WAITING;
+        else return SENSOR_ERROR;
     }
+    _millisMeasurementRequested = 0;
 
-    // Kill the SDI-12 Object
-    disableInterrupt(_dataPin);
-    mySDI12.clearBuffer();
-    mySDI12.forceHold();
-    mySDI12.end();
-
-    // Turn the power back off it it had been turned on
-    if(!wasOn){powerDown();}
+    // Average over the good readings
+    for (int i = 0; i < _numReturnedVars; i++)
+    {
+        sensorValues[i] = _readingStats[i].getMean();
+        DBGM(F("Result #"), i, F(": "), sensorValues[i], F(" averaged over "),
+             _readingStats[i].getCount(), F(" readings\n"));
+    }
 
     // Update the registered variables with the new values
     notifyVariables();
 
-    // Return true when finished
-    return true;
+    if (_readingStats[0].getCount() == 0) return SENSOR_ERROR;
+    return SENSOR_READY;
+}
+
+
+ReadingStats *DecagonSDI12::getReadingStats(int varNum)
+{
+    if (varNum < 0 || varNum >= _numReturnedVars) return NULL;
+    return &_readingStats[varNum];
+}
+
+
+void DecagonSDI12::setReadingRange(int minReadings, int maxReadings)
+{
+    _minReadings = max(minReadings, 2);
+    _numReadings = max(maxReadings, _minReadings);
 }
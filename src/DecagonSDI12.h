@@ -24,10 +24,22 @@
 // #define MODULES_DBG Serial
 #include "ModSensorDebugger.h"
 
-#include "SensorBase.h"
+#include "SharedBusSensor.h"
+#include "ReadingStats.h"
+
+class SDI12Bus;  // Forward declaration
+
+// The longest a measurement of all of the sensors on one data pin may take
+#define SDI12_BUS_TIMEOUT 300000L
+// How long values measured along with other sensors on the same data pin are
+// used instead of measuring again when update() is called
+#define SDI12_BUS_SHARED_MS SENSOR_BUS_SHARED_MS
 
 // The main class for the Decagon CTD
-class DecagonSDI12 : public Sensor
+// All of the sensors on one data pin are measured concurrently (see
+// SharedBusSensor.h), so the total wait is that of the slowest sensor rather
+// than the sum of them all.
+class DecagonSDI12 : public SharedBusSensor<DecagonSDI12>
 {
 public:
     DecagonSDI12(char SDI12address, int powerPin, int dataPin,
@@ -48,11 +60,26 @@ public:
 
     virtual SENSOR_STATUS setup(void) override;
     virtual SENSOR_STATUS getStatus(void) override;
+    // This stops listening on the SDI-12 data pin and powers down the sensor
+    virtual bool sleep(void) override;
 
-    virtual bool update(void);
+    virtual bool startMeasurement(void) override;
+    virtual bool isMeasurementReady(void) override;
+    virtual SENSOR_STATUS collectMeasurement(void) override;
+    // This returns the statistics of the readings in the last average
+    virtual ReadingStats *getReadingStats(int varNum) override;
+    // This lets the sensor stop averaging as soon as every variable meets its
+    // precision target (see setPrecisionTarget), taking at least minReadings
+    // (and at least 2) and at most maxReadings readings
+    void setReadingRange(int minReadings, int maxReadings);
 
 protected:
+    // This stops listening on the data pin once the bus has been measured
+    virtual void releaseBus(void) override;
+    // This returns the SDI-12 data line shared with the other sensors on the pin
+    SDI12Bus *getBus(void);
     bool getSensorInfo(void);
+    bool startConcurrentMeasurement(void);
 
 private:
     String _sensorVendor;
@@ -61,6 +88,12 @@ private:
     String _sensorSerialNumber;
     char _SDI12address;
     int _numReadings;
+    int _minReadings;
+    int _numReadingsTaken;
+    uint32_t _measurementWait_ms;
+    uint8_t _numMeasurementsExpected;
+    ReadingStats _readingStats[MAX_NUMBER_VARS];
+    SDI12Bus *_bus;
 };
 
 #endif
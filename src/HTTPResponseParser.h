@@ -0,0 +1,221 @@
+/*
+ *HTTPResponseParser.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for a small HTTP/1.1 response reader.  It reads the response a
+ *character at a time as it arrives from the modem, so the response code is
+ *known as soon as the status line has come in.  After that the rest of the
+ *response (headers and a Content-Length or chunked body) can be read and
+ *thrown away, so that another request can be sent on the same connection.
+*/
+
+#ifndef HTTPResponseParser_h
+#define HTTPResponseParser_h
+
+#include <Arduino.h>
+
+// The longest part of a header line that is kept; only the start of the
+// Content-Length, Transfer-Encoding and Connection headers is needed
+#define HTTP_LINE_BUFFER 32
+// How long to wait for the response code, and then for the rest of the response
+#define HTTP_STATUS_TIMEOUT_MS 10000L
+#define HTTP_DRAIN_TIMEOUT_MS 5000L
+
+class HTTPResponseParser
+{
+public:
+    HTTPResponseParser(void){begin();}
+
+    // This starts reading a new response.  Call this once the request has been
+    // sent; the response time is counted from here.
+    void begin(void)
+    {
+        _state = HTTP_STATUS_LINE;
+        _statusCode = 0;
+        _contentLength = -1;
+        _chunked = false;
+        _closing = false;
+        _lineLength = 0;
+        _remaining = 0;
+        _start = millis();
+        _responseTime = 0;
+    }
+
+    // This reads the response until the final response code is known, the
+    // connection ends or the timeout passes.  Any interim "1xx" responses (ie,
+    // "100 Continue") before the final one are read past.  Returns the
+    // response code, or 0 if none.
+    int readStatus(Stream *stream, uint32_t timeout_ms)
+    {
+        readUntil(stream, HTTP_HEADERS, timeout_ms);
+        return isInterim() ? 0 : _statusCode;
+    }
+
+    // This reads and discards the rest of the response.  Returns true if the
+    // whole response was read.
+    bool readToEnd(Stream *stream, uint32_t timeout_ms)
+    {
+        readUntil(stream, HTTP_DONE, timeout_ms);
+        return _state == HTTP_DONE;
+    }
+
+    // This returns the response code (ie, 201), or 0 if it has not been read
+    int getStatusCode(void){return _statusCode;}
+    // This returns the milliseconds from begin() to the response code arriving
+    uint32_t getResponseTime(void){return _responseTime;}
+    // This returns true if the whole response has been read and the server did
+    // not ask to close the connection, so another request can be sent on it
+    bool canReuseConnection(void){return _state == HTTP_DONE && !_closing;}
+
+    // This processes one character of the response
+    void parse(char c)
+    {
+        switch (_state)
+        {
+            case HTTP_STATUS_LINE:
+            case HTTP_HEADERS:
+            case HTTP_CHUNK_SIZE:
+            case HTTP_TRAILERS:
+            {
+                if (c == '\r') break;
+                if (c != '\n')
+                {
+                    if (_lineLength + 1 < HTTP_LINE_BUFFER)
+                        _line[_lineLength++] = tolower((unsigned char)c);
+                    break;
+                }
+                _line[_lineLength] = '\0';
+                parseLine();
+                _lineLength = 0;
+                break;
+            }
+            case HTTP_BODY:
+            case HTTP_CHUNK_DATA:
+            {
+                if (--_remaining > 0) break;
+                if (_state == HTTP_BODY) _state = HTTP_DONE;
+                else _state = HTTP_CHUNK_END;
+                break;
+            }
+            case HTTP_CHUNK_END:
+            {
+                // The line ending after each chunk
+                if (c == '\n') _state = HTTP_CHUNK_SIZE;
+                break;
+            }
+            default: break;
+        }
+    }
+
+private:
+    enum HTTPState
+    {
+        HTTP_STATUS_LINE = 0,
+        HTTP_HEADERS,
+        HTTP_BODY,
+        HTTP_CHUNK_SIZE,
+        HTTP_CHUNK_DATA,
+        HTTP_CHUNK_END,
+        HTTP_TRAILERS,
+        HTTP_DONE,
+        HTTP_BODY_TO_CLOSE
+    };
+
+    // This reads whatever has arrived until the given state is reached, without
+    // waiting for a fixed number of characters.  While nothing has arrived, it
+    // pauses between checks instead of spinning.
+    void readUntil(Stream *stream, HTTPState target, uint32_t timeout_ms)
+    {
+        uint32_t start = millis();
+        while ((_state < target || isInterim()) && millis() - start < timeout_ms)
+        {
+            if (stream->available() > 0) parse(stream->read());
+            else delay(1);
+        }
+    }
+
+    // An interim response is only headers, followed by the real response
+    bool isInterim(void){return _statusCode >= 100 && _statusCode < 200;}
+
+    // This handles a complete line of the status, headers or chunk sizes
+    void parseLine(void)
+    {
+        switch (_state)
+        {
+            case HTTP_STATUS_LINE:
+            {
+                // ie, "http/1.1 201 created"
+                char *code = strchr(_line, ' ');
+                if (strncmp(_line, "http/", 5) != 0 || code == NULL) return;
+                _statusCode = atoi(code + 1);
+                _responseTime = millis() - _start;
+                _state = HTTP_HEADERS;
+                break;
+            }
+            case HTTP_HEADERS:
+            {
+                if (_lineLength > 0)
+                {
+                    if (strncmp(_line, "content-length:", 15) == 0)
+                        _contentLength = atol(_line + 15);
+                    else if (strncmp(_line, "transfer-encoding:", 18) == 0)
+                        _chunked = (strstr(_line, "chunked") != NULL);
+                    else if (strncmp(_line, "connection:", 11) == 0)
+                        _closing = (strstr(_line, "close") != NULL);
+                    break;
+                }
+                // A blank line ends the headers
+                if (isInterim())
+                {
+                    _contentLength = -1;
+                    _chunked = false;
+                    _closing = false;
+                    _state = HTTP_STATUS_LINE;
+                }
+                else if (_statusCode == 204 || _statusCode == 304) _state = HTTP_DONE;
+                else if (_chunked) _state = HTTP_CHUNK_SIZE;
+                else if (_contentLength == 0) _state = HTTP_DONE;
+                else if (_contentLength > 0)
+                {
+                    _remaining = _contentLength;
+                    _state = HTTP_BODY;
+                }
+                else
+                {
+                    // The body only ends when the server closes the connection
+                    _closing = true;
+                    _state = HTTP_BODY_TO_CLOSE;
+                }
+                break;
+            }
+            case HTTP_CHUNK_SIZE:
+            {
+                _remaining = strtol(_line, NULL, 16);
+                if (_remaining > 0) _state = HTTP_CHUNK_DATA;
+                else _state = HTTP_TRAILERS;
+                break;
+            }
+            case HTTP_TRAILERS:
+            {
+                if (_lineLength == 0) _state = HTTP_DONE;
+                break;
+            }
+            default: break;
+        }
+    }
+
+    HTTPState _state;
+    int _statusCode;
+    long _contentLength;
+    bool _chunked;
+    bool _closing;
+    char _line[HTTP_LINE_BUFFER];
+    uint8_t _lineLength;
+    long _remaining;
+    uint32_t _start;
+    uint32_t _responseTime;
+};
+
+#endif
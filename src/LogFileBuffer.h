@@ -0,0 +1,162 @@
+/*
+ *LogFileBuffer.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for a Print object which collects log records in RAM and only
+ *writes them to an open SD card file in whole 512-byte blocks (or when it is
+ *flushed).  Each write is sized to end on a block boundary of the file, so
+ *full-buffer writes go straight to a single card block instead of through
+ *SdFat's read-modify-write cache.
+ *Records are only ever kept whole on the card: if a write fails, anything it
+ *left on the card is cut off again, and so is the start of a record that was
+ *already written when the rest of it could not be.  If the card cannot be cut
+ *(ie, it was removed), that is done when the file is next attached.
+*/
+
+#ifndef LogFileBuffer_h
+#define LogFileBuffer_h
+
+#include <Arduino.h>
+#include <SdFat.h>
+
+#define LOG_BUFFER_SIZE 512  // The size of one SD card block
+
+class LogFileBuffer : public Print
+{
+public:
+    LogFileBuffer(void)
+    {
+        _file = NULL;
+        _length = 0;
+        _limit = LOG_BUFFER_SIZE;
+        _writeFailed = false;
+        _recordStart = 0;
+        _recordLost = false;
+        _inRecord = false;
+        _recordSplit = false;
+        _recordStartOnCard = 0;
+        _cutPending = false;
+        _cutAt = 0;
+    }
+
+    // This sets the (already open) file that full buffers are written to
+    void attach(SdFile *file)
+    {
+        _file = file;
+        _writeFailed = false;
+        // Finish cutting off anything left from a failed write, as long as
+        // the file still reaches that far
+        if (_cutPending)
+        {
+            if (_file->fileSize() <= _cutAt || _file->truncate(_cutAt)) _cutPending = false;
+        }
+        setLimit();
+        // If more than that is already waiting, write it all out now and line
+        // up with the blocks after that
+        if (_length >= _limit) writeBuffer();
+    }
+    // This forgets the file, keeping anything waiting in the buffer
+    void detach(void){_file = NULL;}
+
+    // Adds a single character, writing the buffer to the file when full
+    virtual size_t write(uint8_t c) override
+    {
+        if (_length >= _limit && !writeBuffer())
+        {
+            // The card is gone and the buffer is full; this byte is lost
+            _recordLost = true;
+            return 0;
+        }
+        _buffer[_length++] = c;
+        return 1;
+    }
+    using Print::write;
+
+    // This writes anything waiting in the buffer to the file
+    // Returns false if the data could not be written.
+    bool writeBuffer(void)
+    {
+        if (_length == 0) return true;
+        if (_file == NULL || _writeFailed) return false;
+        uint32_t fileSize = _file->fileSize();
+        if (_file->write(_buffer, _length) != _length)
+        {
+            _writeFailed = true;
+            // The data is still in the buffer, so take off any of it the
+            // failed write left on the card to keep it from being there twice
+            cutFile(fileSize);
+            return false;
+        }
+        // If a record is only partly written, remember where it starts
+        if (_inRecord && !_recordSplit)
+        {
+            _recordSplit = true;
+            _recordStartOnCard = fileSize + _recordStart;
+        }
+        _length = 0;
+        _recordStart = 0;
+        setLimit();
+        return true;
+    }
+
+    // This returns the number of bytes waiting to be written to the file
+    uint16_t length(void){return _length;}
+    // This returns true if a write to the file has failed since it was attached
+    bool writeFailed(void){return _writeFailed;}
+
+    // These mark the start and end of each record so that a record which did
+    // not fit in a full buffer is dropped whole instead of being cut off
+    void beginRecord(void)
+    {
+        _recordStart = _length;
+        _recordLost = false;
+        _inRecord = true;
+        _recordSplit = false;
+    }
+    // Returns false if the record was dropped
+    bool endRecord(void)
+    {
+        if (_recordLost)
+        {
+            _length = _recordStart;
+            // Cut off the part of the record already written to the card
+            if (_recordSplit) cutFile(_recordStartOnCard);
+        }
+        _inRecord = false;
+        _recordSplit = false;
+        return !_recordLost;
+    }
+
+private:
+    // The buffer is written out when it reaches the next block boundary of the file
+    void setLimit(void)
+    {
+        _limit = LOG_BUFFER_SIZE - (_file->fileSize() % LOG_BUFFER_SIZE);
+    }
+
+    // This cuts the file back to the given length, or remembers to do it when
+    // the file is next attached if it cannot be done now
+    void cutFile(uint32_t length)
+    {
+        if (_file->truncate(length)) return;
+        if (!_cutPending || length < _cutAt) _cutAt = length;
+        _cutPending = true;
+    }
+
+    uint8_t _buffer[LOG_BUFFER_SIZE];
+    SdFile *_file;
+    uint16_t _length;
+    uint16_t _limit;
+    bool _writeFailed;
+    uint16_t _recordStart;
+    bool _recordLost;
+    bool _inRecord;
+    bool _recordSplit;  // Part of the current record has been written
+    uint32_t _recordStartOnCard;
+    bool _cutPending;
+    uint32_t _cutAt;
+};
+
+#endif
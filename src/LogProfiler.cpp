@@ -0,0 +1,86 @@
+/*
+ *LogProfiler.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for timing the steps of a logging cycle.
+*/
+
+#include "LogProfiler.h"
+
+#ifdef LOGGER_PROFILE
+
+LogProfiler::Record LogProfiler::_records[PROFILE_BUFFER_SIZE];
+uint8_t LogProfiler::_first = 0;
+uint8_t LogProfiler::_count = 0;
+uint16_t LogProfiler::_dropped = 0;
+
+
+void LogProfiler::record(uint8_t phase, uint8_t number, uint32_t start_us, uint32_t duration_us)
+{
+    uint8_t i = (_first + _count) % PROFILE_BUFFER_SIZE;
+    if (_count < PROFILE_BUFFER_SIZE) _count++;
+    else
+    {
+        // Full, so the newest step takes the place of the oldest
+        _first = (_first + 1) % PROFILE_BUFFER_SIZE;
+        if (_dropped < 0xFFFF) _dropped++;
+    }
+    _records[i].phase = phase;
+    _records[i].number = number;
+    _records[i].start_us = start_us;
+    _records[i].duration_us = duration_us;
+}
+
+
+void LogProfiler::printHeader(Print *stream)
+{
+    stream->println(F("Step,Number,Start_us,Duration_us"));
+}
+
+
+uint8_t LogProfiler::print(Print *stream)
+{
+    uint8_t numPrinted = _count;
+    for (uint8_t n = 0; n < numPrinted; n++)
+    {
+        Record *r = &_records[(_first + n) % PROFILE_BUFFER_SIZE];
+        printPhaseName(stream, r->phase);
+        stream->print(',');
+        stream->print(r->number);
+        stream->print(',');
+        stream->print(r->start_us);
+        stream->print(',');
+        stream->println(r->duration_us);
+    }
+    _first = 0;
+    _count = 0;
+    return numPrinted;
+}
+
+
+void LogProfiler::printPhaseName(Print *stream, uint8_t phase)
+{
+    switch (phase)
+    {
+        case PROFILE_SENSOR_WAKE: stream->print(F("SensorWake")); break;
+        case PROFILE_SENSOR_START: stream->print(F("SensorStart")); break;
+        case PROFILE_SENSOR_COLLECT: stream->print(F("SensorCollect")); break;
+        case PROFILE_SENSORS_UPDATE: stream->print(F("SensorsUpdate")); break;
+        case PROFILE_SENSORS_SLEEP: stream->print(F("SensorsSleep")); break;
+        case PROFILE_SD_BEGIN: stream->print(F("SDBegin")); break;
+        case PROFILE_LOG_TO_SD: stream->print(F("LogToSD")); break;
+        case PROFILE_MODEM_WAKE: stream->print(F("ModemWake")); break;
+        case PROFILE_MODEM_CONNECT: stream->print(F("ModemConnect")); break;
+        case PROFILE_MODEM_DISCONNECT: stream->print(F("ModemDisconnect")); break;
+        case PROFILE_MODEM_OFF: stream->print(F("ModemOff")); break;
+        case PROFILE_POST: stream->print(F("Post")); break;
+        case PROFILE_SEND_QUEUE: stream->print(F("SendQueue")); break;
+        case PROFILE_SYNC_CLOCK: stream->print(F("SyncClock")); break;
+        case PROFILE_SYSTEM_SLEEP: stream->print(F("SystemSleep")); break;
+        default: stream->print(phase); break;
+    }
+}
+
+#endif
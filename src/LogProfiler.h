@@ -0,0 +1,116 @@
+/*
+ *LogProfiler.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for timing the steps of a logging cycle: waking, starting and
+ *collecting from each sensor, writing to the SD card, and waking the modem,
+ *connecting and posting data.  Each step is timed with micros() from the start
+ *of its function to the end and saved in a small fixed buffer in RAM, which the
+ *logger writes to PROFILE.CSV on the SD card every few readings.
+ *
+ *The profiler is only compiled in if LOGGER_PROFILE is defined below.  When it
+ *is not, the PROFILE_SCOPE() macros are empty and nothing is added to the
+ *program or to RAM.
+*/
+
+#ifndef LogProfiler_h
+#define LogProfiler_h
+
+#include <Arduino.h>
+
+// #define LOGGER_PROFILE
+
+// The number of timed steps kept in RAM; once full, the oldest are replaced
+#define PROFILE_BUFFER_SIZE 32
+// The logger writes the steps to the SD card once there are this many
+#define PROFILE_FLUSH_COUNT 24
+// The file the steps are written to
+#define PROFILE_FILE_NAME "PROFILE.CSV"
+
+// The steps that can be timed.  For the per-sensor steps, the number saved
+// with the step is the sensor's place in the logger's list of sensors.
+typedef enum PROFILE_PHASE
+{
+    PROFILE_SENSOR_WAKE,
+    PROFILE_SENSOR_START,
+    PROFILE_SENSOR_COLLECT,
+    PROFILE_SENSORS_UPDATE,
+    PROFILE_SENSORS_SLEEP,
+    PROFILE_SD_BEGIN,
+    PROFILE_LOG_TO_SD,
+    PROFILE_MODEM_WAKE,
+    PROFILE_MODEM_CONNECT,
+    PROFILE_MODEM_DISCONNECT,
+    PROFILE_MODEM_OFF,
+    PROFILE_POST,
+    PROFILE_SEND_QUEUE,
+    PROFILE_SYNC_CLOCK,
+    PROFILE_SYSTEM_SLEEP
+} PROFILE_PHASE;
+
+#ifdef LOGGER_PROFILE
+
+// Gives each timer in a function its own name
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+// This times everything from this line to the end of the enclosing block.
+// Use as PROFILE_SCOPE(phase) or PROFILE_SCOPE(phase, number).
+#define PROFILE_SCOPE(...) LogProfiler::Scope PROFILE_CONCAT(_profileScope, __LINE__)(__VA_ARGS__)
+
+class LogProfiler
+{
+public:
+    // The timer for one step.  The time is saved when it goes out of scope.
+    class Scope
+    {
+    public:
+        Scope(uint8_t phase, uint8_t number = 0)
+        {
+            _phase = phase;
+            _number = number;
+            _start = micros();
+        }
+        ~Scope(){LogProfiler::record(_phase, _number, _start, micros() - _start);}
+    private:
+        uint8_t _phase;
+        uint8_t _number;
+        uint32_t _start;
+    };
+
+    // This saves a timed step, replacing the oldest one if the buffer is full
+    static void record(uint8_t phase, uint8_t number, uint32_t start_us, uint32_t duration_us);
+
+    // This returns the number of steps waiting to be written
+    static uint8_t getCount(void){return _count;}
+    // This returns the number of steps replaced before they could be written
+    static uint16_t getDropped(void){return _dropped;}
+
+    // This prints the column names for the steps
+    static void printHeader(Print *stream);
+    // This prints the waiting steps as csv lines, oldest first, and empties
+    // the buffer.  Returns the number of steps printed.
+    static uint8_t print(Print *stream);
+    // This prints the name of a step
+    static void printPhaseName(Print *stream, uint8_t phase);
+
+private:
+    struct Record
+    {
+        uint8_t phase;
+        uint8_t number;
+        uint32_t start_us;
+        uint32_t duration_us;
+    };
+    static Record _records[PROFILE_BUFFER_SIZE];
+    static uint8_t _first;
+    static uint8_t _count;
+    static uint16_t _dropped;
+};
+
+#else
+ #define PROFILE_SCOPE(...)
+#endif
+
+#endif
@@ -34,9 +34,27 @@
 // as time from 2000-jan-01 00:00:00 instead of the standard epoch of 19970-jan-01 00:00:00
 
 #include <SdFat.h>  // To communicate with the SD card
+#include "LogFileBuffer.h"  // To collect records into whole SD card blocks
 
 #include "ModemSupport.h"  // To communicate with the internet
 
+// The longest the software clock is trusted before reading the real time clock
+#define SOFTWARE_CLOCK_MAX_MS 3600000UL
+
+// The binary log file format
+// A header block is "MSBL", a format version byte, the number of variables,
+// the decimal resolution of each variable, a 2-byte length and then the text
+// of the same header written at the top of a csv file.  A header block is
+// written each time the log file is set up.
+// Each record is 'R', a status byte, the 4-byte marked epoch time and a 4-byte
+// float for each variable.
+// All numbers are little-endian.  See tools/BinaryLogToCSV for a converter.
+#define BINARY_LOG_VERSION 1
+#define BINARY_LOG_RECORD_MARK 'R'
+// The status byte has a single bit in use, set if any sensor failed to update
+// for the record.  The other 7 bits are always 0, and are kept for later use.
+#define BINARY_LOG_STATUS_UPDATE_FAILED 0x01
+
 // Debugging helpers
 #ifdef LOGGER_DBG
 namespace {
@@ -79,6 +97,19 @@ public:
         _autoFileName = false;
         _isFileNameSet = false;
         _numReadings = 0;
+        _staggerWake = false;
+        _plannedCycleTime = 0;
+        _lastCycleTime = 0;
+        _lastUpdateSuccess = true;
+        _binaryLogging = false;
+        _sdMounted = false;
+        _recordsPerFlush = 1;
+        _minutesPerFlush = 0;
+        _recordsBuffered = 0;
+        _lastFlushEpoch = 0;
+        _batteryVar = NULL;
+        _lowBatteryVoltage = 0;
+        _sensorCount = 0;  // The unique sensors are listed by setupSensors()
 
         // Set sleep variable, if an interrupt pin is given
         if(_mcuWakePin != -1)
@@ -122,6 +153,38 @@ public:
     }
     static int getTZOffset(void) { return Logger::_offset; }
 
+    // This sets whether data is saved to the SD card as compact binary records
+    // instead of csv text.  This must be called before begin().
+    void setBinaryLogging(bool binaryLogging)
+    {
+        _binaryLogging = binaryLogging;
+        DBGLOG(F("Binary logging set to "), _binaryLogging, F("\n"));
+    }
+
+    // This sets how often the records collected in RAM are written to the SD
+    // card.  The card is written after the given number of records or after
+    // the given number of minutes since the last write, whichever comes first.
+    // A time of 0 means only the number of records is used.  Anything not yet
+    // written is lost if the logger loses power, so the default is to write
+    // every record.
+    void setSDFlushPolicy(uint8_t recordsPerFlush, uint16_t maxMinutesBetweenFlushes = 0)
+    {
+        if (recordsPerFlush < 1) recordsPerFlush = 1;
+        _recordsPerFlush = recordsPerFlush;
+        _minutesPerFlush = maxMinutesBetweenFlushes;
+        DBGLOG(F("SD card will be written every "), _recordsPerFlush, F(" records"));
+        if (_minutesPerFlush > 0) DBGLOG(F(" or "), _minutesPerFlush, F(" minutes"));
+        DBGLOG(F("\n"));
+    }
+
+    // This makes the logger write every record to the SD card as soon as the
+    // given battery voltage variable drops below the given voltage
+    void setSDLowBatteryFlush(Variable *batteryVoltage, float lowVoltage)
+    {
+        _batteryVar = batteryVoltage;
+        _lowBatteryVoltage = lowVoltage;
+    }
+
     // Sets up a pin for an LED or other way of alerting that data is being logged
     void setAlertPin(int ledPin)
     {
@@ -135,24 +198,39 @@ public:
     // ===================================================================== //
     // This gets the current epoch time (unix time, ie, the number of seconds
     // from January 1, 1970 00:00:00 UTC) and corrects it for the specified time zone
+    // Every read of the clock also re-anchors the software clock below
     #if defined(ARDUINO_ARCH_SAMD)
         static uint32_t getNowEpoch(void)
         {
           uint32_t currentEpochTime = zero_sleep_rtc.getEpoch();
           currentEpochTime += _offset*3600;
+          anchorClock(currentEpochTime);
           return currentEpochTime;
         }
-        static void setNowEpoch(uint32_t ts){zero_sleep_rtc.setEpoch(ts);}
+        static void setNowEpoch(uint32_t ts){zero_sleep_rtc.setEpoch(ts); _clockAnchored = false;}
     #else
         static uint32_t getNowEpoch(void)
         {
           uint32_t currentEpochTime = rtc.now().getEpoch();
           currentEpochTime += _offset*3600;
+          anchorClock(currentEpochTime);
           return currentEpochTime;
         }
-        static void setNowEpoch(uint32_t ts){rtc.setEpoch(ts);}
+        static void setNowEpoch(uint32_t ts){rtc.setEpoch(ts); _clockAnchored = false;}
     #endif
 
+    // This returns the current epoch time from a software clock counted with
+    // millis() from the last time the real time clock was read, so it does
+    // not need to talk to the clock again.  The real time clock is only read
+    // if it has not been read since the logger last slept, or if it has been
+    // more than SOFTWARE_CLOCK_MAX_MS since it was read.
+    static uint32_t getClockEpoch(void)
+    {
+        uint32_t elapsed = millis() - _clockMillis;
+        if (!_clockAnchored || elapsed > SOFTWARE_CLOCK_MAX_MS) return getNowEpoch();
+        return _clockEpoch + elapsed/1000;
+    }
+
     static DateTime dtFromEpoch(uint32_t epochTime)
     {
         DateTime dt(epochTime - EPOCH_TIME_OFF);
@@ -203,6 +281,7 @@ public:
     // This syncronizes the real time clock to NIST
     bool syncRTClock(void)
     {
+        PROFILE_SCOPE(PROFILE_SYNC_CLOCK);
         uint32_t start_millis = millis();
 
         // Get the time stamp from NIST and adjust it to the correct time zone
@@ -251,9 +330,11 @@ public:
     // It is not currently possible to output the instantaneous time an individual
     // sensor was updated, just a single marked time.  By custom, this should be
     // called before updating the sensors, not after.
-    void markTime(void)
+    void markTime(void){markTime(getNowEpoch());}
+    // Same as above, with a time that has already been read from the clock
+    void markTime(uint32_t epochTime)
     {
-      markedEpochTime = getNowEpoch();
+      markedEpochTime = epochTime;
       markedDateTime = dtFromEpoch(markedEpochTime);
       formatDateTime_ISO8601(markedDateTime).toCharArray(markedISO8601Time, 26);
     }
@@ -269,10 +350,11 @@ public:
         DBGLOG(F("Number of Readings so far: "), _numReadings, F("\n"));
         DBGLOG(F("Mod of 120: "), checkTime % 120, F("\n"));
         if ((checkTime % _interruptRate == 0 ) or
-            (_numReadings < 10 and getNowEpoch() % 120 == 0))
+            (_numReadings < 10 and checkTime % 120 == 0))
         {
-            // Update the time variables with the current time
-            markTime();
+            // Update the time variables with the time just read, so the clock
+            // is only read once for the whole logging cycle
+            markTime(checkTime);
             DBGLOG(F("Time marked at (unix): "), markedEpochTime, F("\n"));
             DBGLOG(F("    year: "), markedDateTime.year(), F("\n"));
             DBGLOG(F("    month: "), markedDateTime.month(), F("\n"));
@@ -350,6 +432,7 @@ public:
     // This DOES NOT sleep or wake the sensors!!
     void systemSleep(void)
     {
+        PROFILE_SCOPE(PROFILE_SYSTEM_SLEEP);
         // Wait until the serial ports have finished transmitting
         // This does not clear their buffers, it just waits until they are finished
         // TODO:  Make sure can find all serial ports
@@ -360,6 +443,10 @@ public:
             LOGGER_DBG.flush();  // for debugging
         #endif
 
+        // The software clock stops while asleep, so read the real clock again
+        // after waking
+        _clockAnchored = false;
+
         // This clears the interrrupt flag in status register of the clock
         // The next timed interrupt will not be sent until this is cleared
         // rtc.clearINTStatus();
@@ -406,6 +493,7 @@ public:
     // This DOES NOT sleep or wake the sensors!!
     void systemSleep(void)
     {
+        PROFILE_SCOPE(PROFILE_SYSTEM_SLEEP);
         // Wait until the serial ports have finished transmitting
         // This does not clear their buffers, it just waits until they are finished
         // TODO:  Make sure can find all serial ports
@@ -416,6 +504,10 @@ public:
             LOGGER_DBG.flush();  // for debugging
         #endif
 
+        // The software clock stops while asleep, so read the real clock again
+        // after waking
+        _clockAnchored = false;
+
         // This clears the interrrupt flag in status register of the clock
         // The next timed interrupt will not be sent until this is cleared
         rtc.clearINTStatus();
@@ -483,8 +575,9 @@ public:
             fileName +=  String(_loggerID);
             fileName +=  F("_");
         }
-        fileName +=  formatDateTime_ISO8601(getNowEpoch()).substring(0, 10);
-        fileName +=  F(".csv");
+        fileName +=  formatDateTime_ISO8601(getClockEpoch()).substring(0, 10);
+        if (_binaryLogging) fileName +=  F(".bin");
+        else fileName +=  F(".csv");
         setFileName(fileName);
     }
 
@@ -544,11 +637,37 @@ public:
         return csvString;
     }
 
+    // This prints the time and comma separated list of sensor values straight
+    // to a stream or file without building a String
+    void printSensorDataCSV(Print *stream)
+    {
+        printDateTime(stream, markedDateTime);
+        stream->print(',');
+        VariableArray::printSensorDataCSV(stream);
+    }
+
+    // This writes the time and comma separated list of sensor values into a
+    // character buffer.  Returns the length of the text, or -1 if the buffer
+    // was too small and the text was cut off.
+    int generateSensorDataCSV(char *buffer, size_t bufferSize)
+    {
+        CharBufferPrint bufferPrint(buffer, bufferSize);
+        printSensorDataCSV(&bufferPrint);
+        if (bufferPrint.overflowed()) return -1;
+        return bufferPrint.length();
+    }
+
     // This initializes a file on the SD card and writes a header to it
     void setupLogFile(void)
     {
         // Initialise the SD card
-        if (!sd.begin(_SDCardPin, SPI_FULL_SPEED))
+        _logBuffer.detach();
+        if (logFile.isOpen()) logFile.close();
+        {
+            PROFILE_SCOPE(PROFILE_SD_BEGIN);
+            _sdMounted = sd.begin(_SDCardPin, SPI_FULL_SPEED);
+        }
+        if (!_sdMounted)
         {
             PRINTOUT(F("Error: SD card failed to initialize or is missing.\n"));
             PRINTOUT(F("Data will not be saved!.\n"));
@@ -568,86 +687,93 @@ public:
             _fileName.toCharArray(charFileName, fileNameLength);
 
             // Open the file in write mode (and create it if it did not exist)
-            logFile.open(charFileName, O_CREAT | O_WRITE | O_AT_END);
-            // Set creation date time
-            logFile.timestamp(T_CREATE, dtFromEpoch(getNowEpoch()).year(),
-                                        dtFromEpoch(getNowEpoch()).month(),
-                                        dtFromEpoch(getNowEpoch()).date(),
-                                        dtFromEpoch(getNowEpoch()).hour(),
-                                        dtFromEpoch(getNowEpoch()).minute(),
-                                        dtFromEpoch(getNowEpoch()).second());
-            // Set write/modification date time
-            logFile.timestamp(T_WRITE, dtFromEpoch(getNowEpoch()).year(),
-                                       dtFromEpoch(getNowEpoch()).month(),
-                                       dtFromEpoch(getNowEpoch()).date(),
-                                       dtFromEpoch(getNowEpoch()).hour(),
-                                       dtFromEpoch(getNowEpoch()).minute(),
-                                       dtFromEpoch(getNowEpoch()).second());
-            // Set access date time
-            logFile.timestamp(T_ACCESS, dtFromEpoch(getNowEpoch()).year(),
-                                        dtFromEpoch(getNowEpoch()).month(),
-                                        dtFromEpoch(getNowEpoch()).date(),
-                                        dtFromEpoch(getNowEpoch()).hour(),
-                                        dtFromEpoch(getNowEpoch()).minute(),
-                                        dtFromEpoch(getNowEpoch()).second());
+            if (!logFile.open(charFileName, O_CREAT | O_WRITE | O_AT_END))
+            {
+                PRINTOUT(F("Error: Unable to create "), _fileName, F("\n"));
+                return;
+            }
+            // Set creation, write/modification and access date times
+            stampLogFile(T_CREATE | T_WRITE | T_ACCESS);
             PRINTOUT(F("   ... File created!\n"));
 
             // Add header information
-            logFile.print(generateFileHeader());
+            if (_binaryLogging) writeBinaryHeader(&logFile);
+            else logFile.print(generateFileHeader());
             DBGLOG(generateFileHeader(), F("\n"));
 
-            //Close the file to save it
-            logFile.close();
+            // Save the header, but leave the file open for the records
+            logFile.sync();
+            _logBuffer.attach(&logFile);
         }
     }
 
     // This writes a record to the SD card
+    // The record is collected in RAM and written to the card according to the
+    // flush policy.
     void logToSD(String rec)
     {
-        // Make sure the SD card is still initialized
-        if (!sd.begin(_SDCardPin, SPI_FULL_SPEED))
+        PROFILE_SCOPE(PROFILE_LOG_TO_SD);
+        _logBuffer.beginRecord();
+        _logBuffer.println(rec);
+        if (!endLogRecord()) return;
+        // Echo the line to the serial port
+        PRINTOUT(F("\n \\/---- Line Saved to SD Card ----\\/ \n"));
+        PRINTOUT(rec, F("\n"));
+        writeLogFileIfDue();
+    }
+
+    // This writes the current sensor data to the SD card, printing it straight
+    // into the file instead of building the record as a String first
+    void logToSD(void)
+    {
+        PROFILE_SCOPE(PROFILE_LOG_TO_SD);
+        // Add the binary or CSV data to the buffer
+        _logBuffer.beginRecord();
+        if (_binaryLogging) writeBinaryRecord(&_logBuffer);
+        else
         {
-            PRINTOUT(F("Error: SD card failed to initialize or is missing.\n"));
-            PRINTOUT(F("Data will not be saved!.\n"));
+            printSensorDataCSV(&_logBuffer);
+            _logBuffer.println();
         }
-        else  // skip everything else if there's no SD card, otherwise it might hang
-        {
-            // Convert the string filename to a character file name for SdFat
-            int fileNameLength = _fileName.length() + 1;
-            char charFileName[fileNameLength];
-            _fileName.toCharArray(charFileName, fileNameLength);
+        if (!endLogRecord()) return;
+        // Echo the line to the serial port
+        PRINTOUT(F("\n \\/---- Line Saved to SD Card ----\\/ \n"));
+        #if defined(MODULAR_SENSORS_OUTPUT)
+            printSensorDataCSV(&MODULAR_SENSORS_OUTPUT);
+            PRINTOUT(F("\n"));
+        #endif
+        writeLogFileIfDue();
+    }
 
-            // Check that the file exists, just in case someone yanked the SD card
-            if (!logFile.open(charFileName, O_WRITE | O_AT_END))
-            {
-                PRINTOUT(F("SD Card File Lost!  Starting new file.\n"));
-                setupLogFile();
-            }
+    // This writes any records waiting in RAM to the SD card, sets the file
+    // modification time and saves the file.  If the card has been removed or
+    // cannot be written, it is remounted at the next attempt.
+    // Returns true if everything was saved.
+    bool flushLogFile(void)
+    {
+        if (!openLogFile()) return false;
+
+        bool success = _logBuffer.writeBuffer();
+        if (success)
+        {
+            // Set write/modification and access date times
+            stampLogFile(T_WRITE | T_ACCESS);
+            // Save the data and the directory entry to the card
+            success = logFile.sync();
+        }
 
-            // Write the CSV data
-            logFile.println(rec);
-            // Echo the line to the serial port
-            PRINTOUT(F("\n \\/---- Line Saved to SD Card ----\\/ \n"));
-            PRINTOUT(rec, F("\n"));
-
-            // Set write/modification date time
-            logFile.timestamp(T_WRITE, dtFromEpoch(getNowEpoch()).year(),
-                                       dtFromEpoch(getNowEpoch()).month(),
-                                       dtFromEpoch(getNowEpoch()).date(),
-                                       dtFromEpoch(getNowEpoch()).hour(),
-                                       dtFromEpoch(getNowEpoch()).minute(),
-                                       dtFromEpoch(getNowEpoch()).second());
-            // Set access date time
-            logFile.timestamp(T_ACCESS, dtFromEpoch(getNowEpoch()).year(),
-                                        dtFromEpoch(getNowEpoch()).month(),
-                                        dtFromEpoch(getNowEpoch()).date(),
-                                        dtFromEpoch(getNowEpoch()).hour(),
-                                        dtFromEpoch(getNowEpoch()).minute(),
-                                        dtFromEpoch(getNowEpoch()).second());
-
-            // Close the file to save it
+        if (!success)
+        {
+            PRINTOUT(F("Error: Unable to write to the SD card.  Will retry.\n"));
+            _logBuffer.detach();
             logFile.close();
+            _sdMounted = false;
+            return false;
         }
+        DBGLOG(_recordsBuffered, F(" records saved to the SD card\n"));
+        _recordsBuffered = 0;
+        _lastFlushEpoch = markedEpochTime;
+        return true;
     }
 
 
@@ -802,17 +928,18 @@ public:
             // Turn on the LED to show we're taking a reading
             digitalWrite(_ledPin, HIGH);
 
-            // Wake up all of the sensors
+            // Wake up all of the sensors and update their values, servicing
+            // each sensor as soon as it is ready
             // I'm not doing as part of sleep b/c it may take up to a second or
             // two for them all to wake which throws off the checkInterval()
-            sensorsWake();
-            // Update the values from all attached sensors
-            updateAllSensors();
+            updateAllSensorsScheduled();
             // Immediately put sensors to sleep to save power
             sensorsSleep();
 
             // Create a csv data record and save it to the log file
-            logToSD(generateSensorDataCSV());
+            logToSD();
+            // Save the step timings, if profiling
+            writeProfileIfDue();
 
             // Turn off the LED
             digitalWrite(_ledPin, LOW);
@@ -824,6 +951,9 @@ public:
         if(_sleep){systemSleep();}
     }
 
+    // This returns how long the modem was on for the last connection, in ms
+    virtual uint32_t getLastModemOnTime(void){return 0;}
+
     // Public variables
     // Time stamps - want to set them at a single time and carry them forward
     static long markedEpochTime;
@@ -836,11 +966,164 @@ public:
 // Things that are private and protected below here
 // ===================================================================== //
 protected:
+    // This prints two digits, with a leading zero if needed
+    static void printTwoDigits(Print *stream, uint8_t value)
+    {
+        if (value < 10) stream->print('0');
+        stream->print(value);
+    }
+
+    // This prints a date and time in the same format as DateTime::addToString()
+    // (YYYY-MM-DD hh:mm:ss) without building a String
+    static void printDateTime(Print *stream, DateTime dt)
+    {
+        stream->print(dt.year());
+        stream->print('-');
+        printTwoDigits(stream, dt.month());
+        stream->print('-');
+        printTwoDigits(stream, dt.date());
+        stream->print(' ');
+        printTwoDigits(stream, dt.hour());
+        stream->print(':');
+        printTwoDigits(stream, dt.minute());
+        stream->print(':');
+        printTwoDigits(stream, dt.second());
+    }
+
+    // This sets the given time stamps of the log file to the current time
+    void stampLogFile(uint8_t flags)
+    {
+        DateTime dt = dtFromEpoch(getClockEpoch());
+        logFile.timestamp(flags, dt.year(), dt.month(), dt.date(),
+                          dt.hour(), dt.minute(), dt.second());
+    }
+
+    // This makes sure the SD card is initialized and the log file is open for
+    // writing, starting a new file if the old one is missing.  The card is only
+    // initialized and the file only opened again after an error; otherwise the
+    // file stays open between records.  Returns false if there is no SD card.
+    bool openLogFile(void)
+    {
+        if (_sdMounted && logFile.isOpen()) return true;
+
+        // Initialize the SD card again
+        _logBuffer.detach();
+        if (logFile.isOpen()) logFile.close();
+        {
+            PROFILE_SCOPE(PROFILE_SD_BEGIN);
+            _sdMounted = sd.begin(_SDCardPin, SPI_FULL_SPEED);
+        }
+        if (!_sdMounted)
+        {
+            PRINTOUT(F("Error: SD card failed to initialize or is missing.\n"));
+            PRINTOUT(F("Data will be saved when the card is back.\n"));
+            return false;
+        }
+
+        // Convert the string filename to a character file name for SdFat
+        int fileNameLength = _fileName.length() + 1;
+        char charFileName[fileNameLength];
+        _fileName.toCharArray(charFileName, fileNameLength);
+
+        // Check that the file exists, just in case someone yanked the SD card
+        if (!logFile.open(charFileName, O_WRITE | O_AT_END))
+        {
+            PRINTOUT(F("SD Card File Lost!  Starting new file.\n"));
+            setupLogFile();
+            return _sdMounted && logFile.isOpen();
+        }
+        _logBuffer.attach(&logFile);
+        return true;
+    }
+
+    // This finishes a record in the buffer and counts it
+    // Returns false if it had to be dropped because the buffer was full and
+    // the SD card could not be written.
+    bool endLogRecord(void)
+    {
+        if (!_logBuffer.endRecord())
+        {
+            PRINTOUT(F("Error: SD card unavailable and buffer full, record dropped!\n"));
+            return false;
+        }
+        _recordsBuffered++;
+        return true;
+    }
+
+    // This writes the buffered records to the SD card if the flush policy says
+    // it is time to
+    void writeLogFileIfDue(void)
+    {
+        bool flushDue = _recordsBuffered >= _recordsPerFlush;
+        if (_minutesPerFlush > 0 &&
+            markedEpochTime - _lastFlushEpoch >= (long)_minutesPerFlush*60L)
+            flushDue = true;
+        if (_batteryVar != NULL && _batteryVar->getValue() < _lowBatteryVoltage)
+            flushDue = true;
+        if (flushDue) flushLogFile();
+    }
+
+    // This writes the timed steps of the last few logging cycles to the
+    // profile file on the SD card once enough have been collected.  This does
+    // nothing unless LOGGER_PROFILE is defined in LogProfiler.h.
+    void writeProfileIfDue(void)
+    {
+    #ifdef LOGGER_PROFILE
+        if (LogProfiler::getCount() < PROFILE_FLUSH_COUNT) return;
+        SdFile profileFile;
+        if (!openLogFile() ||
+            !profileFile.open(PROFILE_FILE_NAME, O_CREAT | O_WRITE | O_AT_END))
+            return;
+        if (profileFile.fileSize() == 0) LogProfiler::printHeader(&profileFile);
+        LogProfiler::print(&profileFile);
+        profileFile.close();
+    #endif
+    }
+
+    // This writes the binary header block with the same information as the
+    // csv file header
+    void writeBinaryHeader(Print *stream)
+    {
+        String header = generateFileHeader();
+        uint16_t headerLength = header.length();
+        stream->write((const uint8_t*)"MSBL", 4);
+        stream->write((uint8_t)BINARY_LOG_VERSION);
+        stream->write((uint8_t)_variableCount);
+        for (uint8_t i = 0; i < _variableCount; i++)
+            stream->write((uint8_t)_variableList[i]->getResolution());
+        stream->write((const uint8_t*)&headerLength, 2);
+        stream->write((const uint8_t*)header.c_str(), headerLength);
+    }
+
+    // This writes a fixed-width binary record of the marked time and values
+    void writeBinaryRecord(Print *stream)
+    {
+        uint8_t status = 0;
+        if (!_lastUpdateSuccess) status |= BINARY_LOG_STATUS_UPDATE_FAILED;
+        uint32_t epoch = markedEpochTime;
+        stream->write((uint8_t)BINARY_LOG_RECORD_MARK);
+        stream->write(status);
+        stream->write((const uint8_t*)&epoch, 4);
+        for (uint8_t i = 0; i < _variableCount; i++)
+        {
+            float value = _variableList[i]->getValue();
+            stream->write((const uint8_t*)&value, 4);
+        }
+    }
 
     // The SD card and file
     SdFat sd;
     SdFile logFile;
     String _fileName;
+    // Records waiting to be written to the card
+    LogFileBuffer _logBuffer;
+    bool _sdMounted;
+    uint8_t _recordsPerFlush;
+    uint16_t _minutesPerFlush;
+    uint8_t _recordsBuffered;
+    long _lastFlushEpoch;
+    Variable *_batteryVar;
+    float _lowBatteryVoltage;
 
     // Static variables - identical for EVERY logger
     static int _timeZone;
@@ -850,6 +1133,17 @@ protected:
     static DateTime markedDateTime;
     static char markedISO8601Time[26];
 
+    // The software clock
+    static void anchorClock(uint32_t epochTime)
+    {
+        _clockEpoch = epochTime;
+        _clockMillis = millis();
+        _clockAnchored = true;
+    }
+    static uint32_t _clockEpoch;
+    static uint32_t _clockMillis;
+    static bool _clockAnchored;
+
     // Initialization variables
     int _SDCardPin;
     int _mcuWakePin;
@@ -858,9 +1152,10 @@ protected:
     const char *_loggerID;
     bool _autoFileName;
     bool _isFileNameSet;
-    uint8_t _numReadings;
+    uint32_t _numReadings;  // This must not roll over every few days
     bool _sleep;
     int _ledPin;
+    bool _binaryLogging;
 };
 
 // Initialize the static timezone
@@ -871,6 +1166,10 @@ int Logger::_offset = 0;
 long Logger::markedEpochTime = 0;
 DateTime Logger::markedDateTime = 0;
 char Logger::markedISO8601Time[26];
+// Initialize the software clock
+uint32_t Logger::_clockEpoch = 0;
+uint32_t Logger::_clockMillis = 0;
+bool Logger::_clockAnchored = false;
 
 #if defined(ARDUINO_ARCH_SAMD)
     RTCZero Logger::zero_sleep_rtc;
@@ -59,10 +59,7 @@ public:
     // Post the data to dream host.
     int postDataDreamHost(void)
     {
-        // Create a buffer for the response
-        char response_buffer[12] = "";
-        int did_respond = 0;
-
+        PROFILE_SCOPE(PROFILE_POST, 1);
         // Open a TCP/IP connection to DreamHost
         if(modem.connect("swrcsensors.dreamhosters.com", 80))
         {
@@ -76,44 +73,13 @@ public:
             // Send the request to the modem stream
             modem.dumpBuffer(modem._client);
             streamDreamHostRequest(modem._client);
-            modem._client->flush();  // wait for sending to finish
-
-            uint32_t start_timer;
-            if (millis() < 4294957296) start_timer = millis();  // In case of roll-over
-            else start_timer = 0;
-            while ((millis() - start_timer) < 10000L && modem._client->available() < 12)
-            {delay(10);}
-
-            // Read only the first 12 characters of the response
-            // We're only reading as far as the http code, anything beyond that
-            // we don't care about so we're not reading to save on total
-            // data used for transmission.
-            did_respond = modem._client->readBytes(response_buffer, 12);
-
-            // Close the TCP/IP connection as soon as the first 12 characters are read
-            // We don't need anything else and stoping here should save data use.
-            modem.stop();
+            return getHTTPResponse();
         }
-        else PRINTOUT(F("\n -- Unable to Establish Connection to DreamHost -- \n"));
-
-        // Process the HTTP response
-        int responseCode = 0;
-        if (did_respond > 0)
+        else
         {
-            char responseCode_char[4];
-            for (int i = 0; i < 3; i++)
-            {
-                responseCode_char[i] = response_buffer[i+9];
-            }
-            responseCode = atoi(responseCode_char);
-            // modem.dumpBuffer(modem._client);
+            PRINTOUT(F("\n -- Unable to Establish Connection to DreamHost -- \n"));
+            return getHTTPResponse(false);
         }
-        else responseCode=504;
-
-        PRINTOUT(F(" -- Response Code -- \n"));
-        PRINTOUT(responseCode, F("\n"));
-
-        return responseCode;
     }
 
     // ===================================================================== //
@@ -134,21 +100,20 @@ public:
             // Turn on the modem to let it start searching for the network
             modem.wake();
 
-            // Wake up all of the sensors
+            // Wake up all of the sensors and update their values, servicing
+            // each sensor as soon as it is ready
             // I'm not doing as part of sleep b/c it may take up to a second or
             // two for them all to wake which throws off the checkInterval()
-            sensorsWake();
-            // Update the values from all attached sensors
-            updateAllSensors();
+            updateAllSensorsScheduled();
             // Immediately put sensors to sleep to save power
             sensorsSleep();
 
             // Connect to the network
-            if (modem.connectNetwork())
+            bool networkConnected = modem.connectNetwork();
+            // Post the data to the WebSDL, or save it to send later
+            sendOrQueueEnviroDIY(networkConnected);
+            if (networkConnected)
             {
-                // Post the data to the WebSDL
-                postDataEnviroDIY();
-
                 // Post the data to DreamHost
                 postDataDreamHost();
 
@@ -166,7 +131,9 @@ public:
             modem.off();
 
             // Create a csv data record and save it to the log file
-            logToSD(generateSensorDataCSV());
+            logToSD();
+            // Save the step timings, if profiling
+            writeProfileIfDue();
 
             // Turn off the LED
             digitalWrite(_ledPin, LOW);
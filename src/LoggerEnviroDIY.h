@@ -12,6 +12,22 @@
 #define LoggerEnviroDIY_h
 
 #include "LoggerBase.h"
+#include "CountingPrint.h"
+#include "HTTPResponseParser.h"
+
+// The outbound queue of records which could not be sent to EnviroDIY
+// Each line of the queue file is the JSON for one record; the cursor file
+// holds the 4-byte position of the first record not yet accepted.
+#define ENVIRODIY_QUEUE_FILE "EDIY_Q.TXT"
+#define ENVIRODIY_CURSOR_FILE "EDIY_Q.POS"
+// Once this much of the front of the queue has been sent, the rest is copied
+// to a new queue file (through this one), so the file does not keep growing
+// while there is always something waiting
+#define ENVIRODIY_QUEUE_TEMP_FILE "EDIY_Q.TMP"
+#define ENVIRODIY_QUEUE_COMPACT_BYTES 32768L
+// The default for how much of the queue to send each time the logger connects
+#define ENVIRODIY_QUEUE_SECONDS 60
+#define ENVIRODIY_QUEUE_BYTES 16384L
 
 // ============================================================================
 //  Functions for the EnviroDIY data portal receivers.
@@ -19,6 +35,24 @@
 class LoggerEnviroDIY : public Logger
 {
 public:
+    // The constructor only sets the defaults; the tokens, UUIDs and sending
+    // settings can be changed before or after Logger::init()
+    LoggerEnviroDIY(void)
+    {
+        _registrationToken = NULL;
+        _samplingFeature = NULL;
+        _UUIDs = NULL;
+        _lastResponseTime = 0;
+        _lastModemOnTime = 0;
+        _batchSize = 1;
+        _keepAlive = false;
+        _queueLoaded = false;
+        _queueSize = 0;
+        _queueCursor = 0;
+        _queueSeconds = ENVIRODIY_QUEUE_SECONDS;
+        _queueBytes = ENVIRODIY_QUEUE_BYTES;
+    }
+
     // Set up communications
     void setToken(const char *registrationToken)
     {
@@ -38,6 +72,24 @@ public:
         DBGLOG(F("UUID array set!\n"));
     }
 
+    // This sets how many readings are collected in the queue before the modem
+    // is turned on and they are all sent together over a single connection.
+    // The default of 1 sends every reading as it is taken.
+    void setBatchSize(uint8_t readingsPerBatch)
+    {
+        if (readingsPerBatch < 1) readingsPerBatch = 1;
+        _batchSize = readingsPerBatch;
+        DBGLOG(F("Data will be sent to EnviroDIY every "), _batchSize, F(" readings\n"));
+    }
+
+    // This sets how long (in seconds) and how much (in bytes) of the queue
+    // of unsent records may be sent each time the logger connects
+    void setQueueBudget(uint16_t maxSeconds, uint32_t maxBytes)
+    {
+        _queueSeconds = maxSeconds;
+        _queueBytes = maxBytes;
+    }
+
     // This adds extra data to the datafile header
     String generateFileHeader(void)
     {
@@ -78,27 +130,67 @@ public:
         return jsonString;
     }
 
+    // This prints the same JSON straight to a stream or file without building
+    // a String.  The values already read from the sensors are printed; this
+    // does not ask any sensor for a new value, so printing the JSON twice
+    // gives exactly the same text.
+    void printSensorDataJSON(Print *stream)
+    {
+        stream->print(F("{\"sampling_feature\": \""));
+        stream->print(_samplingFeature);
+        stream->print(F("\", \"timestamp\": \""));
+        stream->print(Logger::markedISO8601Time);
+        stream->print(F("\", "));
+
+        for (int i = 0; i < Logger::_variableCount; i++)
+        {
+            stream->print('"');
+            stream->print(_UUIDs[i]);
+            stream->print(F("\": "));
+            Logger::_variableList[i]->printValue(stream, false);
+            if (i + 1 != Logger::_variableCount)
+            {
+                stream->print(F(", "));
+            }
+        }
+
+        stream->print(F(" }"));
+    }
+
+    // This returns the length of the JSON printed by printSensorDataJSON()
+    size_t getSensorDataJSONLength(void)
+    {
+        CountingPrint counter;
+        printSensorDataJSON(&counter);
+        return counter.count();
+    }
+
     // Communication functions
     void streamEnviroDIYRequest(Stream *stream)
     {
-        stream->print(String(F("POST /api/data-stream/ HTTP/1.1")));
-        stream->print(String(F("\r\nHost: data.envirodiy.org")));
-        stream->print(String(F("\r\nTOKEN: ")) + String(_registrationToken));
-        // stream->print(String(F("\r\nCache-Control: no-cache")));
-        // stream->print(String(F("\r\nConnection: close")));
-        stream->print(String(F("\r\nContent-Length: ")) + String(generateSensorDataJSON().length()));
-        stream->print(String(F("\r\nContent-Type: application/json\r\n\r\n")));
-        stream->print(String(generateSensorDataJSON()));
+        streamEnviroDIYHeaders(stream, getSensorDataJSONLength());
+        printSensorDataJSON(stream);
+    }
+
+    // This sends the HTTP headers for a post of the given length
+    void streamEnviroDIYHeaders(Stream *stream, uint16_t contentLength)
+    {
+        stream->print(F("POST /api/data-stream/ HTTP/1.1"));
+        stream->print(F("\r\nHost: data.envirodiy.org"));
+        stream->print(F("\r\nTOKEN: "));
+        stream->print(_registrationToken);
+        // stream->print(F("\r\nCache-Control: no-cache"));
+        // stream->print(F("\r\nConnection: close"));
+        stream->print(F("\r\nContent-Length: "));
+        stream->print(contentLength);
+        stream->print(F("\r\nContent-Type: application/json\r\n\r\n"));
     }
 
 
     // Public function to send data
     int postDataEnviroDIY(void)
     {
-        // Create a buffer for the response
-        char response_buffer[12] = "";
-        int did_respond = 0;
-
+        PROFILE_SCOPE(PROFILE_POST);
         // Open a TCP/IP connection to the Enviro DIY Data Portal (WebSDL)
         if(modem.connect("data.envirodiy.org", 80))
         {
@@ -113,44 +205,139 @@ public:
             // Send the request to the modem stream
             modem.dumpBuffer(modem._client);
             streamEnviroDIYRequest(modem._client);
-            modem._client->flush();  // wait for sending to finish
+            return getHTTPResponse();
+        }
+        else
+        {
+            PRINTOUT(F("\n -- Unable to Establish Connection to EnviroDIY Data Portal -- \n"));
+            return getHTTPResponse(false);
+        }
+    }
 
-            uint32_t start_timer;
-            if (millis() < 4294957296) start_timer = millis();  // In case of roll-over
-            else start_timer = 0;
-            while ((millis() - start_timer) < 10000L && modem._client->available() < 12)
-            {delay(10);}
+    // This returns the number of milliseconds between the end of the last
+    // request and its response code arriving, or 0 if there was no response
+    uint32_t getLastResponseTime(void){return _lastResponseTime;}
+    // This returns how long the modem was on for the last batch, in ms
+    virtual uint32_t getLastModemOnTime(void) override {return _lastModemOnTime;}
 
-            // Read only the first 12 characters of the response
-            // We're only reading as far as the http code, anything beyond that
-            // we don't care about so we're not reading to save on total
-            // data used for transmission.
-            did_respond = modem._client->readBytes(response_buffer, 12);
+    // This returns the number of bytes of records waiting in the outbound queue
+    uint32_t getQueuedBytes(void)
+    {
+        loadQueue();
+        return _queueSize - _queueCursor;
+    }
 
-            // Close the TCP/IP connection as soon as the first 12 characters are read
-            // We don't need anything else and stoping here should save data use.
-            modem.stop();
+    // This adds the current data to the outbound queue on the SD card, to be
+    // sent later by sendQueueEnviroDIY()
+    bool queueDataEnviroDIY(void)
+    {
+        loadQueue();
+        SdFile queueFile;
+        if (!openLogFile() ||
+            !queueFile.open(ENVIRODIY_QUEUE_FILE, O_CREAT | O_WRITE | O_AT_END))
+        {
+            PRINTOUT(F("Error: Unable to add data to the EnviroDIY queue!\n"));
+            return false;
         }
-        else PRINTOUT(F("\n -- Unable to Establish Connection to EnviroDIY Data Portal -- \n"));
+        printSensorDataJSON(&queueFile);
+        queueFile.println();
+        _queueSize = queueFile.fileSize();
+        queueFile.close();
+        PRINTOUT(F("Data added to the EnviroDIY queue, "), getQueuedBytes(),
+                 F(" bytes waiting\n"));
+        return true;
+    }
 
-        // Process the HTTP response
-        int responseCode = 0;
-        if (did_respond > 0)
+    // This sends the records waiting in the outbound queue, oldest first, until
+    // the queue is empty, the time or size budget for this connection is used
+    // up, or a post fails.  Records the portal rejects outright are dropped so
+    // they do not block the rest of the queue.  The place reached is saved to
+    // the card once, at the end; if the logger is reset part way through, the
+    // records sent since the last save are sent again.  Returns the number sent.
+    int sendQueueEnviroDIY(void)
+    {
+        if (getQueuedBytes() == 0) return 0;
+        PROFILE_SCOPE(PROFILE_SEND_QUEUE);
+        SdFile queueFile;
+        if (!openLogFile() || !queueFile.open(ENVIRODIY_QUEUE_FILE, O_READ))
+        {
+            PRINTOUT(F("Error: Unable to open the EnviroDIY queue!\n"));
+            return 0;
+        }
+        _queueSize = queueFile.fileSize();
+        uint32_t startCursor = _queueCursor;
+
+        PRINTOUT(F("Sending "), getQueuedBytes(), F(" bytes of queued data to EnviroDIY\n"));
+        // The records are all sent over one connection to the portal, as long
+        // as it stays open
+        _keepAlive = true;
+        uint32_t start = millis();
+        uint32_t bytesSent = 0;
+        int numSent = 0;
+        while (_queueCursor < _queueSize &&
+               millis() - start < (uint32_t)_queueSeconds*1000UL &&
+               bytesSent < _queueBytes)
         {
-            char responseCode_char[4];
-            for (int i = 0; i < 3; i++)
+            // Find the length of the next record, without the line ending
+            queueFile.seekSet(_queueCursor);
+            uint16_t lineLength = 0;
+            uint16_t recordLength = 0;
+            int c;
+            while ((c = queueFile.read()) >= 0 && c != '\n')
             {
-                responseCode_char[i] = response_buffer[i+9];
+                lineLength++;
+                if (c != '\r') recordLength = lineLength;
             }
-            responseCode = atoi(responseCode_char);
-            // modem.dumpBuffer(modem._client);
+            uint32_t nextRecord = queueFile.curPosition();
+
+            if (recordLength > 0)
+            {
+                int responseCode = postQueuedRecord(&queueFile, _queueCursor, recordLength);
+                if (responseCode >= 200 && responseCode < 300) numSent++;
+                else if (isPermanentFailure(responseCode))
+                    PRINTOUT(F("Queued record rejected by EnviroDIY, dropping it\n"));
+                else break;  // Try again next time
+                bytesSent += recordLength;
+            }
+
+            // Move past the record
+            _queueCursor = nextRecord;
         }
-        else responseCode=504;
+        queueFile.close();
+        _keepAlive = false;
+        if (modem._client->connected()) modem.stop();
 
-        PRINTOUT(F(" -- Response Code -- \n"));
-        PRINTOUT(responseCode, F("\n"));
+        // Empty the queue once everything has been sent, or drop the records
+        // sent from the front of the file once they take up too much of it
+        if (_queueCursor >= _queueSize)
+        {
+            sd.remove(ENVIRODIY_QUEUE_FILE);
+            _queueSize = 0;
+            _queueCursor = 0;
+            saveQueueCursor();
+        }
+        else if (_queueCursor >= ENVIRODIY_QUEUE_COMPACT_BYTES) compactQueue();
+        else if (_queueCursor != startCursor) saveQueueCursor();
+        PRINTOUT(numSent, F(" queued records sent to EnviroDIY, "),
+                 getQueuedBytes(), F(" bytes still waiting\n"));
+        return numSent;
+    }
 
-        return responseCode;
+    // This sends the current data to EnviroDIY.  If there are older records
+    // waiting in the queue, or the network is not connected, or the post
+    // fails, the data is added to the queue instead so that records are
+    // always sent oldest first.  Any waiting records are then sent.
+    void sendOrQueueEnviroDIY(bool networkConnected)
+    {
+        bool haveBacklog = getQueuedBytes() > 0;
+        if (networkConnected && !haveBacklog)
+        {
+            int responseCode = postDataEnviroDIY();
+            if ((responseCode >= 200 && responseCode < 300) ||
+                isPermanentFailure(responseCode)) return;
+        }
+        queueDataEnviroDIY();
+        if (networkConnected && haveBacklog) sendQueueEnviroDIY();
     }
 
     // ===================================================================== //
@@ -168,39 +355,51 @@ public:
             // Turn on the LED to show we're taking a reading
             digitalWrite(_ledPin, HIGH);
 
+            // Only use the modem for every batch of readings
+            bool sendBatch = (_numReadings % _batchSize == 0);
+
             // Turn on the modem to let it start searching for the network
-            modem.wake();
+            uint32_t modemStart = millis();
+            if (sendBatch) modem.wake();
 
-            // Wake up all of the sensors
+            // Wake up all of the sensors and update their values, servicing
+            // each sensor as soon as it is ready
             // I'm not doing as part of sleep b/c it may take up to a second or
             // two for them all to wake which throws off the checkInterval()
-            sensorsWake();
-            // Update the values from all attached sensors
-            updateAllSensors();
+            updateAllSensorsScheduled();
             // Immediately put sensors to sleep to save power
             sensorsSleep();
 
-            // Connect to the network
-            if (modem.connectNetwork())
+            if (sendBatch)
             {
-                // Post the data to the WebSDL
-                postDataEnviroDIY();
-
-                // Sync the clock every 288 readings (1/day at 5 min intervals)
-                if (_numReadings % 288 == 0)
+                // Connect to the network
+                bool networkConnected = modem.connectNetwork();
+                // Post the data to the WebSDL, or save it to send later
+                sendOrQueueEnviroDIY(networkConnected);
+                if (networkConnected)
                 {
-                    syncRTClock();
+                    // Sync the clock every 288 readings (1/day at 5 min intervals)
+                    if (_numReadings % 288 < _batchSize)
+                    {
+                        syncRTClock();
+                    }
+
+                    // Disconnect from the network
+                    modem.disconnectNetwork();
                 }
 
-                // Disconnect from the network
-                modem.disconnectNetwork();
+                // Turn the modem off
+                modem.off();
+                // The sensors were updated while the modem was searching
+                _lastModemOnTime = millis() - modemStart;
             }
-
-            // Turn the modem off
-            modem.off();
+            // Save the data to send with the next batch
+            else queueDataEnviroDIY();
 
             // Create a csv data record and save it to the log file
-            logToSD(generateSensorDataCSV());
+            logToSD();
+            // Save the step timings, if profiling
+            writeProfileIfDue();
 
             // Turn off the LED
             digitalWrite(_ledPin, LOW);
@@ -213,11 +412,186 @@ public:
     }
 
 
+protected:
+    // This waits for and reads the response to a request and returns the HTTP
+    // response code.  This is used for all of the data receivers.
+    int getHTTPResponse(bool connected = true)
+    {
+        int responseCode = 0;
+        _lastResponseTime = 0;
+
+        if (connected)
+        {
+            modem._client->flush();  // wait for sending to finish
+
+            // Read the response as it arrives, only until the response code is known
+            HTTPResponseParser response;
+            responseCode = response.readStatus(modem._client, HTTP_STATUS_TIMEOUT_MS);
+            _lastResponseTime = response.getResponseTime();
+
+            // Close the TCP/IP connection as soon as the response code is read
+            // We don't need anything else and stoping here should save data use.
+            // When sending a batch, the rest of the response has to be read
+            // instead so the next record can follow on the same connection.
+            if (!_keepAlive || responseCode == 0 ||
+                !response.readToEnd(modem._client, HTTP_DRAIN_TIMEOUT_MS) ||
+                !response.canReuseConnection())
+                modem.stop();
+        }
+
+        // Process the HTTP response
+        if (responseCode == 0) responseCode = 504;
+
+        PRINTOUT(F(" -- Response Code -- \n"));
+        PRINTOUT(responseCode, F("\n"));
+        if (_lastResponseTime > 0) PRINTOUT(F(" -- Response Time -- \n"), _lastResponseTime, F(" ms\n"));
+
+        return responseCode;
+    }
+
+    // This posts one record from the queue file, streaming it straight from
+    // the SD card to the modem.  While sending a batch, the connection left
+    // open by the last record is used if the server kept it open.
+    int postQueuedRecord(SdFile *queueFile, uint32_t position, uint16_t length)
+    {
+        if(!(_keepAlive && modem._client->connected()) &&
+           !modem.connect("data.envirodiy.org", 80))
+        {
+            PRINTOUT(F("\n -- Unable to Establish Connection to EnviroDIY Data Portal -- \n"));
+            return getHTTPResponse(false);
+        }
+        PRINTOUT(F("\n \\/---- Posting Queued Record to EnviroDIY ----\\/ \n"));
+
+        modem.dumpBuffer(modem._client);
+        streamEnviroDIYHeaders(modem._client, length);
+        queueFile->seekSet(position);
+        uint8_t chunk[32];
+        while (length > 0)
+        {
+            int numRead = queueFile->read(chunk, min(length, (uint16_t)sizeof(chunk)));
+            if (numRead <= 0) break;
+            modem._client->write(chunk, numRead);
+            length -= numRead;
+        }
+        return getHTTPResponse();
+    }
+
+    // Requests rejected with these codes will never succeed, so there is no
+    // point in sending them again
+    static bool isPermanentFailure(int responseCode)
+    {
+        return responseCode >= 400 && responseCode < 500 &&
+               responseCode != 408 && responseCode != 429;
+    }
+
+    // This reads the size of the queue and the position of the first unsent
+    // record from the SD card the first time the queue is used
+    void loadQueue(void)
+    {
+        if (_queueLoaded) return;
+        _queueSize = 0;
+        _queueCursor = 0;
+        if (!openLogFile()) return;
+        _queueLoaded = true;
+
+        // Finish a compaction of the queue that was cut off by a reset.  The
+        // new file is only complete once the old one has been removed.
+        if (sd.exists(ENVIRODIY_QUEUE_TEMP_FILE))
+        {
+            if (sd.exists(ENVIRODIY_QUEUE_FILE)) sd.remove(ENVIRODIY_QUEUE_TEMP_FILE);
+            else
+            {
+                sd.rename(ENVIRODIY_QUEUE_TEMP_FILE, ENVIRODIY_QUEUE_FILE);
+                saveQueueCursor();
+            }
+        }
+
+        SdFile file;
+        if (file.open(ENVIRODIY_QUEUE_FILE, O_READ))
+        {
+            _queueSize = file.fileSize();
+            file.close();
+        }
+        if (file.open(ENVIRODIY_CURSOR_FILE, O_READ))
+        {
+            file.read(&_queueCursor, 4);
+            file.close();
+        }
+        // Start over if the queue file was removed
+        if (_queueCursor > _queueSize) _queueCursor = _queueSize;
+    }
+
+    // This saves the position of the first unsent record
+    void saveQueueCursor(void)
+    {
+        SdFile file;
+        if (file.open(ENVIRODIY_CURSOR_FILE, O_CREAT | O_WRITE))
+        {
+            file.write(&_queueCursor, 4);
+            file.close();
+        }
+    }
+
+    // This copies the records not yet sent to a new queue file, which then
+    // replaces the old one.  The old file is removed and the cursor set back
+    // to the start before the new file is renamed, so after a reset at any
+    // point there is either the old queue with its cursor or a complete new
+    // file for loadQueue() to pick up.
+    void compactQueue(void)
+    {
+        PRINTOUT(F("Removing "), _queueCursor, F(" bytes of sent records from the EnviroDIY queue\n"));
+        SdFile oldFile;
+        SdFile newFile;
+        if (!oldFile.open(ENVIRODIY_QUEUE_FILE, O_READ)) return;
+        if (!newFile.open(ENVIRODIY_QUEUE_TEMP_FILE, O_CREAT | O_WRITE | O_TRUNC))
+        {
+            oldFile.close();
+            saveQueueCursor();
+            return;
+        }
+        oldFile.seekSet(_queueCursor);
+        uint8_t chunk[32];
+        int numRead;
+        bool success = true;
+        while (success && (numRead = oldFile.read(chunk, sizeof(chunk))) > 0)
+            success = (newFile.write(chunk, numRead) == (size_t)numRead);
+        success &= newFile.sync();
+        uint32_t newSize = newFile.fileSize();
+        oldFile.close();
+        newFile.close();
+        if (!success)
+        {
+            // Keep using the old file, from where sending stopped
+            sd.remove(ENVIRODIY_QUEUE_TEMP_FILE);
+            saveQueueCursor();
+            return;
+        }
+
+        sd.remove(ENVIRODIY_QUEUE_FILE);
+        _queueSize = newSize;
+        _queueCursor = 0;
+        saveQueueCursor();
+        // If this fails, loadQueue() tries again before the queue is next used
+        if (!sd.rename(ENVIRODIY_QUEUE_TEMP_FILE, ENVIRODIY_QUEUE_FILE)) _queueLoaded = false;
+    }
+
 private:
     // Tokens and UUID's for EnviroDIY
     const char *_registrationToken;
     const char *_samplingFeature;
     const char **_UUIDs;
+
+    uint32_t _lastResponseTime;
+    uint32_t _lastModemOnTime;
+
+    // The outbound queue
+    uint8_t _batchSize;
+    bool _keepAlive;
+    bool _queueLoaded;
+    uint32_t _queueSize;
+    uint32_t _queueCursor;
+    uint16_t _queueSeconds;
+    uint32_t _queueBytes;
 };
 
 #endif
@@ -10,21 +10,31 @@
  * The output from the HRXL-MaxSonar-WRL sonar is the range in mm.
  *
  * Warm up time to completion of header:  160ms
+ *
+ * The sonar sends each range as a frame "Rxxxx<CR>".  The frames are read from
+ * the stream's buffer as they arrive, a character at a time, so the header
+ * lines are skipped without waiting for them and nothing blocks on a timeout.
  */
 
 #include "MaxBotixSonar.h"
 
-MaxBotixSonar::MaxBotixSonar(int powerPin, Stream* stream, int triggerPin)
+MaxBotixSonar::MaxBotixSonar(int powerPin, Stream* stream, int triggerPin, int numReadings)
 : Sensor(powerPin, -1, F("MaxBotixMaxSonar"), HRXL_NUM_MEASUREMENTS, HRXL_WARM_UP)
 {
     _triggerPin = triggerPin;
     _stream = stream;
+    _numReadings = constrain(numReadings, 1, HRXL_MAX_READINGS);
+    _numRanges = 0;
+    _powerDraw_mA = HRXL_POWER_DRAW;
 }
-MaxBotixSonar::MaxBotixSonar(int powerPin, Stream& stream, int triggerPin)
+MaxBotixSonar::MaxBotixSonar(int powerPin, Stream& stream, int triggerPin, int numReadings)
 : Sensor(powerPin, -1, F("MaxBotixMaxSonar"), HRXL_NUM_MEASUREMENTS, HRXL_WARM_UP)
 {
     _triggerPin = triggerPin;
     _stream = &stream;
+    _numReadings = constrain(numReadings, 1, HRXL_MAX_READINGS);
+    _numRanges = 0;
+    _powerDraw_mA = HRXL_POWER_DRAW;
 }
 
 // unfortunately, we really cannot know where the stream is attached.
@@ -48,18 +58,22 @@ SENSOR_STATUS MaxBotixSonar::setup(void)
 
 bool MaxBotixSonar::update(void)
 {
-    // Check if the power is on, turn it on if not
-    bool wasOn = checkPowerOn();
-    if(!wasOn){powerUp();}
-    // Wait until the sensor is warmed up
-    waitForWarmUp();
+    return runMeasurement();
+}
 
-    // Set the stream timeout;
-    // Even the slowest sensors should respond at a rate of 6Hz (166ms).
-    _stream->setTimeout(180);
+
+// This starts looking for ranges
+bool MaxBotixSonar::startMeasurement(void)
+{
+    // Check if the power is on, turn it on if not
+    if(!checkPowerOn()){powerUp();}
+    // Don't wait for the warm-up here, so the caller can do other work
+    if (!isWarmedUp()) return false;
 
     // Clear values before starting loop
     clearValues();
+    _numRanges = 0;
+    _parser.reset();
 
     // NOTE: After the power is turned on to the MaxBotix, it sends several lines
     // of header to the serial pin, beginning at ~65ms and finising at ~160ms.
@@ -70,60 +84,100 @@ bool MaxBotixSonar::update(void)
     // MaxBotix Inc.
     // RoHS 1.8b090  0713
     // TempI
+    // None of these are range frames, so the parser skips them.
 
-    DBGM(F("Parsing Header Lines\n"));
-    for(int i=0; i < 6; i++);
-    {
-        String headerLine = _stream->readStringUntil('\r');
-        DBGM(headerLine, F("\n"));
-    }
-
-    bool stringComplete = false;
-    int rangeAttempts = 0;
-    int result = 0;
+    // Throw away any old ranges a free-running sonar has already sent
+    while (_stream->available() > 0) _stream->read();
 
     DBGM(F("Beginning detection for Sonar\n"));
-    while (stringComplete == false && rangeAttempts < 50)
+    _millisMeasurementRequested = millis();
+    trigger();
+    return true;
+}
+
+
+// The measurement is finished once enough good ranges have come in or the
+// time budget has run out
+bool MaxBotixSonar::isMeasurementReady(void)
+{
+    readFrames();
+    if (_numRanges >= _numReadings) return true;
+    return (millis() - _millisMeasurementRequested) >= HRXL_TIME_BUDGET;
+}
+
+
+// This reports the median of the good ranges
+SENSOR_STATUS MaxBotixSonar::collectMeasurement(void)
+{
+    readFrames();
+    _millisMeasurementRequested = 0;
+
+    SENSOR_STATUS stat = SENSOR_READY;
+    if (_numRanges == 0)
     {
-        if(_triggerPin != -1)
+        DBGM(F("No good ranges found!\n"));
+        sensorValues[HRXL_VAR_NUM] = -9999;
+        stat = SENSOR_ERROR;
+    }
+    else
+    {
+        // Sort the ranges to find the median
+        for (uint8_t i = 1; i < _numRanges; i++)
         {
-            DBGM(F("Triggering Sonar\n"));
-            digitalWrite(_triggerPin, HIGH);
-            delay(1);
-            digitalWrite(_triggerPin, LOW);
-            delay(160);  // Published return time is 158ms
+            int16_t range = _ranges[i];
+            int8_t j = i - 1;
+            while (j >= 0 && _ranges[j] > range)
+            {
+                _ranges[j + 1] = _ranges[j];
+                j--;
+            }
+            _ranges[j + 1] = range;
         }
+        uint8_t middle = _numRanges/2;
+        if (_numRanges % 2 == 1) sensorValues[HRXL_VAR_NUM] = _ranges[middle];
+        else sensorValues[HRXL_VAR_NUM] = (_ranges[middle - 1] + _ranges[middle])/2.0;
+        DBGM(F("Median of "), _numRanges, F(" ranges: "), sensorValues[HRXL_VAR_NUM], F("\n"));
+    }
 
-        result = _stream->parseInt();
-        _stream->read();  // To throw away the carriage return
+    // Update the registered variables with the new values
+    notifyVariables();
+
+    return stat;
+}
+
+
+// Parse whatever has arrived, without waiting for anything more
+void MaxBotixSonar::readFrames(void)
+{
+    while (_stream->available() > 0 && _numRanges < _numReadings)
+    {
+        int16_t result = _parser.parse(_stream->read());
+        if (result < 0) continue;
         DBGM(result, F("\n"));
-        rangeAttempts++;
 
         // If it cannot obtain a result , the sonar is supposed to send a value
         // just above it's max range.  For 10m models, this is 9999, for 5m models
         // it's 4999.  The sonar might also send readings of 300 or 500 (the
         //  blanking distance) if there are too many acoustic echos.
-        // If the result becomes garbled or the sonar is disconnected, the parseInt function returns 0.
         if (result <= 300 || result == 500 || result == 4999 || result == 9999)
         {
-            DBGM(F("Bad or Suspicious Result, Retry Attempt #"), rangeAttempts, F("\n"));
+            DBGM(F("Bad or Suspicious Result\n"));
         }
-        else
-        {
-            DBGM(F("Good result found\n"));
-            stringComplete = true;  // Set completion of read to true
-        }
-    }
+        else _ranges[_numRanges++] = result;
 
-    sensorValues[HRXL_VAR_NUM] = result;
-    DBGM(sensorValues[HRXL_VAR_NUM], F("\n"));
-
-    // Turn the power back off it it had been turned on
-    if(!wasOn){powerDown();}
+        // Ask for the next range
+        if (_numRanges < _numReadings) trigger();
+    }
+}
 
-    // Update the registered variables with the new values
-    notifyVariables();
 
-    // Return true when finished
-    return true;
+void MaxBotixSonar::trigger(void)
+{
+    if(_triggerPin != -1)
+    {
+        DBGM(F("Triggering Sonar\n"));
+        digitalWrite(_triggerPin, HIGH);
+        delay(1);
+        digitalWrite(_triggerPin, LOW);
+    }
 }
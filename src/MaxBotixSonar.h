@@ -10,6 +10,10 @@
  * The output from the HRXL-MaxSonar-WRL sonar is the range in mm.
  *
  * Warm up time to completion of header:  160ms
+ *
+ * The sonar sends each range as a frame "Rxxxx<CR>".  The frames are read from
+ * the stream's buffer as they arrive, a character at a time, so the header
+ * lines are skipped without waiting for them and nothing blocks on a timeout.
  */
 
 #ifndef MaxBotixSonar_h
@@ -23,15 +27,60 @@
 
 #define HRXL_NUM_MEASUREMENTS 1
 #define HRXL_WARM_UP 160
+#define HRXL_POWER_DRAW 3.1  // Average current in mA
 #define HRXL_RESOLUTION 0
 #define HRXL_VAR_NUM 0
+// The most ranges that can be taken for the median
+#define HRXL_MAX_READINGS 9
+// How long to keep trying to get good ranges; the slowest sonars send about 6
+// ranges a second, so this allows for some bad ones
+#define HRXL_TIME_BUDGET 3000L
+
+// A parser for the range frames from the sonar, fed one character at a time
+class MaxBotixFrameParser
+{
+public:
+    MaxBotixFrameParser(void){reset();}
+    void reset(void)
+    {
+        _numDigits = -1;
+        _range = 0;
+    }
+
+    // This returns the range once a whole frame has come in, or -1.  Anything
+    // else (ie, the header lines) is ignored.
+    int16_t parse(char c)
+    {
+        if (c == 'R')
+        {
+            _numDigits = 0;
+            _range = 0;
+            return -1;
+        }
+        if (_numDigits < 0) return -1;
+        if (c >= '0' && c <= '9' && _numDigits < 4)
+        {
+            _range = _range*10 + (c - '0');
+            _numDigits++;
+            return -1;
+        }
+        int16_t range = -1;
+        if (c == '\r' && _numDigits == 4) range = _range;
+        _numDigits = -1;
+        return range;
+    }
+
+private:
+    int8_t _numDigits;
+    int16_t _range;
+};
 
 // The main class for the MaxBotix Sonar
 class MaxBotixSonar : public Sensor
 {
 public:
-    MaxBotixSonar(int powerPin, Stream* stream, int triggerPin = -1);
-    MaxBotixSonar(int powerPin, Stream& stream, int triggerPin = -1);
+    MaxBotixSonar(int powerPin, Stream* stream, int triggerPin = -1, int numReadings = 1);
+    MaxBotixSonar(int powerPin, Stream& stream, int triggerPin = -1, int numReadings = 1);
 
     String getSensorLocation(void) override;
 
@@ -39,9 +88,21 @@ public:
 
     bool update(void) override;
 
+    bool startMeasurement(void) override;
+    bool isMeasurementReady(void) override;
+    SENSOR_STATUS collectMeasurement(void) override;
+
 private:
     int _triggerPin;
     Stream* _stream;
+    int _numReadings;
+    MaxBotixFrameParser _parser;
+    int16_t _ranges[HRXL_MAX_READINGS];
+    uint8_t _numRanges;
+    // Reads any frames that have come in
+    void readFrames(void);
+    // Asks the sonar for a range, if the trigger is connected
+    void trigger(void);
 };
 
 
@@ -15,6 +15,8 @@
  *
  * Time to take reading at 12-bit: 750ms (likely ready to begin conversion
  * much before that, but I can't find a number.)
+ * Each bit less halves the time: 375ms at 11-bit, 188ms at 10-bit and 94ms
+ * at 9-bit.
  */
 
 #include "MaximDS18.h"
@@ -22,20 +24,35 @@
 
 // The constructor - if the hex address is known - also need the power pin and the data pin
 MaximDS18::MaximDS18(DeviceAddress OneWireAddress, int powerPin, int dataPin)
-  : Sensor(powerPin, dataPin, F("MaximDS18"), DS18_NUM_MEASUREMENTS, DS18_WARM_UP)
-    // oneWire(dataPin), tempSensors(&oneWire)
+  : SharedBusSensor(powerPin, dataPin, F("MaximDS18"), DS18_NUM_MEASUREMENTS,
+                    DS18_WARM_UP, DS18_BUS_TIMEOUT)
 {
     for (int i = 0; i < 8; i++) _OneWireAddress[i] = OneWireAddress[i];
     // _OneWireAddress = OneWireAddress;
     _addressKnown = true;
+    _rangeAttempts = 0;
+    _resolution = DS18_DEFAULT_RESOLUTION;
+    _powerDraw_mA = DS18_POWER_DRAW;
+    _bus = NULL;
 }
 // The constructor - if the hex address is NOT known - only need the power pin and the data pin
 // Can only use this if there is only a single sensor on the pin
 MaximDS18::MaximDS18(int powerPin, int dataPin)
-  : Sensor(powerPin, dataPin, F("MaximDS18"), DS18_NUM_MEASUREMENTS, DS18_WARM_UP)
-    // oneWire(dataPin), tempSensors(&oneWire)
+  : SharedBusSensor(powerPin, dataPin, F("MaximDS18"), DS18_NUM_MEASUREMENTS,
+                    DS18_WARM_UP, DS18_BUS_TIMEOUT)
 {
     _addressKnown = false;
+    _rangeAttempts = 0;
+    _resolution = DS18_DEFAULT_RESOLUTION;
+    _powerDraw_mA = DS18_POWER_DRAW;
+    _bus = NULL;
+}
+
+// The OneWire data line this sensor is attached to
+OneWireBus *MaximDS18::getBus(void)
+{
+    if (_bus == NULL) _bus = OneWireBus::getBus(_dataPin);
+    return _bus;
 }
 
 // Turns the address into a printable string
@@ -71,38 +88,29 @@ SENSOR_STATUS MaximDS18::getStatus(void)
     // Wait until the sensor is warmed up
     waitForWarmUp();
 
-    OneWire oneWire(_dataPin);
-    DallasTemperature tempSensors(&oneWire);
-    tempSensors.begin();
+    DallasTemperature *tempSensors = getBus()->begin();
 
+    SENSOR_STATUS stat = SENSOR_READY;
     // Make sure the address is valid
-    if (!tempSensors.validAddress(_OneWireAddress))
+    if (!tempSensors->validAddress(_OneWireAddress))
     {
         DBGM(F("This sensor address is not valid: "));
         DBGM(getAddressString(_OneWireAddress), F("\n"));
-        return SENSOR_ERROR;
+        stat = SENSOR_ERROR;
     }
 
     // Make sure the sensor is connected
-    if (!tempSensors.isConnected(_OneWireAddress))
+    else if (!tempSensors->isConnected(_OneWireAddress))
     {
         DBGM(F("This sensor is not currently connected: "));
         DBGM(getAddressString(_OneWireAddress), F("\n"));
-        return SENSOR_ERROR;
-    }
-
-    // Set resolution to 12 bit
-    if (!tempSensors.setResolution(_OneWireAddress, 12))
-    {
-        DBGM(F("Unable to set the resolution of this sensor: "));
-        DBGM(getAddressString(_OneWireAddress), F("\n"));
-        return SENSOR_ERROR;
+        stat = SENSOR_ERROR;
     }
 
     // Turn the power back off it it had been turned on
     if(!wasOn){powerDown();}
 
-    return SENSOR_READY;
+    return stat;
 }
 
 // The function to set up connection to a sensor.
@@ -118,10 +126,10 @@ SENSOR_STATUS MaximDS18::setup(void)
     // Wait until the sensor is warmed up
     waitForWarmUp();
 
-    // Start up the maxim sensor library
-    OneWire oneWire(_dataPin);
-    DallasTemperature tempSensors(&oneWire);
-    tempSensors.begin();
+    // Search the bus for sensors again, so any plugged in since the last
+    // search are found and the parasite power mode is checked
+    getBus()->reset();
+    getBus()->begin();
 
     // Find the address if it's not known
     if (!_addressKnown)
@@ -129,7 +137,9 @@ SENSOR_STATUS MaximDS18::setup(void)
         DBGM(F("Probe address is not known!\n"));
 
         DeviceAddress address;
-        if (oneWire.search(address))
+        OneWire *oneWire = getBus()->getOneWire();
+        oneWire->reset_search();
+        if (oneWire->search(address))
         {
             DBGM(F("Sensor found at "), getAddressString(address), F("\n"));
             for (int i = 0; i < 8; i++) _OneWireAddress[i] = address[i];
@@ -146,6 +156,21 @@ SENSOR_STATUS MaximDS18::setup(void)
 
     SENSOR_STATUS stat = getStatus();
 
+    // Set the resolution.  DallasTemperature also copies it to the sensor's
+    // EEPROM so it is kept when the power is turned off, so this is only
+    // written if it has changed.
+    DallasTemperature *tempSensors = getBus()->begin();
+    if (stat == SENSOR_READY && tempSensors->getResolution(_OneWireAddress) != _resolution)
+    {
+        DBGM(F("Setting resolution to "), _resolution, F(" bits\n"));
+        if (!tempSensors->setResolution(_OneWireAddress, _resolution))
+        {
+            DBGM(F("Unable to set the resolution of this sensor: "));
+            DBGM(getAddressString(_OneWireAddress), F("\n"));
+            stat = SENSOR_ERROR;
+        }
+    }
+
     // Turn the power back off it it had been turned on
     if(!wasOn){powerDown();}
 
@@ -153,60 +178,105 @@ SENSOR_STATUS MaximDS18::setup(void)
 }
 
 
-// Uses OneWire/Dallas Temp and the specified sensor address to get data from DS18
-bool MaximDS18::update()
+// This starts the first temperature conversion
+bool MaximDS18::startMeasurement(void)
 {
     // Check if the power is on, turn it on if not
-    bool wasOn = checkPowerOn();
-    if(!wasOn){powerUp();}
-    // Wait until the sensor is warmed up
-    waitForWarmUp();
+    if(!checkPowerOn()){powerUp();}
+    // Don't wait for the warm-up here, so the caller can do other work
+    if (!isWarmedUp()) return false;
 
     // Clear values before starting loop
     clearValues();
+    _rangeAttempts = 0;
 
-    OneWire oneWire(_dataPin);
-    DallasTemperature tempSensors(&oneWire);
-    tempSensors.begin();
+    DBGM(F("Beginning detection for Temperature\n"));
+    return requestConversion();
+}
 
-    bool goodTemp = false;
-    int rangeAttempts = 0;
-    float result = 85;  // This is a "bad" result returned from a DS18 sensor
 
-    DBGM(F("Beginning detection for Temperature\n"));
-    while (goodTemp == false && rangeAttempts < 50)
+// A helper to start a conversion on every sensor on the bus, returning
+// immediately.  If one is already running, this sensor's value will come
+// from that one.  A retry always starts a new conversion, on this sensor only,
+// because joining the one that gave the bad result would read it again.
+bool MaximDS18::requestConversion(bool retry)
+{
+    if (retry && getBus()->startConversion(_OneWireAddress))
     {
-        // Send the command to get temperatures
-        DBGM(F("Asking sensor to take a measurement\n"));
-        tempSensors.requestTemperaturesByAddress(_OneWireAddress);
-
-        DBGM(F("Requesting temperature result\n"));
-        result = tempSensors.getTempC(_OneWireAddress);
-        DBGM(F("Received "), result, F("°C\n"));
-        rangeAttempts++;
-
-        // If a DS18 cannot get a goot measurement, it returns 85
-        // If the sensor is not properly connected, it returns -127
-        if (result == 85 || result == -127)
-        {
-            DBGM(F("Bad or Suspicious Result, Retry Attempt #"), rangeAttempts, F("\n"));
-        }
-        else
-        {
-            DBGM(F("Good result found\n"));
-            goodTemp = true;  // Set completion of read to true
-        }
+        _millisMeasurementRequested = millis();
+        return true;
+    }
+    else if (!retry && getBus()->startConversion(getConversionTime(), _millisPowerOn))
+    {
+        _millisMeasurementRequested = getBus()->getConversionStart();
+        return true;
+    }
+    else
+    {
+        DBGM(F("Unable to start a measurement on "));
+        DBGM(getAddressString(_OneWireAddress), F("\n"));
+        _millisMeasurementRequested = 0;
+        return false;
+    }
+}
+
+
+// The conversion is finished after the conversion time has passed
+bool MaximDS18::isMeasurementReady(void)
+{
+    return (millis() - _millisMeasurementRequested) >= getConversionTime();
+}
+
+
+void MaximDS18::setResolution(uint8_t resolution)
+{
+    _resolution = constrain(resolution, 9, 12);
+}
+
+
+// The conversion time halves with each bit of resolution less than 12
+uint32_t MaximDS18::getConversionTime(void)
+{
+    switch (_resolution)
+    {
+        case 9: return 94;
+        case 10: return 188;
+        case 11: return 375;
+        default: return DS18_MEASUREMENT_TIME;
     }
+}
+
+
+uint32_t MaximDS18::getMillisMeasurementReady(void)
+{
+    return _millisMeasurementRequested + getConversionTime();
+}
+
+
+// This reads the converted temperature, re-trying a bad result up to 50 times
+SENSOR_STATUS MaximDS18::collectMeasurement(void)
+{
+    DBGM(F("Requesting temperature result\n"));
+    // This only reads the sensor's scratchpad; the bus is not searched again
+    float result = getBus()->begin()->getTempC(_OneWireAddress);
+    DBGM(F("Received "), result, F("°C\n"));
+    _rangeAttempts++;
+
+    // If a DS18 cannot get a goot measurement, it returns 85
+    // If the sensor is not properly connected, it returns -127
+    if (result == 85 || result == -127)
+    {
+        DBGM(F("Bad or Suspicious Result, Retry Attempt #"), _rangeAttempts, F("\n"));
+        if (_rangeAttempts < 50 && requestConversion(true)) return SENSOR_WAITING;
+    }
+    else DBGM(F("Good result found\n"));
+    _millisMeasurementRequested = 0;
 
     DBGM(F("Sending value of "), result, F(" °C to the sensorValues array\n"));
     sensorValues[DS18_TEMP_VAR_NUM] = result;
 
-    // Turn the power back off it it had been turned on
-    if(!wasOn){powerDown();}
-
     // Update the registered variables with the new values
     notifyVariables();
 
-    // Return true when finished
-    return true;
+    return SENSOR_READY;
 }
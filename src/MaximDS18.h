@@ -15,12 +15,14 @@
  *
  * Time to take reading at 12-bit: 750ms (likely ready to begin conversion
  * much before that, but I can't find a number.)
+ * Each bit less halves the time: 375ms at 11-bit, 188ms at 10-bit and 94ms
+ * at 9-bit.
 */
 
 #ifndef MaximDS18_h
 #define MaximDS18_h
 
-#include "SensorBase.h"
+#include "SharedBusSensor.h"
 #include "VariableBase.h"
 
 // #define MODULES_DBG Serial
@@ -28,14 +30,22 @@
 
 #include <OneWire.h>
 #include <DallasTemperature.h>
+#include "OneWireBus.h"
 
 #define DS18_NUM_MEASUREMENTS 1
 #define DS18_WARM_UP 750
+#define DS18_POWER_DRAW 1.5  // Current while converting in mA
+#define DS18_MEASUREMENT_TIME 750
+#define DS18_DEFAULT_RESOLUTION 12
 #define DS18_TEMP_VAR_NUM 0
 #define DS18_TEMP_RESOLUTION 4
+// The longest a measurement of all of the sensors on one data pin may take,
+// including re-tries of bad results
+#define DS18_BUS_TIMEOUT 60000L
 
 // The main class for the DS18
-class MaximDS18 : public Sensor
+// All of the DS18's on one data pin are measured together (see SharedBusSensor.h)
+class MaximDS18 : public SharedBusSensor<MaximDS18>
 {
 public:
     MaximDS18(DeviceAddress OneWireAddress, int powerPin, int dataPin);
@@ -45,15 +55,32 @@ public:
     String getSensorLocation(void) override;
     SENSOR_STATUS getStatus(void) override;
 
-    bool update(void) override;
+    // This sets the resolution (9-12 bits) used from the next setup() on.
+    // Lower resolutions convert faster: 12 bits (0.0625°C) takes 750ms and
+    // each bit less halves that, down to 94ms at 9 bits (0.5°C).
+    void setResolution(uint8_t resolution);
+    uint8_t getResolution(void){return _resolution;}
+    // This returns the time a conversion takes at the sensor's resolution
+    uint32_t getConversionTime(void);
+    // This returns the millis() when the started conversion will be finished,
+    // so other work can be done until then
+    uint32_t getMillisMeasurementReady(void);
+
+    bool startMeasurement(void) override;
+    bool isMeasurementReady(void) override;
+    SENSOR_STATUS collectMeasurement(void) override;
 
 private:
     DeviceAddress _OneWireAddress;
     bool _addressKnown;
-    // Setup a oneWire instance to communicate with any OneWire devices (not just Maxim/Dallas temperature ICs)
-    // OneWire oneWire;
-    // Pass our oneWire reference to Dallas Temperature.
-    // DallasTemperature tempSensors;
+    int _rangeAttempts;
+    uint8_t _resolution;
+    // Asks the sensors on the bus to begin a temperature conversion without
+    // waiting for it, or only this sensor to begin a new one if retrying
+    bool requestConversion(bool retry = false);
+    // The OneWire data line shared with the other sensors on the pin
+    OneWireBus *getBus(void);
+    OneWireBus *_bus;
     // Turns the address into a printable string
     String getAddressString(DeviceAddress OneWireAddress);
 };
@@ -15,6 +15,7 @@
 #include "ModemOnOff.h"
 #include "SensorBase.h"
 #include "VariableBase.h"
+#include "LogProfiler.h"
 
 #if defined(TINY_GSM_MODEM_SIM800) || defined(TINY_GSM_MODEM_SIM808) || \
     defined(TINY_GSM_MODEM_SIM868) || defined(TINY_GSM_MODEM_SIM900) || \
@@ -94,6 +95,7 @@ public:
 
     virtual bool off(void)
     {
+        PROFILE_SCOPE(PROFILE_MODEM_OFF);
         bool retVal = true;
          // Wait for any sending to complete
         _client->flush();
@@ -107,6 +109,7 @@ public:
 
     virtual bool wake(void) override
     {
+        PROFILE_SCOPE(PROFILE_MODEM_WAKE);
         // Check if the modem is on; turn it on if not
         if(!modemOnOff->isOn()) return modemOnOff->on();
         else return true;
@@ -228,6 +231,7 @@ public:
 
     bool connectNetwork(void)
     {
+        PROFILE_SCOPE(PROFILE_MODEM_CONNECT);
         bool retVal = false;
 
         // Check if the modem is on; turn it on if not
@@ -290,6 +294,7 @@ public:
 
     void disconnectNetwork(void)
     {
+        PROFILE_SCOPE(PROFILE_MODEM_DISCONNECT);
         DBG(F("Disconnecting from network"));
     #if defined(TINY_GSM_MODEM_HAS_GPRS)
         _modem->gprsDisconnect();
@@ -0,0 +1,99 @@
+/*
+ *OneWireBus.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for a single OneWire data line shared by all of the Maxim DS18
+ *sensors attached to the same pin.
+ *It is dependent on Dallas Temperature library, which itself is dependent on
+ *the OneWire library.
+*/
+
+#include "OneWireBus.h"
+
+// The list of buses
+OneWireBus *OneWireBus::_firstBus = NULL;
+
+
+OneWireBus::OneWireBus(int dataPin) : _oneWire(dataPin), _sensors(&_oneWire)
+{
+    _dataPin = dataPin;
+    _begun = false;
+    _converting = false;
+    _millisConversionStarted = 0;
+    _conversionTime_ms = 0;
+    _nextBus = NULL;
+}
+
+
+// Find the bus for the pin, or create one if this is the first sensor on it
+OneWireBus *OneWireBus::getBus(int dataPin)
+{
+    for (OneWireBus *bus = _firstBus; bus != NULL; bus = bus->_nextBus)
+    {
+        if (bus->_dataPin == dataPin) return bus;
+    }
+    OneWireBus *bus = new OneWireBus(dataPin);
+    bus->_nextBus = _firstBus;
+    _firstBus = bus;
+    return bus;
+}
+
+
+// Search the bus, if it hasn't been searched yet
+DallasTemperature *OneWireBus::begin(void)
+{
+    if (!_begun)
+    {
+        DBGM(F("Searching OneWire bus on pin "), _dataPin, F("\n"));
+        _sensors.begin();
+        // Don't block for conversions, the sensors track the time
+        _sensors.setWaitForConversion(false);
+        DBGM(_sensors.getDeviceCount(), F(" devices found\n"));
+        _begun = true;
+    }
+    return &_sensors;
+}
+
+
+// Broadcast a temperature conversion to every sensor on the bus
+bool OneWireBus::startConversion(uint32_t conversionTime_ms, uint32_t millisPowerOn)
+{
+    // Join a conversion which is still running, if the sensor had power for it
+    if (_converting && millis() - _millisConversionStarted < _conversionTime_ms
+        && (int32_t)(_millisConversionStarted - millisPowerOn) >= 0)
+    {
+        DBGM(F("Conversion already running on pin "), _dataPin, F("\n"));
+        // Sensors at a higher resolution take longer to finish
+        if (conversionTime_ms > _conversionTime_ms) _conversionTime_ms = conversionTime_ms;
+        return true;
+    }
+
+    DallasTemperature *sensors = begin();
+    DBGM(F("Asking all sensors on pin "), _dataPin, F(" to take a measurement\n"));
+    if (!_oneWire.reset())
+    {
+        DBGM(F("No sensors answered on pin "), _dataPin, F("\n"));
+        _converting = false;
+        return false;
+    }
+    _oneWire.skip();
+    // In parasite power mode, the data line must be held high to power the conversion
+    _oneWire.write(ONEWIRE_CONVERT_T, sensors->isParasitePowerMode());
+    _millisConversionStarted = millis();
+    _conversionTime_ms = conversionTime_ms;
+    _converting = true;
+    return true;
+}
+
+
+// Start a new conversion on a single sensor
+bool OneWireBus::startConversion(const uint8_t *address)
+{
+    DallasTemperature *sensors = begin();
+    if (!_oneWire.reset()) return false;
+    _oneWire.select(address);
+    _oneWire.write(ONEWIRE_CONVERT_T, sensors->isParasitePowerMode());
+    return true;
+}
@@ -0,0 +1,74 @@
+/*
+ *OneWireBus.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for a single OneWire data line shared by all of the Maxim DS18
+ *sensors attached to the same pin.  The bus is searched when each sensor is
+ *set up, instead of before every command.  All of the sensors on the bus are
+ *told to convert a temperature at once with a single broadcast (Skip ROM,
+ *Convert T), so they share one conversion wait, and then each sensor's result
+ *is read from its scratchpad by its address.
+ *It is dependent on Dallas Temperature library, which itself is dependent on
+ *the OneWire library.
+*/
+
+#ifndef OneWireBus_h
+#define OneWireBus_h
+
+#include <Arduino.h>
+
+// #define MODULES_DBG Serial
+#include "ModSensorDebugger.h"
+
+#include <OneWire.h>
+#include <DallasTemperature.h>
+
+// The OneWire command to start a temperature conversion (Convert T)
+#define ONEWIRE_CONVERT_T 0x44
+
+class OneWireBus
+{
+public:
+    // This returns the bus on the given data pin, creating it the first time
+    static OneWireBus *getBus(int dataPin);
+
+    // This searches the bus for sensors the first time it is called and
+    // returns the DallasTemperature object for the bus
+    DallasTemperature *begin(void);
+    // This makes the next call to begin() search the bus again
+    void reset(void){_begun = false;}
+    OneWire *getOneWire(void){return &_oneWire;}
+
+    // This tells every sensor on the bus to start converting a temperature and
+    // returns immediately.  A conversion that is still running is used instead
+    // if it was started after the sensor asking was powered on (the millis()
+    // given).  Returns false if no sensor answered.
+    bool startConversion(uint32_t conversionTime_ms, uint32_t millisPowerOn);
+    // This tells only the sensor at the address to start a new conversion, ie
+    // to try again after a bad result, without joining one that is running or
+    // starting the other sensors over.  Returns false if no sensor answered.
+    bool startConversion(const uint8_t *address);
+    // This returns the millis() when the last conversion of the whole bus was
+    // started
+    uint32_t getConversionStart(void){return _millisConversionStarted;}
+
+    int getDataPin(void){return _dataPin;}
+
+private:
+    OneWireBus(int dataPin);
+
+    OneWire _oneWire;
+    DallasTemperature _sensors;
+    int _dataPin;
+    bool _begun;
+    bool _converting;
+    uint32_t _millisConversionStarted;
+    uint32_t _conversionTime_ms;
+    OneWireBus *_nextBus;
+
+    static OneWireBus *_firstBus;
+};
+
+#endif
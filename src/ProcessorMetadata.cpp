@@ -189,7 +189,7 @@ bool ProcessorMetadata::update(void)
     #if defined __AVR__
     extern int __heap_start, *__brkval;
     int v;
-    float sensorValue_freeRam = (int) &v - (__brkval == 0 ? (int) &__heap_start : (int) __brkval);
+    float sensorValue_freeRam = (intptr_t) &v - (__brkval == 0 ? (intptr_t) &__heap_start : (intptr_t) __brkval);
 
     #elif defined(ARDUINO_ARCH_SAMD)
     float sensorValue_freeRam = FreeRam();
@@ -0,0 +1,197 @@
+/*
+ *ReadingStats.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for keeping running statistics of the readings a sensor averages
+ *together, and for variables that report those statistics alongside the
+ *average.  The statistics are updated as each reading comes in (using
+ *Welford's method for the variance), so no readings need to be stored.
+ *They can also be given a precision target, so that a sensor can stop taking
+ *readings as soon as its average is good enough.
+*/
+
+#ifndef ReadingStats_h
+#define ReadingStats_h
+
+#include <Arduino.h>
+
+#include "SensorBase.h"
+#include "VariableBase.h"
+
+// The value given for a result that could not be measured
+#define READING_STATS_NO_VALUE -9999
+
+class ReadingStats
+{
+public:
+    ReadingStats(void)
+    {
+        reset();
+        setTarget(0, 0);
+    }
+
+    // This clears the statistics before the first reading
+    void reset(void)
+    {
+        _count = 0;
+        _mean = 0;
+        _sumSquares = 0;
+        _min = 0;
+        _max = 0;
+    }
+
+    // This adds one reading.  Readings that failed (-9999 or not a number)
+    // are left out, so they do not pull down the average.
+    void add(float value)
+    {
+        if (isnan(value) || value == READING_STATS_NO_VALUE) return;
+        _count++;
+        float delta = value - _mean;
+        _mean += delta / _count;
+        _sumSquares += delta * (value - _mean);
+        if (_count == 1 || value < _min) _min = value;
+        if (_count == 1 || value > _max) _max = value;
+    }
+
+    // These return the statistics of the readings added so far, or -9999 if
+    // there are none
+    uint16_t getCount(void){return _count;}
+    float getMean(void){return _count > 0 ? _mean : READING_STATS_NO_VALUE;}
+    float getMin(void){return _count > 0 ? _min : READING_STATS_NO_VALUE;}
+    float getMax(void){return _count > 0 ? _max : READING_STATS_NO_VALUE;}
+    // This is the sample standard deviation, which is 0 for a single reading
+    float getStdDev(void)
+    {
+        if (_count == 0) return READING_STATS_NO_VALUE;
+        if (_count == 1) return 0;
+        return sqrt(_sumSquares / (_count - 1));
+    }
+    // This is the standard error of the mean
+    float getStdError(void)
+    {
+        if (_count == 0) return READING_STATS_NO_VALUE;
+        return getStdDev() / sqrt(_count);
+    }
+
+    // This sets the precision the average should reach, either as a standard
+    // error in the variable's units or relative to the mean (ie, 0.01 for 1%).
+    // Use 0 for either to not use it.  This is kept when reset() is called.
+    void setTarget(float stdError, float relativeError)
+    {
+        _targetStdError = stdError;
+        _targetRelError = relativeError;
+    }
+    // This returns true if the average is as precise as the target.  It is
+    // always true if there is no target and never with fewer than 2 readings.
+    bool meetsTarget(void)
+    {
+        if (_targetStdError <= 0 && _targetRelError <= 0) return true;
+        if (_count < 2) return false;
+        float stdError = getStdError();
+        if (_targetStdError > 0 && stdError <= _targetStdError) return true;
+        if (_targetRelError > 0 && stdError <= _targetRelError*fabs(_mean)) return true;
+        return false;
+    }
+
+    // This checks if enough readings have been taken for a sensor's averages:
+    // always once maxReadings have been taken, and after minReadings once
+    // every one of its values has met its target
+    static bool isFinished(ReadingStats *stats, int numStats, int numTaken,
+                           int minReadings, int maxReadings)
+    {
+        if (numTaken >= maxReadings) return true;
+        if (numTaken < minReadings) return false;
+        for (int i = 0; i < numStats; i++)
+        {
+            if (!stats[i].meetsTarget()) return false;
+        }
+        return true;
+    }
+
+private:
+    uint16_t _count;
+    float _mean;
+    float _sumSquares;
+    float _min;
+    float _max;
+    float _targetStdError;
+    float _targetRelError;
+};
+
+
+typedef enum STATS_TYPE
+{
+    STATS_STDDEV,
+    STATS_MIN,
+    STATS_MAX,
+    STATS_COUNT
+} STATS_TYPE;
+
+// Defines a variable for one statistic of the readings averaged into another
+// variable.  These are filled in whenever the sensor is updated, so they do
+// not take any extra readings.  They only have values for sensors that keep
+// statistics (the Decagon SDI-12 and Yosemitech sensors); for others they are
+// always -9999.
+class StatsVariable : public Variable
+{
+public:
+    StatsVariable(Variable *sourceVar, STATS_TYPE statsType, String customVarCode = "")
+     : Variable(sourceVar->parentSensor, sourceVar->getVarNum(),
+                sourceVar->getVarName(),
+                statsType == STATS_COUNT ? String(F("count")) : sourceVar->getVarUnit(),
+                statsType == STATS_COUNT ? 0 :
+                    (statsType == STATS_STDDEV ? sourceVar->getResolution() + 1 :
+                                                 sourceVar->getResolution()),
+                sourceVar->getVarCode() + getCodeSuffix(statsType), customVarCode)
+    {
+        _statsType = statsType;
+        nextStatsVariable = NULL;
+        sensorValue = READING_STATS_NO_VALUE;
+    }
+
+    // The variable the statistics are of is the one registered to the sensor,
+    // so this is kept in a separate list on the sensor
+    virtual bool setup(void) override
+    {
+        parentSensor->registerStatsVariable(this);
+        return true;
+    }
+
+    virtual void onSensorUpdate(Sensor *parentSense) override
+    {
+        ReadingStats *stats = parentSense->getReadingStats(getVarNum());
+        if (stats == NULL)
+        {
+            sensorValue = READING_STATS_NO_VALUE;
+            return;
+        }
+        switch (_statsType)
+        {
+            case STATS_STDDEV: sensorValue = stats->getStdDev(); break;
+            case STATS_MIN: sensorValue = stats->getMin(); break;
+            case STATS_MAX: sensorValue = stats->getMax(); break;
+            case STATS_COUNT: sensorValue = stats->getCount(); break;
+        }
+    }
+
+    StatsVariable *nextStatsVariable;
+
+private:
+    static String getCodeSuffix(STATS_TYPE statsType)
+    {
+        switch (statsType)
+        {
+            case STATS_STDDEV: return F("_SD");
+            case STATS_MIN: return F("_Min");
+            case STATS_MAX: return F("_Max");
+            case STATS_COUNT: return F("_N");
+        }
+        return "";
+    }
+
+    STATS_TYPE _statsType;
+};
+
+#endif
@@ -0,0 +1,205 @@
+/*
+ *SDI12Bus.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for a single SDI-12 data line shared by all of the SDI-12
+ *sensors attached to the same pin.
+ *It is dependent on the EnviroDIY SDI-12 library.
+*/
+
+#define LIBCALL_ENABLEINTERRUPT  // To prevent compiler/linker crashes
+#include <EnableInterrupt.h>  // To handle external and pin change interrupts
+
+#include "SDI12Bus.h"
+
+// The list of buses and the one currently listening
+SDI12Bus *SDI12Bus::_firstBus = NULL;
+SDI12Bus *SDI12Bus::_activeBus = NULL;
+
+
+SDI12Bus::SDI12Bus(int dataPin) : _sdi12(dataPin)
+{
+    _dataPin = dataPin;
+    _active = false;
+    _acknowledged = 0;
+    _nextBus = NULL;
+}
+
+
+// Find the bus for the pin, or create one if this is the first sensor on it
+SDI12Bus *SDI12Bus::getBus(int dataPin)
+{
+    for (SDI12Bus *bus = _firstBus; bus != NULL; bus = bus->_nextBus)
+    {
+        if (bus->_dataPin == dataPin) return bus;
+    }
+    SDI12Bus *bus = new SDI12Bus(dataPin);
+    bus->_nextBus = _firstBus;
+    _firstBus = bus;
+    return bus;
+}
+
+
+// Start listening on the pin, if not already
+SDI12 *SDI12Bus::begin(void)
+{
+    if (_active) return &_sdi12;
+    if (_activeBus != NULL) _activeBus->end();
+
+    DBGM(F("Starting SDI-12 on pin "), _dataPin, F("\n"));
+    _sdi12.begin();
+    _sdi12.setTimeout(15);  // SDI-12 protocol says sensors must respond within 15 milliseconds
+    enableInterrupt(_dataPin, SDI12::handleInterrupt, CHANGE);
+    _active = true;
+    _activeBus = this;
+    return &_sdi12;
+}
+
+
+// Stop listening on the pin
+void SDI12Bus::end(void)
+{
+    if (!_active) return;
+
+    DBGM(F("Ending SDI-12 on pin "), _dataPin, F("\n"));
+    disableInterrupt(_dataPin);
+    _sdi12.clearBuffer();
+    _sdi12.forceHold();
+    _sdi12.end();
+    _active = false;
+    if (_activeBus == this) _activeBus = NULL;
+}
+
+
+// Send a command and wait for the reply
+String SDI12Bus::sendCommand(String command)
+{
+    char reply[SDI12_BUFFER_SIZE];
+    sendCommand(command.c_str(), reply, sizeof(reply));
+    return String(reply);
+}
+
+uint8_t SDI12Bus::sendCommand(const char *command, char *reply, uint8_t size)
+{
+    SDI12 *sdi12 = begin();
+    sdi12->clearBuffer();
+    sdi12->sendCommand(command);
+    DBGM(F(">>"), command, F("\n"));
+    delay(30);  // It just needs this little delay
+
+    // Read the reply straight into the buffer, leaving off the <CR><LF>
+    uint8_t length = sdi12->readBytesUntil('\n', reply, size - 1);
+    while (length > 0 && isspace(reply[length - 1])) length--;
+    reply[length] = '\0';
+    DBGM(F("<<"), reply, F("\n"));
+    return length;
+}
+
+
+// Read the values from as many data pages as it takes
+int8_t SDI12Bus::getData(char address, float *values, uint8_t numExpected)
+{
+    char command[] = {address, 'D', '0', '!', '\0'};  // [address][D][page][!]
+    char reply[SDI12_BUFFER_SIZE];
+    uint8_t numReceived = 0;
+
+    DBGM(F("Receiving data\n"));
+    for (uint8_t page = 0; page < SDI12_MAX_DATA_PAGES && numReceived < numExpected; page++)
+    {
+        command[2] = '0' + page;
+        sendCommand(command, reply, sizeof(reply));
+
+        int8_t numValues = parseValues(reply, address, values + numReceived,
+                                       numExpected - numReceived);
+        if (numValues < 0)
+        {
+            DBGM(F("Malformed reply to "), command, F("\n"));
+            return -1;
+        }
+        // A page with no values means the sensor has nothing more to send
+        if (numValues == 0) break;
+        numReceived += numValues;
+    }
+
+    if (numReceived > numExpected) numReceived = numExpected;
+    if (numReceived < numExpected)
+    {
+        DBGM(F("Only "), numReceived, F(" of "), numExpected, F(" values received\n"));
+    }
+    return numReceived;
+}
+
+
+// Values are a sign, then up to 7 digits with an optional decimal point, with
+// nothing between them; the sign of the next value ends the one before it
+int8_t SDI12Bus::parseValues(const char *reply, char address,
+                             float *values, uint8_t maxValues)
+{
+    if (reply[0] != address) return -1;
+
+    const char *c = reply + 1;
+    int8_t numValues = 0;
+    while (*c != '\0')
+    {
+        if (*c != '+' && *c != '-') return -1;
+        bool negative = (*c == '-');
+        c++;
+
+        float value = 0;
+        float divisor = 0;  // Stays 0 until the decimal point
+        uint8_t numDigits = 0;
+        while ((*c >= '0' && *c <= '9') || (*c == '.' && divisor == 0))
+        {
+            if (*c == '.') divisor = 1;
+            else
+            {
+                value = value*10 + (*c - '0');
+                if (divisor != 0) divisor *= 10;
+                numDigits++;
+            }
+            c++;
+        }
+        if (numDigits == 0 || numDigits > 7) return -1;
+        if (divisor > 1) value /= divisor;
+
+        if (numValues < maxValues) values[numValues] = negative ? -value : value;
+        numValues++;
+    }
+    return numValues;
+}
+
+
+int16_t SDI12Bus::parseDigits(const char *digits, uint8_t length)
+{
+    int16_t value = 0;
+    for (uint8_t i = 0; i < length; i++)
+    {
+        if (digits[i] < '0' || digits[i] > '9') return -1;
+        value = value*10 + (digits[i] - '0');
+    }
+    return value;
+}
+
+
+// Each of the 62 possible SDI-12 addresses gets one bit
+uint64_t SDI12Bus::addressBit(char address)
+{
+    if (address >= '0' && address <= '9') return 1ULL << (address - '0');
+    if (address >= 'a' && address <= 'z') return 1ULL << (address - 'a' + 10);
+    if (address >= 'A' && address <= 'Z') return 1ULL << (address - 'A' + 36);
+    return 0;
+}
+
+bool SDI12Bus::isAcknowledged(char address)
+{
+    uint64_t bit = addressBit(address);
+    return bit != 0 && (_acknowledged & bit) != 0;
+}
+
+void SDI12Bus::setAcknowledged(char address, bool acknowledged)
+{
+    if (acknowledged) _acknowledged |= addressBit(address);
+    else _acknowledged &= ~addressBit(address);
+}
@@ -0,0 +1,87 @@
+/*
+ *SDI12Bus.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for a single SDI-12 data line shared by all of the SDI-12
+ *sensors attached to the same pin.  The SDI-12 object, its timer and its pin
+ *change interrupt are set up once and left running until the sensors are put
+ *to sleep, instead of being started and stopped around every command.
+ *It also remembers which addresses have answered, so sensors that are known
+ *to be there do not need to be asked again before every measurement.
+ *It is dependent on the EnviroDIY SDI-12 library.
+*/
+
+#ifndef SDI12Bus_h
+#define SDI12Bus_h
+
+#include <Arduino.h>
+
+// #define MODULES_DBG Serial
+#include "ModSensorDebugger.h"
+
+#include <SDI12_ExtInts.h>
+
+// The longest reply kept: a data page (aD0! to aD9!) has at most 75
+// characters of values after the address, plus the line ending
+#define SDI12_BUFFER_SIZE 82
+// The number of data pages a sensor can split its values across (aD0! to aD9!)
+#define SDI12_MAX_DATA_PAGES 10
+
+class SDI12Bus
+{
+public:
+    // This returns the bus on the given data pin, creating it the first time
+    static SDI12Bus *getBus(int dataPin);
+
+    // This makes sure the bus is listening and returns the SDI-12 object to
+    // send commands with.  Only one SDI-12 pin can listen at a time, so any
+    // other active bus is ended first.
+    SDI12 *begin(void);
+    // This stops listening and releases the interrupt and timer
+    void end(void);
+    bool isActive(void){return _active;}
+
+    // This sends a command and returns the sensor's reply, without the line ending
+    String sendCommand(String command);
+    // This sends a command and copies the sensor's reply into the buffer,
+    // without the line ending.  Returns the length of the reply.
+    uint8_t sendCommand(const char *command, char *reply, uint8_t size);
+
+    // This reads the values of a finished measurement, following the data pages
+    // (aD0!, aD1!, ...) until the expected number of values have come in or a
+    // page is empty.  Returns the number of values read, or -1 if a reply was
+    // malformed.
+    int8_t getData(char address, float *values, uint8_t numExpected);
+
+    // This decodes the values in a data reply ("a+1.23-4.5+67"), storing up to
+    // maxValues of them.  Returns the number of values in the reply, or -1 if
+    // it is not in the SDI-12 value format.
+    static int8_t parseValues(const char *reply, char address,
+                              float *values, uint8_t maxValues);
+    // This reads a whole number from the given digits, or returns -1 if any
+    // of them is not a digit
+    static int16_t parseDigits(const char *digits, uint8_t length);
+
+    // These record whether the sensor at an address has answered
+    bool isAcknowledged(char address);
+    void setAcknowledged(char address, bool acknowledged);
+
+    int getDataPin(void){return _dataPin;}
+
+private:
+    SDI12Bus(int dataPin);
+    static uint64_t addressBit(char address);
+
+    SDI12 _sdi12;
+    int _dataPin;
+    bool _active;
+    uint64_t _acknowledged;
+    SDI12Bus *_nextBus;
+
+    static SDI12Bus *_firstBus;
+    static SDI12Bus *_activeBus;
+};
+
+#endif
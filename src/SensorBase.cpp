@@ -9,20 +9,31 @@
 
 #include "SensorBase.h"
 #include "VariableBase.h"
+#include "ReadingStats.h"
+#include "SensorPower.h"
 
 // ============================================================================
 //  The class and functions for interfacing with a sensor
 // ============================================================================
 
 // The constructor
-Sensor::Sensor(int powerPin, int dataPin, String sensorName, int numReturnedVars, int WarmUpTime_ms)
+Sensor::Sensor(int powerPin, int dataPin, String sensorName, int numReturnedVars, int WarmUpTime_ms, int StabilizationTime_ms)
 {
     _powerPin = powerPin;
     _dataPin = dataPin;
     _sensorName = sensorName;
     _numReturnedVars = numReturnedVars;
     _WarmUpTime_ms = WarmUpTime_ms;
+    _StabilizationTime_ms = StabilizationTime_ms;
     _millisPowerOn = 0;
+    _millisMeasurementRequested = 0;
+    _firstStatsVariable = NULL;
+    _firstPowerVariable = NULL;
+    _powerDraw_mA = 0;
+    _poweredTime_ms = 0;
+    _lastPoweredTime_ms = 0;
+    _powerCycles = 0;
+    _warmUpWait_ms = 0;
 
     // Clear arrays
     for (uint8_t i = 0; i < MAX_NUMBER_VARS; i++)
@@ -43,6 +54,30 @@ String Sensor::getSensorLocation(void)
 // This returns the name of the sensor.
 String Sensor::getSensorName(void){return _sensorName;}
 
+// These return the sensor's timing needs
+uint32_t Sensor::getWarmUpTime(void){return _WarmUpTime_ms;}
+uint32_t Sensor::getStabilizationTime(void){return _StabilizationTime_ms;}
+uint32_t Sensor::getMillisPowerOn(void){return _millisPowerOn;}
+
+// These return the power used by the sensor
+uint32_t Sensor::getPoweredTime(void)
+{
+    // Include the time so far if the sensor is on now
+    if (_powerPin > 0 && _millisPowerOn != 0)
+        return _poweredTime_ms + (millis() - _millisPowerOn);
+    return _poweredTime_ms;
+}
+uint32_t Sensor::getLastPoweredTime(void){return _lastPoweredTime_ms;}
+uint32_t Sensor::getPowerCycles(void){return _powerCycles;}
+uint32_t Sensor::getWarmUpWaitTime(void){return _warmUpWait_ms;}
+void Sensor::addWarmUpWaitTime(uint32_t waited_ms){_warmUpWait_ms += waited_ms;}
+void Sensor::setPowerDraw(float current_mA){_powerDraw_mA = current_mA;}
+float Sensor::getPowerDraw(void){return _powerDraw_mA;}
+float Sensor::getChargeUsed(void)
+{
+    return _powerDraw_mA * getPoweredTime() / 3600000.0;
+}
+
 
 // This is a helper function to check if the power needs to be turned on
 bool Sensor::checkPowerOn(void)
@@ -50,8 +85,8 @@ bool Sensor::checkPowerOn(void)
     DBGS(F("Checking power status.\n"));
     if (_powerPin > 0)
     {
-        int powerBitNumber = log(digitalPinToBitMask(_powerPin))/log(2);
-        if (bitRead(*portInputRegister(digitalPinToPort(_powerPin)), powerBitNumber) == LOW)
+        // Reading an output pin gives the level it is being driven to
+        if (digitalRead(_powerPin) == LOW)
         {
             DBGS(F("Power was off.\n"));
             if (_millisPowerOn != 0) _millisPowerOn = 0;
@@ -80,6 +115,7 @@ void Sensor::powerUp(void)
         DBGS(F("Powering on Sensor with pin "), _powerPin, F("\n"));
         digitalWrite(_powerPin, HIGH);
         _millisPowerOn = millis();
+        _powerCycles++;
     }
 }
 
@@ -90,6 +126,11 @@ void Sensor::powerDown(void)
     {
         DBGS(F("Turning off Power\n"));
         digitalWrite(_powerPin, LOW);
+        if (_millisPowerOn != 0)
+        {
+            _lastPoweredTime_ms = millis() - _millisPowerOn;
+            _poweredTime_ms += _lastPoweredTime_ms;
+        }
         _millisPowerOn = 0;
     }
 }
@@ -107,17 +148,30 @@ void Sensor::waitForWarmUp(void)
         else if (millis() > _millisPowerOn)  // just in case millis() has rolled over
         {
             DBGS(F("Waiting "), (millis() + _WarmUpTime_ms - _millisPowerOn), F("ms for sensor warm-up\n"));
-            while((millis() - _millisPowerOn) < _WarmUpTime_ms){}
+            uint32_t waitStart = millis();
+            delay(_WarmUpTime_ms - (millis() - _millisPowerOn));
+            _warmUpWait_ms += millis() - waitStart;
         }
         else  // if we get really unlucky and are measuring as millis() rolls over
         {
             DBGS(F("Waiting 2000ms for sensor warm-up\n"));
-            while(millis() < 2000){}
+            uint32_t waitStart = millis();
+            if (millis() < 2000) delay(2000 - millis());
+            _warmUpWait_ms += millis() - waitStart;
         }
     }
 }
 
 
+// This checks if enough time has passed since power-on for the sensor to be
+// warmed up, without waiting for it
+bool Sensor::isWarmedUp(void)
+{
+    if (_WarmUpTime_ms == 0) return true;
+    return (millis() - _millisPowerOn) >= _WarmUpTime_ms;
+}
+
+
 // The function to set up connection to a sensor.
 // By default, sets pin modes and returns ready
 SENSOR_STATUS Sensor::setup(void)
@@ -197,6 +251,53 @@ void Sensor::notifyVariables(void)
         }
         else DBGS(F("Null pointer\n"));
     }
+    for (StatsVariable *var = _firstStatsVariable; var != NULL; var = var->nextStatsVariable)
+    {
+        var->onSensorUpdate(this);
+    }
+    for (PowerVariable *var = _firstPowerVariable; var != NULL; var = var->nextPowerVariable)
+    {
+        var->onSensorUpdate(this);
+    }
+}
+
+void Sensor::registerStatsVariable(StatsVariable* var)
+{
+    // Don't add the same variable twice if setup is run again
+    for (StatsVariable *v = _firstStatsVariable; v != NULL; v = v->nextStatsVariable)
+    {
+        if (v == var) return;
+    }
+    var->nextStatsVariable = _firstStatsVariable;
+    _firstStatsVariable = var;
+    DBGS(F("... Registration for statistics of "));
+    DBGS(var->getVarName());
+    DBGS(F(" accepted.\n"));
+}
+
+void Sensor::registerPowerVariable(PowerVariable* var)
+{
+    // Don't add the same variable twice if setup is run again
+    for (PowerVariable *v = _firstPowerVariable; v != NULL; v = v->nextPowerVariable)
+    {
+        if (v == var) return;
+    }
+    var->nextPowerVariable = _firstPowerVariable;
+    _firstPowerVariable = var;
+    DBGS(F("... Registration for power use of "));
+    DBGS(getSensorName());
+    DBGS(F(" accepted.\n"));
+}
+
+// By default, sensors do not keep statistics of their readings
+ReadingStats *Sensor::getReadingStats(int varNum){return NULL;}
+
+bool Sensor::setPrecisionTarget(int varNum, float stdError, float relativeError)
+{
+    ReadingStats *stats = getReadingStats(varNum);
+    if (stats == NULL) return false;
+    stats->setTarget(stdError, relativeError);
+    return true;
 }
 
 
@@ -214,6 +315,59 @@ bool Sensor::checkForUpdate(unsigned long sensorLastUpdated)
 }
 
 
+// The function to start a measurement
+// By default, just notes the time and returns true once the sensor is warmed up
+bool Sensor::startMeasurement(void)
+{
+    if (!isWarmedUp()) return false;
+    _millisMeasurementRequested = millis();
+    return true;
+}
+
+
+// The function to check if a started measurement is finished
+// By default, the measurement is always ready
+bool Sensor::isMeasurementReady(void){return true;}
+
+
+// The function to collect the result of a started measurement
+// By default, runs the full update
+SENSOR_STATUS Sensor::collectMeasurement(void)
+{
+    _millisMeasurementRequested = 0;
+    if (update()) return SENSOR_READY;
+    else return SENSOR_ERROR;
+}
+
+
+// This is a helper function to run a complete measurement with the split
+// start/ready/collect functions, waiting for each step to finish.
+bool Sensor::runMeasurement(void)
+{
+    // Check if the power is on, turn it on if not
+    bool wasOn = checkPowerOn();
+    if(!wasOn){powerUp();}
+    // Wait until the sensor is warmed up
+    waitForWarmUp();
+
+    SENSOR_STATUS stat = SENSOR_ERROR;
+    if (startMeasurement())
+    {
+        // Keep collecting until all of the readings to average are finished
+        do
+        {
+            while (!isMeasurementReady()){delay(1);}
+            stat = collectMeasurement();
+        } while (stat == SENSOR_WAITING);
+    }
+
+    // Turn the power back off it it had been turned on
+    if(!wasOn){powerDown();}
+
+    return (stat == SENSOR_READY);
+}
+
+
 // This function just empties the value array
 void Sensor::clearValues(void)
 {
@@ -45,19 +45,50 @@ typedef enum SENSOR_STATUS
 
 
 class Variable;  // Forward declaration
+class StatsVariable;  // Forward declaration
+class ReadingStats;  // Forward declaration
+class PowerVariable;  // Forward declaration
 
 // Defines the "Sensor" Class
 class Sensor
 {
 public:
 
-    Sensor(int powerPin = -1, int dataPin = -1, String sensorName = "Unknown", int numReturnedVars = 1, int WarmUpTime_ms = 0);
+    Sensor(int powerPin = -1, int dataPin = -1, String sensorName = "Unknown", int numReturnedVars = 1, int WarmUpTime_ms = 0, int StabilizationTime_ms = 0);
 
     // These functions are dependent on the constructor and return the constructor values
     // This gets the place the sensor is installed ON THE MAYFLY (ie, pin number)
     virtual String getSensorLocation(void);
     // This gets the name of the sensor.
     virtual String getSensorName(void);
+    // These return the time needed after power-on before the sensor can be
+    // told to measure and the time after that until its readings are stable.
+    uint32_t getWarmUpTime(void);
+    uint32_t getStabilizationTime(void);
+    // This returns the time (in millis) the sensor was last powered on.
+    uint32_t getMillisPowerOn(void);
+
+    // These keep track of how much power the sensor has used since the board
+    // started.  They only count time the sensor's own power pin was on.
+    // This returns the total time the sensor has been powered, in ms.
+    uint32_t getPoweredTime(void);
+    // This returns how long the sensor was on the last time it was powered
+    // down, in ms.
+    uint32_t getLastPoweredTime(void);
+    // This returns the number of times the sensor has been powered up.
+    uint32_t getPowerCycles(void);
+    // This returns the total time spent waiting for the sensor to warm up
+    // before it could be measured, in ms.
+    uint32_t getWarmUpWaitTime(void);
+    // This adds to the warm-up wait, for when many sensors are waited for at
+    // once (ie, by the VariableArray schedule) instead of by waitForWarmUp().
+    void addWarmUpWaitTime(uint32_t waited_ms);
+    // These set and return the current the sensor draws while it is powered,
+    // in mA.  Drivers give a typical value where it is known; it is 0 if not.
+    void setPowerDraw(float current_mA);
+    float getPowerDraw(void);
+    // This returns the total charge the sensor has used, in mAh.
+    float getChargeUsed(void);
 
     // These next functions have defaults.
     // This sets up the sensor, if necessary.  Defaults to ready.
@@ -75,10 +106,38 @@ public:
     // This updates the sensor's values
     virtual bool update(void) = 0;
 
+    // These next functions split the update into separate steps so that the
+    // warm-up and measurement times of many sensors can overlap.
+    // This checks if the sensor has been powered long enough to be warmed up.
+    bool isWarmedUp(void);
+    // This starts a measurement.  It returns false without waiting if the
+    // sensor is not warmed up yet, so check isWarmedUp() first.  By default,
+    // just notes the time.
+    virtual bool startMeasurement(void);
+    // This checks if a started measurement can be collected.  By default, it
+    // is immediately ready.
+    virtual bool isMeasurementReady(void);
+    // This collects the results of a started measurement.  This returns
+    // SENSOR_WAITING if another reading for the average has been started,
+    // SENSOR_READY when the values have been sent to the variables, and
+    // SENSOR_ERROR if the measurement failed.  By default, calls update().
+    virtual SENSOR_STATUS collectMeasurement(void);
+
     // These tie the variables to their parent sensor
     virtual void registerVariable(int varNum, Variable* var);
     virtual void notifyVariables(void);
     float sensorValues[MAX_NUMBER_VARS];
+    // These tie variables for the statistics of the averaged readings to the
+    // sensor.  Sensors that keep statistics return them for each variable
+    // number; by default there are none.
+    void registerStatsVariable(StatsVariable* var);
+    virtual ReadingStats *getReadingStats(int varNum);
+    // This sets how precise the average of a variable should be for sensors
+    // that can stop averaging early (see setReadingRange on those sensors).
+    // Returns false if the sensor does not keep statistics.
+    bool setPrecisionTarget(int varNum, float stdError, float relativeError = 0);
+    // This ties variables for the power used by the sensor to it
+    void registerPowerVariable(PowerVariable* var);
 
     // This just makes sure things are up-to-date
     bool checkForUpdate(unsigned long sensorLastUpdated);
@@ -90,14 +149,24 @@ protected:
     void powerDown(void);
     void waitForWarmUp(void);
     void clearValues();
+    bool runMeasurement(void);
     int _dataPin;
     int _powerPin;
     String _sensorName;
     int _numReturnedVars;
     uint32_t _WarmUpTime_ms;
+    uint32_t _StabilizationTime_ms;
     uint32_t _millisPowerOn;
+    uint32_t _millisMeasurementRequested;
     SENSOR_STATUS sensorStatus;
     Variable *variables[MAX_NUMBER_VARS];
+    StatsVariable *_firstStatsVariable;
+    PowerVariable *_firstPowerVariable;
+    float _powerDraw_mA;
+    uint32_t _poweredTime_ms;
+    uint32_t _lastPoweredTime_ms;
+    uint32_t _powerCycles;
+    uint32_t _warmUpWait_ms;
 };
 
 #endif
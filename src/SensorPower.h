@@ -0,0 +1,119 @@
+/*
+ *SensorPower.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for variables that report the power used by a sensor, so the
+ *energy each sensor uses can be logged with its data.  The sensor counts the
+ *time its power pin is on, the number of times it is powered up and the time
+ *spent waiting for it to warm up; these variables report how much each of
+ *those grew between one update of the sensor and the next.
+*/
+
+#ifndef SensorPower_h
+#define SensorPower_h
+
+#include <Arduino.h>
+
+#include "SensorBase.h"
+#include "VariableBase.h"
+
+typedef enum POWER_TYPE
+{
+    POWER_ON_TIME,
+    POWER_WARM_UP_WAIT,
+    POWER_CYCLES,
+    POWER_CHARGE
+} POWER_TYPE;
+
+// Defines a variable for the power a sensor used since it was last updated.
+// These are filled in whenever the sensor is updated, so they do not take any
+// extra readings.  Times are in seconds and the charge is in mAh, using the
+// current set with setPowerDraw() on the sensor.  The first value after the
+// board starts includes any time the sensor was powered during setup.
+class PowerVariable : public Variable
+{
+public:
+    PowerVariable(Sensor *parentSense, POWER_TYPE powerType, String customVarCode = "")
+     : Variable(parentSense, 0,
+                getPowerName(powerType), getPowerUnit(powerType),
+                powerType == POWER_CYCLES ? 0 : (powerType == POWER_CHARGE ? 4 : 3),
+                getPowerCode(powerType), customVarCode)
+    {
+        _powerType = powerType;
+        _lastTotal = 0;
+        nextPowerVariable = NULL;
+        sensorValue = 0;
+    }
+
+    // These do not take the place of any of the sensor's own values, so they
+    // are kept in a separate list on the sensor
+    virtual bool setup(void) override
+    {
+        parentSensor->registerPowerVariable(this);
+        return true;
+    }
+
+    virtual void onSensorUpdate(Sensor *parentSense) override
+    {
+        // The totals are kept as whole ms or counts so small differences are
+        // not lost in a large float
+        uint32_t total;
+        if (_powerType == POWER_WARM_UP_WAIT) total = parentSense->getWarmUpWaitTime();
+        else if (_powerType == POWER_CYCLES) total = parentSense->getPowerCycles();
+        else total = parentSense->getPoweredTime();
+        uint32_t change = total - _lastTotal;
+        _lastTotal = total;
+
+        switch (_powerType)
+        {
+            case POWER_ON_TIME: sensorValue = change/1000.0; break;
+            case POWER_WARM_UP_WAIT: sensorValue = change/1000.0; break;
+            case POWER_CYCLES: sensorValue = change; break;
+            case POWER_CHARGE: sensorValue = parentSense->getPowerDraw()*change/3600000.0; break;
+        }
+    }
+
+    PowerVariable *nextPowerVariable;
+
+private:
+    static String getPowerName(POWER_TYPE powerType)
+    {
+        switch (powerType)
+        {
+            case POWER_ON_TIME: return F("Sensor powered time");
+            case POWER_WARM_UP_WAIT: return F("Sensor warm-up wait");
+            case POWER_CYCLES: return F("Sensor power cycles");
+            case POWER_CHARGE: return F("Sensor charge used");
+        }
+        return "";
+    }
+    static String getPowerUnit(POWER_TYPE powerType)
+    {
+        switch (powerType)
+        {
+            case POWER_ON_TIME: return F("second");
+            case POWER_WARM_UP_WAIT: return F("second");
+            case POWER_CYCLES: return F("count");
+            case POWER_CHARGE: return F("milliampereHour");
+        }
+        return "";
+    }
+    static String getPowerCode(POWER_TYPE powerType)
+    {
+        switch (powerType)
+        {
+            case POWER_ON_TIME: return F("PowerOnTime");
+            case POWER_WARM_UP_WAIT: return F("WarmUpWait");
+            case POWER_CYCLES: return F("PowerCycles");
+            case POWER_CHARGE: return F("ChargeUsed");
+        }
+        return "";
+    }
+
+    POWER_TYPE _powerType;
+    uint32_t _lastTotal;
+};
+
+#endif
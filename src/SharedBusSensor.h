@@ -0,0 +1,180 @@
+/*
+ *SharedBusSensor.h
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This file is for sensors that share a data pin with other sensors of the same
+ *kind and are all measured together (ie, Decagon SDI-12 sensors or Maxim
+ *DS18's).  Every sensor of the kind is kept in one list, so calling update()
+ *on any one of them can power up, start, and collect every sensor on its pin
+ *at once.  The sensors that did not ask for the update then use those values
+ *if their own update() is called soon after.
+ *The template argument is the sensor class, so each kind of sensor keeps its
+ *own list.
+*/
+
+#ifndef SharedBusSensor_h
+#define SharedBusSensor_h
+
+#include <Arduino.h>
+
+// #define MODULES_DBG Serial
+#include "ModSensorDebugger.h"
+
+#include "SensorBase.h"
+
+// How long values measured along with other sensors on the same data pin are
+// used instead of measuring again when update() is called
+#define SENSOR_BUS_SHARED_MS 30000L
+
+template <class T>
+class SharedBusSensor : public Sensor
+{
+public:
+    // The bus timeout is the longest a measurement of all of the sensors on
+    // the data pin may take
+    SharedBusSensor(int powerPin, int dataPin, String sensorName,
+                    int numReturnedVars, int WarmUpTime_ms, uint32_t busTimeout_ms)
+      : Sensor(powerPin, dataPin, sensorName, numReturnedVars, WarmUpTime_ms)
+    {
+        _busTimeout_ms = busTimeout_ms;
+        _busStatus = SENSOR_UNKNOWN;
+        _busWasOn = false;
+        _busShared = false;
+        _millisBusUpdated = 0;
+        _nextSensor = _firstSensor;
+        _firstSensor = this;
+    }
+
+    // Take the sensor back out of the list
+    virtual ~SharedBusSensor()
+    {
+        for (SharedBusSensor **link = &_firstSensor; *link != NULL; link = &(*link)->_nextSensor)
+        {
+            if (*link == this)
+            {
+                *link = _nextSensor;
+                break;
+            }
+        }
+    }
+
+    // All of the sensors on the same data pin are measured together; if this
+    // sensor was just measured along with another one, those values are used.
+    virtual bool update(void) override
+    {
+        if (_busShared && millis() - _millisBusUpdated < SENSOR_BUS_SHARED_MS)
+        {
+            _busShared = false;
+            DBGM(F("Using values measured along with the rest of the bus\n"));
+            return (_busStatus == SENSOR_READY);
+        }
+        return updateBus(_dataPin, this);
+    }
+
+    // This measures every sensor of this kind on the given data pin at once,
+    // collecting from each as soon as it is finished.  Returns true if every
+    // sensor on the pin was updated.
+    static bool updateBus(int dataPin){return updateBus(dataPin, NULL);}
+
+protected:
+    // This is called before a sensor that had been off is powered down again
+    // after the bus is measured, to release anything it holds on the pin
+    virtual void releaseBus(void){}
+
+    static bool updateBus(int dataPin, SharedBusSensor *caller)
+    {
+        DBGM(F("Starting measurements of all sensors on pin "), dataPin, F("\n"));
+        // Power up every sensor first, so their warm up times overlap.  All of
+        // them are checked before any are powered, so a sensor sharing a power
+        // pin with another one isn't taken to have been on all along.
+        uint32_t timeout = 0;
+        for (SharedBusSensor *s = _firstSensor; s != NULL; s = s->_nextSensor)
+        {
+            if (s->_dataPin != dataPin) continue;
+            s->_busWasOn = s->checkPowerOn();
+            timeout = max(timeout, s->_busTimeout_ms);
+        }
+        for (SharedBusSensor *s = _firstSensor; s != NULL; s = s->_nextSensor)
+        {
+            if (s->_dataPin == dataPin && !s->_busWasOn){s->powerUp();}
+        }
+
+        // Start each sensor as soon as it is warmed up and collect from each as
+        // soon as its measurement is finished
+        uint8_t numPending = 0;
+        for (SharedBusSensor *s = _firstSensor; s != NULL; s = s->_nextSensor)
+        {
+            if (s->_dataPin != dataPin) continue;
+            s->_busStatus = SENSOR_UNKNOWN;
+            numPending++;
+        }
+        uint32_t start = millis();
+        while (numPending > 0 && millis() - start < timeout)
+        {
+            bool anyDone = false;
+            for (SharedBusSensor *s = _firstSensor; s != NULL; s = s->_nextSensor)
+            {
+                if (s->_dataPin != dataPin) continue;
+                if (s->_busStatus == SENSOR_UNKNOWN && s->isWarmedUp())
+                {
+                    s->addWarmUpWaitTime(millis() - start);
+                    if (s->startMeasurement()) s->_busStatus = SENSOR_WAITING;
+                    else
+                    {
+                        s->_busStatus = SENSOR_ERROR;
+                        numPending--;
+                    }
+                    anyDone = true;
+                }
+                else if (s->_busStatus == SENSOR_WAITING && s->isMeasurementReady())
+                {
+                    s->_busStatus = s->collectMeasurement();
+                    if (s->_busStatus != SENSOR_WAITING) numPending--;
+                    anyDone = true;
+                }
+            }
+            // Don't spin on the sensors while they are all busy
+            if (!anyDone) delay(1);
+        }
+
+        // Turn the power back off to any sensors that had been off, now that all
+        // of them are finished
+        bool success = true;
+        for (SharedBusSensor *s = _firstSensor; s != NULL; s = s->_nextSensor)
+        {
+            if (s->_dataPin != dataPin) continue;
+            if(!s->_busWasOn)
+            {
+                s->releaseBus();
+                s->powerDown();
+            }
+            // A sensor that never started or finished has failed
+            if (s->_busStatus != SENSOR_READY) s->_busStatus = SENSOR_ERROR;
+            // Let the other sensors' update() use these values
+            s->_busShared = (s != caller);
+            s->_millisBusUpdated = millis();
+            if (caller == NULL || s == caller) success &= (s->_busStatus == SENSOR_READY);
+        }
+        DBGM(F("Finished measurements on pin "), dataPin, F(" in "),
+             millis() - start, F(" ms\n"));
+        return success;
+    }
+
+private:
+    // Every sensor of this kind, so the sensors sharing a data pin can be found
+    static SharedBusSensor *_firstSensor;
+    SharedBusSensor *_nextSensor;
+    uint32_t _busTimeout_ms;
+    // The state of each sensor while the bus is being measured
+    SENSOR_STATUS _busStatus;
+    bool _busWasOn;
+    bool _busShared;
+    uint32_t _millisBusUpdated;
+};
+
+template <class T>
+SharedBusSensor<T> *SharedBusSensor<T>::_firstSensor = NULL;
+
+#endif
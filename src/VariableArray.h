@@ -15,6 +15,14 @@
 
 #include "SensorBase.h"
 #include "VariableBase.h"
+#include "CharBufferPrint.h"
+#include "LogProfiler.h"
+
+// The largest number of unique sensors in a single array
+#define MAX_NUMBER_SENSORS 32
+
+// The longest time to wait for all sensors to finish an overlapped update
+#define OVERLAPPED_UPDATE_TIMEOUT 300000L
 
 #ifdef MODULAR_SENSORS_OUTPUT
 namespace {
@@ -61,23 +69,21 @@ public:
         PRINTOUT(F("Initializing variable array with "), variableCount, F(" variables...\n"));
         _variableCount = variableCount;
         _variableList = variableList;
+        _staggerWake = false;
+        _plannedCycleTime = 0;
+        _lastCycleTime = 0;
+        _lastUpdateSuccess = true;
+        // The list of unique sensors is made by setupSensors(), once the
+        // sensors know their full locations
+        _sensorCount = 0;
     }
 
     // Functions to return information about the list
     // // This just returns the number of variables
     int getVariableCount(void){return _variableCount;}
 
-    // This counts and returns the number of sensors
-    int getSensorCount(void)
-    {
-        int numSensors = 1;
-        // Check for unique sensors
-        for (int i = 0; i < _variableCount; i++)
-        {
-            if (isLastVarFromSensor(i)) numSensors++;
-        }
-        return numSensors;
-    }
+    // This returns the number of unique sensors
+    int getSensorCount(void){return _sensorCount;}
 
     // Public functions for interfacing with a list of sensors
     // This sets up all of the sensors in the list
@@ -131,6 +137,10 @@ public:
             success &= _variableList[i]->setup();
         }
 
+        // Now that the sensors know their full locations, list the unique
+        // sensors
+        buildSensorList();
+
         if (success)
             PRINTOUT(F("   ... Success!\n"));
         return success;
@@ -139,13 +149,11 @@ public:
     // This puts sensors to sleep (ie, cuts power)
     bool sensorsSleep(void)
     {
+        PROFILE_SCOPE(PROFILE_SENSORS_SLEEP);
         DBGVA(F("Putting sensors to sleep.\n"));
         bool success = true;
-        for (int i = 0; i < _variableCount; i++)
-        {
-            if (isLastVarFromSensor(i))
-                success &= _variableList[i]->parentSensor->sleep();
-        }
+        for (uint8_t k = 0; k < _sensorCount; k++)
+            success &= getSensor(k)->sleep();
         return success;
     }
 
@@ -154,10 +162,10 @@ public:
     {
         DBGVA(F("Waking sensors.\n"));
         bool success = true;
-        for (int i = 0; i < _variableCount; i++)
+        for (uint8_t k = 0; k < _sensorCount; k++)
         {
-            if (isLastVarFromSensor(i))
-                success &= _variableList[i]->parentSensor->wake();
+            PROFILE_SCOPE(PROFILE_SENSOR_WAKE, k);
+            success &= getSensor(k)->wake();
         }
         return success;
     }
@@ -167,27 +175,77 @@ public:
     {
         bool success = true;
         bool update_success = true;
-        for (uint8_t i = 0; i < _variableCount; i++)
+        for (uint8_t k = 0; k < _sensorCount; k++)
         {
-            if (isLastVarFromSensor(i))
-            {
-                // Prints for debugging
-                DBGVA(F("--- Going to update "));
-                DBGVA(_variableList[i]->parentSensor->getSensorName());
-                DBGVA(F(" ---\n"));
-
-                update_success = _variableList[i]->parentSensor->update();
+            // Prints for debugging
+            DBGVA(F("--- Going to update "));
+            DBGVA(getSensor(k)->getSensorName());
+            DBGVA(F(" ---\n"));
 
-                // Prints for debugging
-                DBGVA(F("--- Updated "));
-                DBGVA(_variableList[i]->parentSensor->getSensorName());
-                DBGVA(F(" ---\n"));
+            {
+                PROFILE_SCOPE(PROFILE_SENSOR_COLLECT, k);
+                update_success = getSensor(k)->update();
             }
+            success &= update_success;
+
+            // Prints for debugging
+            DBGVA(F("--- Updated "));
+            DBGVA(getSensor(k)->getSensorName());
+            DBGVA(F(" ---\n"));
         }
-        success &= update_success;
+        _lastUpdateSuccess = success;
         return success;
     }
 
+    // This function updates the values for any connected sensors, but instead
+    // of waiting for each sensor in turn, it starts measurements on every
+    // sensor as soon as it is warmed up and then collects the results as each
+    // becomes ready.  The warm-up and measurement times of the sensors then
+    // overlap so the total time is about the longest single sensor time.
+    // The sensors should already have been woken.
+    bool updateAllSensorsOverlapped(void)
+    {
+        return runSensorSchedule(false);
+    }
+
+    // This function wakes and updates all sensors, servicing them in the order
+    // they will be ready (earliest first) based on their warm-up and
+    // stabilization times.  If staggered waking is on, sensors that warm up
+    // quickly are powered later so every sensor becomes ready at about the
+    // same time instead of sitting powered and idle.
+    bool updateAllSensorsScheduled(void)
+    {
+        return runSensorSchedule(true);
+    }
+
+    // This sets whether updateAllSensorsScheduled() staggers sensor power-on
+    void setStaggeredWake(bool staggerWake)
+    {
+        _staggerWake = staggerWake;
+        DBGVA(F("Staggered sensor wake set to "), _staggerWake, F("\n"));
+    }
+
+    // These return the time (in ms) from the start of the last sensor update
+    // until all sensors were planned to be ready and until the last sensor
+    // actually finished.
+    uint32_t getPlannedCycleTime(void){return _plannedCycleTime;}
+    uint32_t getLastCycleTime(void){return _lastCycleTime;}
+
+    // This works out how long a scheduled update should take from the
+    // warm-up and stabilization times of the sensors, without powering or
+    // measuring any of them.  The measurements themselves may add to this.
+    uint32_t planCycleTime(void)
+    {
+        uint32_t maxLead = 0;
+        for (uint8_t i = 0; i < _sensorCount; i++)
+        {
+            Sensor *sensor = getSensor(i);
+            uint32_t lead = sensor->getWarmUpTime() + sensor->getStabilizationTime();
+            if (lead > maxLead) maxLead = lead;
+        }
+        return maxLead;
+    }
+
     // This function prints out the results for any connected sensors to a stream
     void printSensorData(Stream *stream = &Serial)
     {
@@ -209,6 +267,34 @@ public:
         }
     }
 
+    // This prints out the power used by each sensor: the time it was on the
+    // last time it was powered down and the charge used in that time, followed
+    // by the totals since the board started.  Call this after the sensors are
+    // put to sleep to see the last cycle.
+    void printPowerSummary(Stream *stream = &Serial)
+    {
+        for (uint8_t i = 0; i < _sensorCount; i++)
+        {
+            Sensor *sensor = getSensor(i);
+            stream->print(sensor->getSensorName());
+            stream->print(F(" attached at "));
+            stream->print(sensor->getSensorLocation());
+            stream->print(F(" was on for "));
+            stream->print(sensor->getLastPoweredTime());
+            stream->print(F(" ms using "));
+            stream->print(sensor->getPowerDraw()*sensor->getLastPoweredTime()/3600000.0, 4);
+            stream->print(F(" mAh; in total on for "));
+            stream->print(sensor->getPoweredTime()/1000);
+            stream->print(F(" s over "));
+            stream->print(sensor->getPowerCycles());
+            stream->print(F(" cycles, waiting "));
+            stream->print(sensor->getWarmUpWaitTime()/1000);
+            stream->print(F(" s for warm-up and using "));
+            stream->print(sensor->getChargeUsed(), 3);
+            stream->println(F(" mAh"));
+        }
+    }
+
     // This generates a comma separated list of sensor values WITHOUT TIME STAMP
     String generateSensorDataCSV(void)
     {
@@ -226,45 +312,241 @@ public:
         return csvString;
     }
 
+    // This prints the same comma separated list of sensor values WITHOUT TIME
+    // STAMP straight to a stream or file without building a String
+    void printSensorDataCSV(Print *stream)
+    {
+        for (uint8_t i = 0; i < _variableCount; i++)
+        {
+            _variableList[i]->printValue(stream);
+            if (i + 1 != _variableCount)
+            {
+                stream->print(',');
+            }
+        }
+    }
+
+    // This writes the same comma separated list of sensor values WITHOUT TIME
+    // STAMP into a character buffer.  Returns the length of the text, or -1 if
+    // the buffer was too small and the text was cut off.
+    int generateSensorDataCSV(char *buffer, size_t bufferSize)
+    {
+        CharBufferPrint bufferPrint(buffer, bufferSize);
+        printSensorDataCSV(&bufferPrint);
+        if (bufferPrint.overflowed()) return -1;
+        return bufferPrint.length();
+    }
+
 
 protected:
-    bool isLastVarFromSensor(int arrayIndex)
+    // This runs the measurements for all of the unique sensors, starting and
+    // collecting from each in the order it is expected to be ready.  If
+    // wakeSensors is true, the sensors are also powered here, either all at
+    // once or staggered so they all finish warming up at the same time.
+    bool runSensorSchedule(bool wakeSensors)
     {
-        // Check for unique sensors
-        String sensName = _variableList[arrayIndex]->parentSensor->getSensorName();
-        String sensLoc = _variableList[arrayIndex]->parentSensor->getSensorLocation();
-        bool unique = true;
-        for (int j = arrayIndex + 1; j < _variableCount; j++)
+        PROFILE_SCOPE(PROFILE_SENSORS_UPDATE);
+        bool success = true;
+        uint32_t cycleStart = millis();
+
+        // Find the time each sensor needs from power-on until it can give a
+        // reading.  All times are in ms from the cycle start.
+        uint8_t numSensors = _sensorCount;
+        uint8_t order[MAX_NUMBER_SENSORS];
+        int32_t powerOnAt[MAX_NUMBER_SENSORS];
+        int32_t readyAt[MAX_NUMBER_SENSORS];
+        uint8_t sensorState[MAX_NUMBER_SENSORS];
+        uint32_t maxLead = 0;
+        for (uint8_t i = 0; i < numSensors; i++)
         {
-            if (sensName == _variableList[j]->parentSensor->getSensorName() &&
-                sensLoc == _variableList[j]->parentSensor->getSensorLocation())
+            order[i] = i;
+            Sensor *sensor = getSensor(i);
+            uint32_t lead = sensor->getWarmUpTime() + sensor->getStabilizationTime();
+            if (lead > maxLead) maxLead = lead;
+        }
+
+        // Plan when each sensor is powered and when it will be ready
+        int32_t planned = 0;
+        for (uint8_t k = 0; k < numSensors; k++)
+        {
+            uint8_t i = order[k];
+            Sensor *sensor = getSensor(i);
+            uint32_t lead = sensor->getWarmUpTime() + sensor->getStabilizationTime();
+            if (wakeSensors && _staggerWake) powerOnAt[i] = maxLead - lead;
+            else if (wakeSensors || sensor->getMillisPowerOn() == 0) powerOnAt[i] = 0;
+            else powerOnAt[i] = sensor->getMillisPowerOn() - cycleStart;
+            readyAt[i] = powerOnAt[i] + lead;
+            if (readyAt[i] > planned) planned = readyAt[i];
+            // 0 = waiting for power, 1 = warming up, 2 = measuring, 3 = finished
+            sensorState[i] = wakeSensors ? 0 : 1;
+        }
+
+        // Sort the sensors by ready time, keeping the list order for ties
+        for (uint8_t k = 1; k < numSensors; k++)
+        {
+            uint8_t i = order[k];
+            int j = k - 1;
+            while (j >= 0 && readyAt[order[j]] > readyAt[i])
             {
-                unique = false;
-                break;
+                order[j + 1] = order[j];
+                j--;
             }
+            order[j + 1] = i;
+        }
+
+        uint8_t numPending = numSensors;
+        while (numPending > 0 && (millis() - cycleStart) < OVERLAPPED_UPDATE_TIMEOUT)
+        {
+            int32_t now = millis() - cycleStart;
+            bool anyDone = false;
+
+            // Power and start every sensor that is due before collecting
+            // anything so slow sensors are not held up by fast ones
+            for (uint8_t k = 0; k < numSensors; k++)
+            {
+                uint8_t i = order[k];
+                Sensor *sensor = getSensor(i);
+                if (sensorState[i] == 0 && now >= powerOnAt[i])
+                {
+                    DBGVA(F("--- Waking "), sensor->getSensorName(), F(" ---\n"));
+                    PROFILE_SCOPE(PROFILE_SENSOR_WAKE, i);
+                    success &= sensor->wake();
+                    sensorState[i] = 1;
+                    anyDone = true;
+                }
+                if (sensorState[i] == 1 && sensor->isWarmedUp())
+                {
+                    DBGVA(F("--- Starting measurement on "));
+                    DBGVA(sensor->getSensorName(), F(" ---\n"));
+                    // Count the wait from power-on, or from the start of the
+                    // cycle if it was already on, until it could be started
+                    uint32_t waitStart = sensor->getMillisPowerOn();
+                    if (waitStart == 0 || (int32_t)(waitStart - cycleStart) < 0)
+                        waitStart = cycleStart;
+                    sensor->addWarmUpWaitTime(millis() - waitStart);
+                    PROFILE_SCOPE(PROFILE_SENSOR_START, i);
+                    if (sensor->startMeasurement()) sensorState[i] = 2;
+                    else
+                    {
+                        DBGVA(F("--- Failed to start "), sensor->getSensorName(), F(" ---\n"));
+                        sensorState[i] = 3;
+                        numPending--;
+                        success = false;
+                    }
+                    anyDone = true;
+                }
+            }
+
+            // Now collect from any sensors that have finished
+            for (uint8_t k = 0; k < numSensors; k++)
+            {
+                uint8_t i = order[k];
+                Sensor *sensor = getSensor(i);
+                if (sensorState[i] == 2 && sensor->isMeasurementReady())
+                {
+                    PROFILE_SCOPE(PROFILE_SENSOR_COLLECT, i);
+                    SENSOR_STATUS stat = sensor->collectMeasurement();
+                    if (stat != SENSOR_WAITING)
+                    {
+                        DBGVA(F("--- Updated "), sensor->getSensorName(), F(" ---\n"));
+                        sensorState[i] = 3;
+                        numPending--;
+                        success &= (stat == SENSOR_READY);
+                    }
+                    anyDone = true;
+                }
+            }
+
+            // Don't spin on the sensors while they are all busy; this can go
+            // on for as long as OVERLAPPED_UPDATE_TIMEOUT
+            if (!anyDone) delay(1);
+        }
+
+        if (numPending > 0)
+        {
+            PRINTOUT(F("Timed out waiting for "), numPending, F(" sensor[s]!\n"));
+            success = false;
         }
-        // Prints for debugging
-        if (unique){
-            DBGVA(_variableList[arrayIndex]->getVarName());
-            DBGVA(F(" from "));
-            DBGVA(sensName);
-            DBGVA(F(" at "));
-            DBGVA(sensLoc);
-            DBGVA(F(" will be used for sensor references.\n"));
+
+        _lastUpdateSuccess = success;
+        _plannedCycleTime = planned > 0 ? planned : 0;
+        _lastCycleTime = millis() - cycleStart;
+        PRINTOUT(F("Sensors planned to be ready in "), _plannedCycleTime);
+        PRINTOUT(F(" ms; all finished in "), _lastCycleTime, F(" ms\n"));
+
+        return success;
+    }
+
+    // This returns the sensor at the given position in the unique sensor list
+    Sensor *getSensor(uint8_t sensorNum)
+    {
+        return _variableList[_sensorVarIndex[sensorNum]]->parentSensor;
+    }
+
+    // This builds the list of unique sensors so the per-reading functions do
+    // not need to search the variable list for repeats every time.  Each
+    // sensor is listed once, at the position of the last variable from it.
+    // Sensors are matched by their address in memory or, as a fallback, by
+    // the same name and location.
+    void buildSensorList(void)
+    {
+        _sensorCount = 0;
+        // Go backwards so each sensor is found at its last variable first
+        for (int i = _variableCount - 1; i >= 0; i--)
+        {
+            Sensor *sensor = _variableList[i]->parentSensor;
+            bool unique = true;
+            for (uint8_t k = 0; k < _sensorCount; k++)
+            {
+                if (sensor == getSensor(k))
+                {
+                    unique = false;
+                    break;
+                }
+            }
+            // Only ask for the names and locations if no listed sensor is the
+            // same object
+            for (uint8_t k = 0; unique && k < _sensorCount; k++)
+            {
+                if (sensor->getSensorName() == getSensor(k)->getSensorName() &&
+                    sensor->getSensorLocation() == getSensor(k)->getSensorLocation())
+                    unique = false;
+            }
+
+            // Prints for debugging
+            DBGVA(_variableList[i]->getVarName(), F(" from "), sensor->getSensorName());
+            DBGVA(F(" at "), sensor->getSensorLocation());
+            if (!unique) DBGVA(F(" will be ignored.\n"));
+            else if (_sensorCount < MAX_NUMBER_SENSORS)
+            {
+                DBGVA(F(" will be used for sensor references.\n"));
+                _sensorVarIndex[_sensorCount++] = i;
+            }
+            else
+            {
+                PRINTOUT(F("Too many sensors!  "), sensor->getSensorName(), F(" at "),
+                         sensor->getSensorLocation());
+                PRINTOUT(F(" will not be updated.\n"));
+            }
         }
-        else{
-            DBGVA(_variableList[arrayIndex]->getVarName());
-            DBGVA(F(" from "));
-            DBGVA(sensName);
-            DBGVA(F(" at "));
-            DBGVA(sensLoc);
-            DBGVA(F(" will be ignored.\n"));
+
+        // Put the sensors back in the order of the variable list
+        for (uint8_t k = 0; k < _sensorCount/2; k++)
+        {
+            uint8_t swap = _sensorVarIndex[k];
+            _sensorVarIndex[k] = _sensorVarIndex[_sensorCount - 1 - k];
+            _sensorVarIndex[_sensorCount - 1 - k] = swap;
         }
-        return unique;
     }
 
     uint8_t _variableCount;
     Variable **_variableList;
+    uint8_t _sensorCount;
+    uint8_t _sensorVarIndex[MAX_NUMBER_SENSORS];
+    bool _staggerWake;
+    uint32_t _plannedCycleTime;
+    uint32_t _lastCycleTime;
+    bool _lastUpdateSuccess;
 };
 
 #endif
@@ -64,6 +64,12 @@ String Variable::getVarCode(void)
     else return _defaultVarCode;
 }
 
+// This returns the number of decimal places the value is reported with
+unsigned int Variable::getResolution(void){return _decimalResolution;}
+
+// This returns the variable's place in its parent sensor's values
+int Variable::getVarNum(void){return _varNum;}
+
 // This returns the current value of the variable as a float
 float Variable::getValue(void)
 {
@@ -84,3 +90,18 @@ String Variable::getValueString(void)
     else
     {return String(getValue(), _decimalResolution);}
 }
+
+// This prints the current value of the variable with the correct number of
+// significant figures, using a small character buffer instead of a String
+size_t Variable::printValue(Print *stream, bool updateValue)
+{
+    float value = sensorValue;
+    if (updateValue) value = getValue();
+    // Need this because otherwise get extra spaces in strings from int
+    if (_decimalResolution == 0) return stream->print(int(value));
+
+    // Same width as used by the String constructor
+    char valueBuffer[MAX_VALUE_STRING_LENGTH];
+    dtostrf(value, _decimalResolution + 2, _decimalResolution, valueBuffer);
+    return stream->print(valueBuffer);
+}
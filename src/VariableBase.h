@@ -11,6 +11,9 @@
 #define VariableBase_h
 
 #include <Arduino.h>
+#if defined(ARDUINO_ARCH_SAMD)
+  #include <avr/dtostrf.h>
+#endif
 
 // #define VARIABLES_DBG Serial
 
@@ -31,6 +34,10 @@ namespace {
  #define DBGV(...)
 #endif
 
+// The longest text printed for a single value
+// (a 32-bit float can have 39 digits before the decimal point)
+#define MAX_VALUE_STRING_LENGTH 48
+
 class Sensor;  // Forward declaration
 
 class Variable
@@ -54,11 +61,20 @@ public:
     String getVarUnit(void);
     // This returns a customized code for the variable, if one is given, and a default if not
     String getVarCode(void);
+    // This returns the number of decimal places the value is reported with
+    unsigned int getResolution(void);
+    // This returns the variable's place in its parent sensor's values
+    int getVarNum(void);
 
     // This returns the current value of the variable as a float
     float getValue(void);
     // This returns the current value of the variable as a string with the correct number of significant figures
     String getValueString(void);
+    // This prints the same text as getValueString() to a stream or other
+    // Print object without creating a String.  Returns the number of
+    // characters printed.  If updateValue is false, the last value is printed
+    // without checking whether the sensor needs to be updated first.
+    size_t printValue(Print *stream, bool updateValue = true);
 
     // This is the parent sensor for the variable
     Sensor *parentSensor;
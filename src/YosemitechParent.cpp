@@ -21,29 +21,34 @@ YosemitechParent::YosemitechParent(byte modbusAddress, int powerPin,
                                    String sensName, int numMeasurements,
                                    yosemitechModel model, int WarmUpTime_ms,
                                    int StabilizationTime_ms, int remeasurementTime_ms)
-    : Sensor(powerPin, -1, sensName, numMeasurements, WarmUpTime_ms)
+    : Sensor(powerPin, -1, sensName, numMeasurements, WarmUpTime_ms, StabilizationTime_ms)
 {
     _model = model;
     _modbusAddress = modbusAddress;
     _stream = stream;
     _enablePin = enablePin;
     _numReadings = numReadings;
-    _StabilizationTime_ms = StabilizationTime_ms;
+    _minReadings = numReadings;
+    _powerDraw_mA = YOSEMITECH_POWER_DRAW;
+    _remeasurementTime_ms = remeasurementTime_ms;
+    _numReadingsTaken = 0;
 }
 YosemitechParent::YosemitechParent(byte modbusAddress, int powerPin,
                                    Stream& stream, int enablePin, int numReadings,
                                    String sensName, int numMeasurements,
                                    yosemitechModel model, int WarmUpTime_ms,
                                    int StabilizationTime_ms, int remeasurementTime_ms)
-    : Sensor(powerPin, -1, sensName, numMeasurements, WarmUpTime_ms)
+    : Sensor(powerPin, -1, sensName, numMeasurements, WarmUpTime_ms, StabilizationTime_ms)
 {
     _model = model;
     _modbusAddress = modbusAddress;
     _stream = &stream;
     _enablePin = enablePin;
     _numReadings = numReadings;
-    _StabilizationTime_ms = StabilizationTime_ms;
+    _minReadings = numReadings;
+    _powerDraw_mA = YOSEMITECH_POWER_DRAW;
     _remeasurementTime_ms = remeasurementTime_ms;
+    _numReadingsTaken = 0;
 }
 
 
@@ -78,15 +83,23 @@ String YosemitechParent::getSensorLocation(void)
 
 // Uses the YosemitechModbus library to communicate with the sensor
 bool YosemitechParent::update()
+{
+    return runMeasurement();
+}
+
+
+// This tells the sensor to begin measuring
+bool YosemitechParent::startMeasurement(void)
 {
     // Check if the power is on, turn it on if not
-    bool wasOn = checkPowerOn();
-    if(!wasOn){powerUp();}
-    // Wait until the sensor is warmed up
-    waitForWarmUp();
+    if(!checkPowerOn()){powerUp();}
+    // Don't wait for the warm-up here, so the caller can do other work
+    if (!isWarmedUp()) return false;
 
     // Clear values before starting loop
     clearValues();
+    _numReadingsTaken = 0;
+    for (int i = 0; i < _numReturnedVars; i++) _readingStats[i].reset();
 
     // Send the command to begin taking readings, trying up to 5 times
     bool success = false;
@@ -100,52 +113,88 @@ bool YosemitechParent::update()
     if (success)
     {
         DBGM(F("Measurements started.\n"));
+        _millisMeasurementRequested = millis();
+    }
+    else
+    {
+        DBGM(F("Failed to start measuring!\n"));
+        _millisMeasurementRequested = 0;
+        // Send the cleared values so old results are not reported again
+        notifyVariables();
+    }
+    return success;
+}
+
 
-        // Wait until the sensor is ready to give readings
-        delay(_StabilizationTime_ms);
-
-        // averages x readings in this one loop
-        for (int j = 0; j < _numReadings; j++)
-        {
-            DBGM(F("Taking reading #"), j, F("\n"));
-
-            // Initialize float variables
-            float parmValue, tempValue, thirdValue;
-            // Get Values
-            sensor.getValues(parmValue, tempValue, thirdValue);
-            // Put values into the array
-            // All sensors but pH and DO will have -9999 as the third value
-            sensorValues[0] += parmValue;
-            DBGM(F("Parm: "), parmValue, F("\n"));
-            sensorValues[1] += tempValue;
-            DBGM(F("Temp: "), tempValue, F("\n"));
-            sensorValues[2] += thirdValue;
-            DBGM(F("Third: "), thirdValue, F("\n"));
-
-            if (j < _numReadings - 1)
-            {
-                DBGM(F("Waiting until sensor is ready for the next reading.\n"));
-                delay(_remeasurementTime_ms);
-            }
-        }
-
-        // Average over the number of readings
-        DBGM(F("Averaging over "), _numReadings, F(" readings\n"));
-        for (int i = 0; i < _numReturnedVars; i++)
-        {
-            sensorValues[i] /=  _numReadings;
-            DBGM(F("Result #"), i, F(": "), sensorValues[i], F("\n"));
-        }
+// The first reading is ready after the sensor has stabilized, the following
+// readings after the re-measurement time.
+bool YosemitechParent::isMeasurementReady(void)
+{
+    uint32_t waitTime_ms;
+    if (_numReadingsTaken == 0) waitTime_ms = _StabilizationTime_ms;
+    else waitTime_ms = _remeasurementTime_ms;
+    return (millis() - _millisMeasurementRequested) >= waitTime_ms;
+}
+
+
+// This gets one reading, averaging once all of the readings are in
+SENSOR_STATUS YosemitechParent::collectMeasurement(void)
+{
+    DBGM(F("Taking reading #"), _numReadingsTaken, F("\n"));
+
+    // Initialize float variables
+    float parmValue, tempValue, thirdValue;
+    // Get Values
+    if (sensor.getValues(parmValue, tempValue, thirdValue))
+    {
+        // Add the values to the statistics
+        // All sensors but pH and DO will have -9999 as the third value, which
+        // is left out
+        _readingStats[0].add(parmValue);
+        DBGM(F("Parm: "), parmValue, F("\n"));
+        _readingStats[1].add(tempValue);
+        DBGM(F("Temp: "), tempValue, F("\n"));
+        _readingStats[2].add(thirdValue);
+        DBGM(F("Third: "), thirdValue, F("\n"));
     }
+    // A failed reading is left out of the average
+    else DBGM(F("Failed to get values!\n"));
 
+    _numReadingsTaken++;
+    if (!ReadingStats::isFinished(_readingStats, _numReturnedVars, _numReadingsTaken,
+                                  _minReadings, _numReadings))
+    {
+        DBGM(F("Waiting until sensor is ready for the next reading.\n"));
+        _millisMeasurementRequested = millis();
+        return SENSOR_WAITING;
+    }
+    _millisMeasurementRequested = 0;
 
-    else DBGM(F("Failed to start measuring!\n"));
-    // Turn the power back off it it had been turned on
-    if(!wasOn){powerDown();}
+    // Average over the good readings
+    for (int i = 0; i < _numReturnedVars; i++)
+    {
+        sensorValues[i] = _readingStats[i].getMean();
+        DBGM(F("Result #"), i, F(": "), sensorValues[i], F(" averaged over "),
+             _readingStats[i].getCount(), F(" readings\n"));
+    }
 
     // Update the registered variables with the new values
     notifyVariables();
 
-    // Return true when finished
-    return true;
+    if (_readingStats[0].getCount() == 0) return SENSOR_ERROR;
+    return SENSOR_READY;
+}
+
+
+ReadingStats *YosemitechParent::getReadingStats(int varNum)
+{
+    if (varNum < 0 || varNum >= _numReturnedVars) return NULL;
+    return &_readingStats[varNum];
+}
+
+
+void YosemitechParent::setReadingRange(int minReadings, int maxReadings)
+{
+    _minReadings = max(minReadings, 2);
+    _numReadings = max(maxReadings, _minReadings);
 }
@@ -11,6 +11,8 @@
  *information about the various variables, can be found
  *in the EnviroDIY Yosemitech library at:
  * https://github.com/EnviroDIY/Yosemitech
+ *
+ * The manuals give a power use of up to 0.5 W at 12V while measuring
 */
 
 #ifndef YosemitechParent_h
@@ -23,6 +25,9 @@
 #include "ModSensorDebugger.h"
 
 #include "SensorBase.h"
+#include "ReadingStats.h"
+
+#define YOSEMITECH_POWER_DRAW 42  // Most current while measuring at 12V in mA
 
 // The main class for the Decagon CTD
 class YosemitechParent : public Sensor
@@ -45,15 +50,27 @@ public:
 
     virtual bool update(void);
 
+    virtual bool startMeasurement(void) override;
+    virtual bool isMeasurementReady(void) override;
+    virtual SENSOR_STATUS collectMeasurement(void) override;
+    // This returns the statistics of the readings in the last average
+    virtual ReadingStats *getReadingStats(int varNum) override;
+    // This lets the sensor stop averaging as soon as every variable meets its
+    // precision target (see setPrecisionTarget), taking at least minReadings
+    // (and at least 2) and at most maxReadings readings
+    void setReadingRange(int minReadings, int maxReadings);
+
 private:
     yosemitechModel _model;
     byte _modbusAddress;
     Stream* _stream;
     int _enablePin;
     int _numReadings;
+    int _minReadings;
     yosemitech sensor;
-    int _StabilizationTime_ms;
     int _remeasurementTime_ms;
+    int _numReadingsTaken;
+    ReadingStats _readingStats[MAX_NUMBER_VARS];
 };
 
 #endif
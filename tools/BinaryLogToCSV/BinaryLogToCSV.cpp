@@ -0,0 +1,191 @@
+/*
+ *BinaryLogToCSV.cpp
+ *This file is part of the EnviroDIY modular sensors library for Arduino
+ *
+ *Initial library developement done by Sara Damiano (sdamiano@stroudcenter.org).
+ *
+ *This is a tool to run on a computer (NOT on the logger) to convert the binary
+ *log files written with Logger::setBinaryLogging(true) back into the same csv
+ *layout written by a normal logger.  See LoggerBase.h for the file format.
+ *
+ *To build it with any C++11 compiler:
+ *  g++ -std=c++11 -O2 -o BinaryLogToCSV BinaryLogToCSV.cpp
+ *To use it:
+ *  BinaryLogToCSV LOGGER_2017-09-01.bin [LOGGER_2017-09-01.csv]
+ *If no output file is given, the csv is written to the screen.
+*/
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#define BINARY_LOG_VERSION 1
+#define BINARY_LOG_RECORD_MARK 'R'
+// The only bit of the record status byte in use
+#define BINARY_LOG_STATUS_UPDATE_FAILED 0x01
+
+// Read little-endian numbers, regardless of the computer's byte order
+static bool readBytes(FILE *in, uint8_t *buf, size_t len)
+{
+    return fread(buf, 1, len, in) == len;
+}
+
+static bool readUInt16(FILE *in, uint16_t &value)
+{
+    uint8_t b[2];
+    if (!readBytes(in, b, 2)) return false;
+    value = (uint16_t)b[0] | ((uint16_t)b[1] << 8);
+    return true;
+}
+
+static bool readUInt32(FILE *in, uint32_t &value)
+{
+    uint8_t b[4];
+    if (!readBytes(in, b, 4)) return false;
+    value = (uint32_t)b[0] | ((uint32_t)b[1] << 8) |
+            ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+    return true;
+}
+
+static bool readFloat(FILE *in, float &value)
+{
+    uint32_t bits;
+    if (!readUInt32(in, bits)) return false;
+    memcpy(&value, &bits, 4);
+    return true;
+}
+
+// Formats the marked time the same way DateTime::addToString() does
+static void printTimestamp(FILE *out, uint32_t epoch)
+{
+    time_t t = epoch;
+    struct tm *dt = gmtime(&t);
+    fprintf(out, "%04d-%02d-%02d %02d:%02d:%02d",
+            dt->tm_year + 1900, dt->tm_mon + 1, dt->tm_mday,
+            dt->tm_hour, dt->tm_min, dt->tm_sec);
+}
+
+// Formats a value the same way Variable::getValueString() does
+static void printValue(FILE *out, float value, unsigned int resolution)
+{
+    if (resolution == 0) fprintf(out, "%d", (int)value);
+    else fprintf(out, "%.*f", resolution, value);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        fprintf(stderr, "Usage: %s input.bin [output.csv]\n", argv[0]);
+        return 1;
+    }
+
+    FILE *in = fopen(argv[1], "rb");
+    if (!in)
+    {
+        fprintf(stderr, "Unable to open %s\n", argv[1]);
+        return 1;
+    }
+    FILE *out = stdout;
+    if (argc == 3)
+    {
+        out = fopen(argv[2], "wb");
+        if (!out)
+        {
+            fprintf(stderr, "Unable to create %s\n", argv[2]);
+            fclose(in);
+            return 1;
+        }
+    }
+
+    std::vector<uint8_t> resolutions;
+    long numRecords = 0;
+    long numFailed = 0;
+    bool ok = true;
+    int mark;
+    while (ok && (mark = fgetc(in)) != EOF)
+    {
+        if (mark == 'M')
+        {
+            // A header block - the rest of the "MSBL" marker comes first
+            uint8_t magic[3], version, numVars;
+            if (!readBytes(in, magic, 3) || memcmp(magic, "SBL", 3) != 0 ||
+                !readBytes(in, &version, 1) || !readBytes(in, &numVars, 1))
+            {
+                fprintf(stderr, "Bad header block at byte %ld\n", ftell(in));
+                ok = false;
+                break;
+            }
+            if (version != BINARY_LOG_VERSION)
+            {
+                fprintf(stderr, "Unknown format version %d\n", version);
+                ok = false;
+                break;
+            }
+            resolutions.resize(numVars);
+            uint16_t headerLength;
+            if ((numVars > 0 && !readBytes(in, &resolutions[0], numVars)) ||
+                !readUInt16(in, headerLength))
+            {
+                fprintf(stderr, "Truncated header block\n");
+                ok = false;
+                break;
+            }
+            std::string header(headerLength, '\0');
+            if (headerLength > 0 && !readBytes(in, (uint8_t*)&header[0], headerLength))
+            {
+                fprintf(stderr, "Truncated header block\n");
+                ok = false;
+                break;
+            }
+            fwrite(header.data(), 1, header.size(), out);
+        }
+        else if (mark == BINARY_LOG_RECORD_MARK)
+        {
+            uint8_t status;
+            uint32_t epoch;
+            if (!readBytes(in, &status, 1) || !readUInt32(in, epoch))
+            {
+                fprintf(stderr, "Truncated record at the end of the file\n");
+                break;
+            }
+            std::vector<float> values(resolutions.size());
+            for (size_t i = 0; i < values.size() && ok; i++)
+                ok = readFloat(in, values[i]);
+            if (!ok)
+            {
+                // A partly-written record at the end of the file is dropped
+                fprintf(stderr, "Truncated record at the end of the file\n");
+                ok = true;
+                break;
+            }
+
+            printTimestamp(out, epoch);
+            fputc(',', out);
+            for (size_t i = 0; i < values.size(); i++)
+            {
+                printValue(out, values[i], resolutions[i]);
+                if (i + 1 != values.size()) fputc(',', out);
+            }
+            fputs("\r\n", out);
+            numRecords++;
+            if (status & BINARY_LOG_STATUS_UPDATE_FAILED) numFailed++;
+        }
+        else
+        {
+            fprintf(stderr, "Unexpected byte 0x%02X at byte %ld\n", mark, ftell(in) - 1);
+            ok = false;
+        }
+    }
+
+    fprintf(stderr, "Converted %ld records", numRecords);
+    if (numFailed > 0) fprintf(stderr, " (%ld with a sensor update failure)", numFailed);
+    fprintf(stderr, "\n");
+
+    fclose(in);
+    if (out != stdout) fclose(out);
+    return ok ? 0 : 1;
+}